@@ -0,0 +1,147 @@
+#pragma once
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../src/models/Booking.h"
+#include "../src/models/Hotel.h"
+#include "../src/models/Room.h"
+#include "../src/models/User.h"
+#include "../tests/_test_support.h"
+
+namespace bench_support {
+    using test_support::TempDir;
+
+    // Record counts every repository benchmark runs at.
+    inline void sizes(benchmark::internal::Benchmark* b) {
+        b->Arg(1'000)->Arg(100'000)->Arg(1'000'000)->Unit(benchmark::kMicrosecond);
+    }
+
+    constexpr int kRoomsPerHotel = 100;
+    constexpr int kHotels = 100; // bookings are spread over this many hotels
+
+    inline std::string padded(const char* prefix, std::int64_t n, int width) {
+        std::string digits = std::to_string(n);
+        if (static_cast<int>(digits.size()) < width) digits.insert(0, width - digits.size(), '0');
+        return prefix + digits;
+    }
+
+    inline std::string hotelId(std::int64_t i) { return padded("HTL-", i, 4); }
+
+    inline hms::Hotel makeHotel(std::int64_t i) {
+        hms::Hotel h{};
+        h.id = hotelId(i);
+        h.name = "Hotel " + std::to_string(i);
+        h.stars = static_cast<std::uint8_t>(1 + i % 5);
+        h.address = std::to_string(i) + " Harbour Road";
+        return h;
+    }
+
+    inline hms::Room makeRoom(std::int64_t i) {
+        static const char* kTypes[] = {"STANDARD", "DELUXE", "SUITE", "LUXURY", "ATTIC"};
+        hms::Room r{};
+        r.hotelId = hotelId(i / kRoomsPerHotel);
+        r.number = static_cast<int>(100 + i % kRoomsPerHotel);
+        r.id = r.hotelId + "-" + std::to_string(r.number);
+        r.typeId = kTypes[i % 5];
+        r.beds = static_cast<int>(1 + i % 3);
+        r.sizeSqm = static_cast<int>(18 + i % 40);
+        r.amenities = {"Wi-Fi", "Desk"};
+        if (i % 2 == 0) r.amenities.push_back("Sea View");
+        if (i % 3 == 0) r.amenities.push_back("Mini Bar");
+        r.active = i % 10 != 0;
+        return r;
+    }
+
+    inline hms::User makeUser(std::int64_t i) {
+        hms::User u{};
+        u.userId = padded("USR-", i, 7);
+        u.firstName = "First" + std::to_string(i);
+        u.lastName = "Last" + std::to_string(i);
+        u.address = std::to_string(i) + " Main Street";
+        u.phone = "+100000" + std::to_string(i);
+        u.login = "user" + std::to_string(i);
+        u.passwordHash = "0000000000000000000000000000000000000000000000000000000000000000";
+        return u;
+    }
+
+    // One room stay with a guest plus one dining line, the common shape of a
+    // booking created through the guest dashboard.
+    inline hms::Booking makeBooking(std::int64_t i) {
+        hms::Booking b{};
+        b.bookingId = padded("BKG-", i + 1, 6);
+        b.hotelId = hotelId(i % kHotels);
+        b.status = (i % 4 == 0) ? hms::BookingStatus::CHECKED_OUT : hms::BookingStatus::ACTIVE;
+        b.createdAt = 1'700'000'000 + i;
+        b.updatedAt = b.createdAt;
+        b.primaryGuestId = padded("USR-", i % 5'000, 7);
+
+        hms::RoomStayItem stay{};
+        stay.hotelId = b.hotelId;
+        stay.roomNumber = static_cast<int>(100 + i % kRoomsPerHotel);
+        stay.nights = static_cast<int>(1 + i % 7);
+        stay.nightlyRateLocked = 12'000 + (i % 50) * 100;
+        stay.occupants.push_back(makeUser(i % 5'000));
+        b.items.emplace_back(std::move(stay));
+
+        hms::RestaurantOrderLine line{};
+        line.lineId = "ROL-0001";
+        line.restaurantId = "R1";
+        line.category = "Dinner";
+        line.menuItemId = "steak";
+        line.nameSnapshot = "Steak";
+        line.unitPriceSnapshot = 3'100;
+        line.qty = static_cast<int>(1 + i % 3);
+        line.createdAt = b.createdAt;
+        b.items.emplace_back(std::move(line));
+        return b;
+    }
+
+    // A stay followed by a long restaurant tab: files dominated by dining
+    // lines, where the per-item encoding matters most.
+    inline hms::Booking makeDiningBooking(std::int64_t i) {
+        static const char* kCategories[] = {"Breakfast", "Lunch", "Dinner", "Bar"};
+        hms::Booking b = makeBooking(i);
+        b.items.pop_back();
+        for (int n = 1; n <= 8; ++n) {
+            hms::RestaurantOrderLine line{};
+            line.lineId = padded("ROL-", n, 4);
+            line.restaurantId = "R" + std::to_string(1 + n % 2);
+            line.category = kCategories[n % 4];
+            line.menuItemId = "item-" + std::to_string((i + n) % 40);
+            line.nameSnapshot = "Menu item " + std::to_string((i + n) % 40);
+            line.unitPriceSnapshot = 900 + ((i + n) % 40) * 75;
+            line.qty = static_cast<int>(1 + (i + n) % 3);
+            line.billedRoomNumber = std::get<hms::RoomStayItem>(b.items[0]).roomNumber;
+            line.takenByUsername = "staff" + std::to_string(n % 5);
+            line.orderedByGuestId = b.primaryGuestId;
+            line.createdAt = b.createdAt + n * 3'600;
+            b.items.emplace_back(std::move(line));
+        }
+        return b;
+    }
+
+    // Datasets are generated once per size and shared by every benchmark.
+    // The cache is per generator, not per row type.
+    template <typename T, T (*Make)(std::int64_t)>
+    const std::vector<T>& dataset(std::int64_t n) {
+        static std::map<std::int64_t, std::vector<T>> cache;
+        auto& rows = cache[n];
+        if (rows.empty()) {
+            rows.reserve(static_cast<std::size_t>(n));
+            for (std::int64_t i = 0; i < n; ++i) rows.push_back(Make(i));
+        }
+        return rows;
+    }
+
+    inline const std::vector<hms::Hotel>& hotels(std::int64_t n)     { return dataset<hms::Hotel, makeHotel>(n); }
+    inline const std::vector<hms::Room>& rooms(std::int64_t n)       { return dataset<hms::Room, makeRoom>(n); }
+    inline const std::vector<hms::User>& users(std::int64_t n)       { return dataset<hms::User, makeUser>(n); }
+    inline const std::vector<hms::Booking>& bookings(std::int64_t n) { return dataset<hms::Booking, makeBooking>(n); }
+    inline const std::vector<hms::Booking>& diningBookings(std::int64_t n) {
+        return dataset<hms::Booking, makeDiningBooking>(n);
+    }
+}
@@ -0,0 +1,69 @@
+#include "_bench_support.h"
+
+#include "../src/models/BookingMetrics.h"
+#include "../src/pricing/PricingEngine.h"
+#include "../src/storage/BookingRepository.h"
+
+using namespace hms;
+using namespace bench_support;
+
+namespace {
+
+// The aggregation behind the admin "Operational reports" screen.
+void BM_SummarizeOperations(benchmark::State& state) {
+    const auto& roomRows = rooms(state.range(0));
+    const auto& bookingRows = bookings(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(summarize(roomRows, bookingRows));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_NextBookingId(benchmark::State& state) {
+    TempDir tmp;
+    BookingRepository repo{tmp.join("bookings.json")};
+    repo.load();
+    for (const auto& b : bookings(state.range(0))) repo.upsert(b);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repo.nextBookingId());
+    }
+}
+
+// Pricing every room from the tariff tables (what a cold cache costs).
+void BM_PricingRateFor(benchmark::State& state) {
+    const auto& roomRows = rooms(state.range(0));
+    TempDir tmp;
+    PricingEngine engine{tmp.join("pricing.json")};
+    engine.load();
+
+    for (auto _ : state) {
+        std::int64_t total = 0;
+        for (const auto& room : roomRows) total += engine.rateFor(room);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Pricing every room through the warm quote cache (what the dashboards pay).
+void BM_PricingQuote(benchmark::State& state) {
+    const auto& roomRows = rooms(state.range(0));
+    TempDir tmp;
+    PricingEngine engine{tmp.join("pricing.json")};
+    engine.load();
+    engine.precompute(roomRows);
+
+    for (auto _ : state) {
+        std::int64_t total = 0;
+        for (const auto& room : roomRows) total += engine.quote(room);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(BM_SummarizeOperations)->Apply(sizes);
+BENCHMARK(BM_NextBookingId)->Apply(sizes);
+BENCHMARK(BM_PricingRateFor)->Apply(sizes);
+BENCHMARK(BM_PricingQuote)->Apply(sizes);
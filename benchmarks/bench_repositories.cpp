@@ -0,0 +1,193 @@
+#include "_bench_support.h"
+
+#include <filesystem>
+
+#include "../src/storage/BookingRepository.h"
+#include "../src/storage/HotelRepository.h"
+#include "../src/storage/RoomsRepository.h"
+#include "../src/storage/UserRepository.h"
+
+using namespace hms;
+using namespace bench_support;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Uniform key access so the benchmarks below can be written once.
+std::optional<Hotel>   find(const HotelRepository& repo, const Hotel& h)     { return repo.get(h.id); }
+std::optional<User>    find(const UserRepository& repo, const User& u)       { return repo.getById(u.userId); }
+std::optional<Room>    find(const RoomsRepository& repo, const Room& r)      { return repo.get(r.hotelId, r.number); }
+std::optional<Booking> find(const BookingRepository& repo, const Booking& b) { return repo.get(b.bookingId); }
+
+bool erase(HotelRepository& repo, const Hotel& h)     { return repo.remove(h.id); }
+bool erase(UserRepository& repo, const User& u)       { return repo.removeById(u.userId); }
+bool erase(RoomsRepository& repo, const Room& r)      { return repo.remove(r.hotelId, r.number); }
+bool erase(BookingRepository& repo, const Booking& b) { return repo.remove(b.bookingId); }
+
+template <typename Repo, typename Row>
+void fill(Repo& repo, const std::vector<Row>& rows) {
+    for (const auto& row : rows) repo.upsert(row);
+}
+
+// Visits rows in a scattered but deterministic order.
+std::size_t scatter(std::size_t i, std::size_t n) {
+    return (i * 7'919) % n;
+}
+
+template <typename Repo, typename Row, const std::vector<Row>& (*Rows)(std::int64_t)>
+void BM_Load(benchmark::State& state) {
+    const auto& rows = Rows(state.range(0));
+    TempDir tmp;
+    const auto path = tmp.join("data.json");
+    {
+        Repo seed{path};
+        seed.load();
+        fill(seed, rows);
+        seed.saveAll();
+    }
+
+    Repo repo{path};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repo.load());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fs::file_size(path)));
+}
+
+template <typename Repo, typename Row, const std::vector<Row>& (*Rows)(std::int64_t)>
+void BM_SaveAll(benchmark::State& state) {
+    const auto& rows = Rows(state.range(0));
+    TempDir tmp;
+    const auto path = tmp.join("data.json");
+    Repo repo{path};
+    repo.load();
+    fill(repo, rows);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repo.saveAll());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fs::file_size(path)));
+}
+
+template <typename Repo, typename Row, const std::vector<Row>& (*Rows)(std::int64_t)>
+void BM_Get(benchmark::State& state) {
+    const auto& rows = Rows(state.range(0));
+    TempDir tmp;
+    Repo repo{tmp.join("data.json")};
+    repo.load();
+    fill(repo, rows);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(find(repo, rows[scatter(i++, rows.size())]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Repo, typename Row, const std::vector<Row>& (*Rows)(std::int64_t)>
+void BM_Upsert(benchmark::State& state) {
+    const auto& rows = Rows(state.range(0));
+    TempDir tmp;
+    Repo repo{tmp.join("data.json")};
+    repo.load();
+    fill(repo, rows);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repo.upsert(rows[scatter(i++, rows.size())]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Repo, typename Row, const std::vector<Row>& (*Rows)(std::int64_t)>
+void BM_Remove(benchmark::State& state) {
+    const auto& rows = Rows(state.range(0));
+    TempDir tmp;
+    Repo repo{tmp.join("data.json")};
+    repo.load();
+    fill(repo, rows);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const auto& row = rows[scatter(i++, rows.size())];
+        benchmark::DoNotOptimize(erase(repo, row));
+        state.PauseTiming();
+        repo.upsert(row);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Loads a dining-heavy bookings.json written in format version range(1)
+// (1: nested {"kind","value"} items, 2: flat integer-tagged items).
+void BM_LoadDiningBookings(benchmark::State& state) {
+    const auto& rows = diningBookings(state.range(0));
+    TempDir tmp;
+    const auto path = tmp.join("bookings.json");
+    {
+        BookingRepository seed{path};
+        seed.load();
+        fill(seed, rows);
+        seed.setFormatVersion(static_cast<int>(state.range(1)));
+        seed.saveAll();
+    }
+
+    BookingRepository repo{path};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repo.load());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fs::file_size(path)));
+    state.counters["fileBytes"] = static_cast<double>(fs::file_size(path));
+}
+
+void BM_RoomsListByHotel(benchmark::State& state) {
+    const auto& rows = rooms(state.range(0));
+    TempDir tmp;
+    RoomsRepository repo{tmp.join("rooms.json")};
+    repo.load();
+    fill(repo, rows);
+
+    const std::int64_t hotelCount = std::max<std::int64_t>(1, state.range(0) / kRoomsPerHotel);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repo.listByHotel(hotelId(i++ % hotelCount)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_BookingsListByHotel(benchmark::State& state) {
+    const auto& rows = bookings(state.range(0));
+    TempDir tmp;
+    BookingRepository repo{tmp.join("bookings.json")};
+    repo.load();
+    fill(repo, rows);
+
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repo.listByHotel(hotelId(i++ % kHotels)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+#define HMS_REPOSITORY_BENCHMARKS(Repo, Row, Rows)                  \
+    BENCHMARK_TEMPLATE(BM_Load, Repo, Row, Rows)->Apply(sizes);     \
+    BENCHMARK_TEMPLATE(BM_SaveAll, Repo, Row, Rows)->Apply(sizes);  \
+    BENCHMARK_TEMPLATE(BM_Get, Repo, Row, Rows)->Apply(sizes);      \
+    BENCHMARK_TEMPLATE(BM_Upsert, Repo, Row, Rows)->Apply(sizes);   \
+    BENCHMARK_TEMPLATE(BM_Remove, Repo, Row, Rows)->Apply(sizes)
+
+HMS_REPOSITORY_BENCHMARKS(HotelRepository, Hotel, hotels);
+HMS_REPOSITORY_BENCHMARKS(UserRepository, User, users);
+HMS_REPOSITORY_BENCHMARKS(RoomsRepository, Room, rooms);
+HMS_REPOSITORY_BENCHMARKS(BookingRepository, Booking, bookings);
+
+BENCHMARK(BM_LoadDiningBookings)
+    ->ArgsProduct({{1'000, 100'000}, {1, 2}})
+    ->ArgNames({"bookings", "format"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RoomsListByHotel)->Apply(sizes);
+BENCHMARK(BM_BookingsListByHotel)->Apply(sizes);
@@ -1,18 +1,95 @@
 #include "ui/Router.h"
 #include "ui/AppContext.h"
+#include "server/SessionServer.h"
+#include "diagnostics/Trace.h"
+#include "storage/BackgroundCompactor.h"
+#include "security/Security.h"
 
-int main(){
-    hms::UserRepository    users;
-    hms::RoomsRepository   rooms;
-    hms::HotelRepository   hotels;
-    hms::BookingRepository bookings;
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string_view>
+
+int main(int argc, char** argv){
+    // Tracing: HMS_TRACE=1|<file>, or --trace [file]. Written on exit.
+    // --compact-json: save data files without indentation.
+    // --sharded-bookings: keep bookings in one file (and lock) per hotel.
+    // --archive-after-days <n>: on start-up, move bookings closed for more
+    // than n days into the compressed archive (data/archive).
+    // --journal-bookings: append each booking change to a journal instead
+    // of rewriting booking files; a background thread compacts them.
+    // --password-iterations <n>: PBKDF2 cost of new password hashes; older
+    // hashes are upgraded at their next login.
+    // --serve [socket]: serve concurrent sessions over a Unix socket sharing
+    // one in-memory store; --connect [socket]: open a session on such a server.
+    auto& tracer = hms::diagnostics::Tracer::instance();
+    tracer.enableFromEnvironment();
+    auto jsonStyle = hms::JsonStyle::Pretty;
+    bool shardedBookings = false;
+    bool journalBookings = false;
+    int archiveAfterDays = 0;
+    enum class Mode { Console, Serve, Connect } mode = Mode::Console;
+    std::filesystem::path socketPath = hms::server::defaultSocketPath();
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg{argv[i]};
+        const bool hasPath = i + 1 < argc && argv[i + 1][0] != '-';
+        if (arg == "--compact-json") jsonStyle = hms::JsonStyle::Compact;
+        if (arg == "--sharded-bookings") shardedBookings = true;
+        if (arg == "--journal-bookings") journalBookings = true;
+        if (arg == "--password-iterations" && i + 1 < argc) {
+            hms::SetPasswordIterations(static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        }
+        if (arg == "--archive-after-days" && i + 1 < argc) archiveAfterDays = std::atoi(argv[++i]);
+        if (arg == "--serve" || arg == "--connect") {
+            mode = arg == "--serve" ? Mode::Serve : Mode::Connect;
+            if (hasPath) socketPath = argv[++i];
+        }
+        if (arg != "--trace") continue;
+        tracer.enable(hasPath ? std::filesystem::path{argv[++i]} : hms::diagnostics::defaultTracePath());
+    }
+    if (mode == Mode::Connect) return hms::server::connect(socketPath);
+
+    // Let std::cout buffer instead of writing through to stdio on every insert.
+    // std::cin stays tied to std::cout, so prompts still appear before reads.
+    std::ios::sync_with_stdio(false);
+
+    hms::UserRepository       users;
+    hms::RoomsRepository      rooms;
+    hms::HotelRepository      hotels;
+    hms::BookingRepository    bookings;
+    hms::RestaurantRepository restaurants;
+    hms::PricingEngine        pricing;
+    hms::BookingArchive       archive;
+    users.setJsonStyle(jsonStyle);
+    rooms.setJsonStyle(jsonStyle);
+    hotels.setJsonStyle(jsonStyle);
+    bookings.setJsonStyle(jsonStyle);
+    bookings.setSharded(shardedBookings);
+    bookings.setJournaled(journalBookings);
+    archive.setMinimumAge(std::int64_t{archiveAfterDays} * 24 * 60 * 60);
 
     hms::AppContext ctx{
-            .svc = { &users, &rooms, &hotels, &bookings },
+            .svc = { &users, &rooms, &hotels, &bookings, &restaurants, &pricing, &archive },
             .currentUser = std::nullopt,
             .running = true
     };
 
-    hms::ui::Run(ctx);
-    return 0;
+    std::optional<hms::BackgroundCompactor> compactor;
+    if (journalBookings) compactor.emplace(bookings);
+
+    int status = 0;
+    if (mode == Mode::Serve) {
+        status = hms::ui::LoadAll(ctx) && hms::server::serve(ctx.svc, socketPath) ? 0 : 1;
+    }
+    else {
+        hms::ui::Run(ctx);
+    }
+    compactor.reset();
+
+    if (tracer.enabled()) {
+        if (tracer.flush()) std::cout << "Trace written to " << tracer.outputPath().string() << '\n';
+        else                std::cerr << "Could not write trace to " << tracer.outputPath().string() << '\n';
+    }
+    return status;
 }
@@ -0,0 +1,251 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <system_error>
+
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path baseDataDir() {
+#ifdef HMS_DATA_DIR
+    return fs::path{HMS_DATA_DIR};
+#else
+    return (fs::current_path() / "data").lexically_normal();
+#endif
+}
+
+bool ensureParentDir(const fs::path& p) {
+    try {
+        auto dir = p.parent_path();
+        if (!dir.empty() && !fs::exists(dir)) {
+            return fs::create_directories(dir);
+        }
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+std::string formatNanos(std::uint64_t nanos) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    if (nanos < 1'000)              oss << nanos << " ns";
+    else if (nanos < 1'000'000)     oss << static_cast<double>(nanos) / 1e3 << " us";
+    else if (nanos < 1'000'000'000) oss << static_cast<double>(nanos) / 1e6 << " ms";
+    else                            oss << static_cast<double>(nanos) / 1e9 << " s";
+    return oss.str();
+}
+
+}
+
+namespace hms::diagnostics {
+
+// ---- LatencyHistogram ----
+
+std::size_t LatencyHistogram::bucketFor(std::uint64_t value) {
+    if (value < kSubBuckets) return static_cast<std::size_t>(value);
+    const int shift = std::bit_width(value) - 1 - kSubBucketBits;
+    return static_cast<std::size_t>(shift + 1) * kSubBuckets
+         + static_cast<std::size_t>((value >> shift) - kSubBuckets);
+}
+
+std::uint64_t LatencyHistogram::lowerBound(std::size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    const auto shift = bucket / kSubBuckets - 1;
+    return (kSubBuckets + bucket % kSubBuckets) << shift;
+}
+
+std::uint64_t LatencyHistogram::upperBound(std::size_t bucket) {
+    if (bucket + 1 >= kBucketCount) return UINT64_MAX;
+    return lowerBound(bucket + 1) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t nanos) {
+    buckets_[bucketFor(nanos)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(nanos, std::memory_order_relaxed);
+
+    auto seen = min_.load(std::memory_order_relaxed);
+    while (nanos < seen && !min_.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {}
+    seen = max_.load(std::memory_order_relaxed);
+    while (nanos > seen && !max_.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::min() const {
+    const auto value = min_.load(std::memory_order_relaxed);
+    return value == UINT64_MAX ? 0 : value;
+}
+
+std::uint64_t LatencyHistogram::percentile(double p) const {
+    const auto total = count();
+    if (total == 0) return 0;
+    p = std::clamp(p, 0.0, 100.0);
+    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5));
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(upperBound(i), max());
+    }
+    return max();
+}
+
+std::vector<std::pair<std::uint64_t, std::uint64_t>> LatencyHistogram::buckets() const {
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> out;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        const auto n = buckets_[i].load(std::memory_order_relaxed);
+        if (n != 0) out.emplace_back(upperBound(i), n);
+    }
+    return out;
+}
+
+// ---- Registry ----
+
+Registry& Registry::instance() {
+    static Registry registry;
+    return registry;
+}
+
+LatencyHistogram& Registry::histogram(std::string_view name) {
+    std::lock_guard lock(mutex_);
+    auto it = histograms_.find(name);
+    if (it == histograms_.end()) {
+        it = histograms_.emplace(std::string(name), std::make_unique<LatencyHistogram>()).first;
+    }
+    return *it->second;
+}
+
+Counter& Registry::counter(std::string_view name) {
+    std::lock_guard lock(mutex_);
+    auto it = counters_.find(name);
+    if (it == counters_.end()) {
+        it = counters_.emplace(std::string(name), std::make_unique<Counter>()).first;
+    }
+    return *it->second;
+}
+
+std::vector<HistogramSummary> Registry::histograms() const {
+    std::lock_guard lock(mutex_);
+    std::vector<HistogramSummary> out;
+    out.reserve(histograms_.size());
+    for (const auto& [name, h] : histograms_) {
+        HistogramSummary s;
+        s.name = name;
+        s.count = h->count();
+        s.meanNanos = s.count ? h->sum() / s.count : 0;
+        s.p50Nanos = h->percentile(50.0);
+        s.p90Nanos = h->percentile(90.0);
+        s.p99Nanos = h->percentile(99.0);
+        s.maxNanos = h->max();
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+std::vector<std::pair<std::string, std::uint64_t>> Registry::counters() const {
+    std::lock_guard lock(mutex_);
+    std::vector<std::pair<std::string, std::uint64_t>> out;
+    out.reserve(counters_.size());
+    for (const auto& [name, c] : counters_) out.emplace_back(name, c->value());
+    return out;
+}
+
+void Registry::reset() {
+    std::lock_guard lock(mutex_);
+    for (auto& entry : histograms_) entry.second->reset();
+    for (auto& entry : counters_) entry.second->reset();
+}
+
+void Registry::writeReport(std::ostream& out) const {
+    const auto rows = histograms();
+    out << std::left << std::setw(28) << "Operation"
+        << std::right << std::setw(9) << "Count"
+        << std::setw(11) << "Mean"
+        << std::setw(11) << "p50"
+        << std::setw(11) << "p90"
+        << std::setw(11) << "p99"
+        << std::setw(11) << "Max" << '\n';
+    out << std::string(92, '-') << '\n';
+    for (const auto& row : rows) {
+        if (row.count == 0) continue;
+        out << std::left << std::setw(28) << row.name
+            << std::right << std::setw(9) << row.count
+            << std::setw(11) << formatNanos(row.meanNanos)
+            << std::setw(11) << formatNanos(row.p50Nanos)
+            << std::setw(11) << formatNanos(row.p90Nanos)
+            << std::setw(11) << formatNanos(row.p99Nanos)
+            << std::setw(11) << formatNanos(row.maxNanos) << '\n';
+    }
+
+    out << '\n' << std::left << std::setw(28) << "Counter" << std::right << std::setw(16) << "Value" << '\n';
+    out << std::string(44, '-') << '\n';
+    for (const auto& [name, value] : counters()) {
+        out << std::left << std::setw(28) << name << std::right << std::setw(16) << value << '\n';
+    }
+    out << std::left;
+}
+
+bool Registry::dumpToFile(const fs::path& path) const {
+    if (!ensureParentDir(path)) return false;
+
+    json doc = json::object();
+    doc["generatedAt"] = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    json histograms = json::object();
+    {
+        std::lock_guard lock(mutex_);
+        for (const auto& [name, h] : histograms_) {
+            json buckets = json::array();
+            for (const auto& [upper, n] : h->buckets()) buckets.push_back({upper, n});
+            histograms[name] = {
+                {"count", h->count()},
+                {"sumNanos", h->sum()},
+                {"minNanos", h->min()},
+                {"maxNanos", h->max()},
+                {"p50Nanos", h->percentile(50.0)},
+                {"p90Nanos", h->percentile(90.0)},
+                {"p99Nanos", h->percentile(99.0)},
+                {"p999Nanos", h->percentile(99.9)},
+                {"buckets", std::move(buckets)} // [upper bound ns, count]
+            };
+        }
+    }
+    doc["histograms"] = std::move(histograms);
+
+    json counters = json::object();
+    for (const auto& [name, value] : this->counters()) counters[name] = value;
+    doc["counters"] = std::move(counters);
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.good()) return false;
+    out << doc.dump(2) << '\n';
+    out.flush();
+    return out.good();
+}
+
+fs::path defaultDumpPath() {
+    const auto stamp = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return (baseDataDir() / "diagnostics" / ("metrics-" + std::to_string(stamp) + ".json")).lexically_normal();
+}
+
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Trace.h"
+
+namespace hms::diagnostics {
+
+    // Log-linear latency histogram in the HDR style: every power of two is
+    // split into 16 linear sub-buckets, so any recorded value is reported
+    // within 1/16 (6.25%) of its true value from 1 ns up to the full 64-bit
+    // range. Recording is a handful of relaxed atomic adds and never locks.
+    class LatencyHistogram {
+    public:
+        static constexpr int         kSubBucketBits = 4;
+        static constexpr std::size_t kSubBuckets    = std::size_t{1} << kSubBucketBits;
+        static constexpr std::size_t kBucketCount   = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+        void record(std::uint64_t nanos);
+        void reset();
+
+        std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        std::uint64_t sum() const   { return sum_.load(std::memory_order_relaxed); }
+        std::uint64_t min() const;  // 0 when empty
+        std::uint64_t max() const   { return max_.load(std::memory_order_relaxed); }
+        std::uint64_t percentile(double p) const; // upper bound of the bucket holding p (0..100)
+
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> buckets() const; // (upper bound, count), non-empty only
+
+        static std::size_t   bucketFor(std::uint64_t value);
+        static std::uint64_t lowerBound(std::size_t bucket);
+        static std::uint64_t upperBound(std::size_t bucket);
+
+    private:
+        std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_{};
+        std::atomic<std::uint64_t> count_{0};
+        std::atomic<std::uint64_t> sum_{0};
+        std::atomic<std::uint64_t> min_{UINT64_MAX};
+        std::atomic<std::uint64_t> max_{0};
+    };
+
+    class Counter {
+    public:
+        void add(std::uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+        std::uint64_t value() const   { return value_.load(std::memory_order_relaxed); }
+        void reset()                  { value_.store(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<std::uint64_t> value_{0};
+    };
+
+    struct HistogramSummary {
+        std::string   name;
+        std::uint64_t count{};
+        std::uint64_t meanNanos{};
+        std::uint64_t p50Nanos{};
+        std::uint64_t p90Nanos{};
+        std::uint64_t p99Nanos{};
+        std::uint64_t maxNanos{};
+    };
+
+    // Process-wide, name-keyed metrics. Lookups take a lock, so call sites
+    // resolve their histogram or counter once (HMS_SCOPED_LATENCY and
+    // HMS_COUNTER_ADD cache it in a function-local static) and afterwards only
+    // touch atomics. Entries are never removed, so references stay valid.
+    class Registry {
+    public:
+        static Registry& instance();
+
+        LatencyHistogram& histogram(std::string_view name);
+        Counter&          counter(std::string_view name);
+
+        std::vector<HistogramSummary>                      histograms() const; // sorted by name
+        std::vector<std::pair<std::string, std::uint64_t>> counters() const;   // sorted by name
+
+        void reset(); // zero every value, keep the names
+
+        void writeReport(std::ostream& out) const; // human-readable table
+        bool dumpToFile(const std::filesystem::path& path) const; // JSON incl. raw buckets
+
+    private:
+        mutable std::mutex mutex_;
+        std::map<std::string, std::unique_ptr<LatencyHistogram>, std::less<>> histograms_;
+        std::map<std::string, std::unique_ptr<Counter>, std::less<>>          counters_;
+    };
+
+    // Records the lifetime of the enclosing scope into a histogram and, when
+    // tracing is on, as a "storage" trace span with the same name.
+    class ScopedLatency {
+    public:
+        ScopedLatency(LatencyHistogram& histogram, const char* name)
+            : histogram_(histogram), name_(name), start_(std::chrono::steady_clock::now()) {}
+        ~ScopedLatency() {
+            const auto end = std::chrono::steady_clock::now();
+            histogram_.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count()));
+            auto& tracer = Tracer::instance();
+            if (tracer.enabled()) tracer.record(name_, "storage", start_, end);
+        }
+        ScopedLatency(const ScopedLatency&) = delete;
+        ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+    private:
+        LatencyHistogram& histogram_;
+        const char* name_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // Where the admin dashboard writes metric dumps by default.
+    std::filesystem::path defaultDumpPath();
+
+}
+
+#define HMS_METRICS_CONCAT_INNER(a, b) a##b
+#define HMS_METRICS_CONCAT(a, b) HMS_METRICS_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing scope under `name` (a string literal).
+#define HMS_SCOPED_LATENCY(name)                                                              \
+    static ::hms::diagnostics::LatencyHistogram& HMS_METRICS_CONCAT(hmsHistogram_, __LINE__) = \
+        ::hms::diagnostics::Registry::instance().histogram(name);                              \
+    const ::hms::diagnostics::ScopedLatency HMS_METRICS_CONCAT(hmsLatency_, __LINE__){         \
+        HMS_METRICS_CONCAT(hmsHistogram_, __LINE__), name}
+
+// Adds `n` to the counter `name` (a string literal).
+#define HMS_COUNTER_ADD(name, n)                                                  \
+    do {                                                                          \
+        static ::hms::diagnostics::Counter& hmsCounter_ =                         \
+            ::hms::diagnostics::Registry::instance().counter(name);               \
+        hmsCounter_.add(static_cast<std::uint64_t>(n));                           \
+    } while (0)
@@ -0,0 +1,172 @@
+#include "Trace.h"
+
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path baseDataDir() {
+#ifdef HMS_DATA_DIR
+    return fs::path{HMS_DATA_DIR};
+#else
+    return (fs::current_path() / "data").lexically_normal();
+#endif
+}
+
+bool ensureParentDir(const fs::path& p) {
+    try {
+        auto dir = p.parent_path();
+        if (!dir.empty() && !fs::exists(dir)) {
+            return fs::create_directories(dir);
+        }
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+struct Event {
+    const char*  name;
+    const char*  category;
+    std::int64_t beginNanos; // since the tracer epoch
+    std::int64_t durationNanos;
+};
+
+// Fixed-size block of events. Only the owning thread writes; `size` is
+// published with release so a flushing thread sees complete events.
+struct Chunk {
+    static constexpr std::size_t kCapacity = 4096;
+
+    std::array<Event, kCapacity> events{};
+    std::atomic<std::size_t>     size{0};
+    std::atomic<Chunk*>          next{nullptr};
+};
+
+// One per recording thread, linked into a global list the first time the
+// thread records. Buffers are never freed: spans outlive their threads.
+struct ThreadBuffer {
+    Chunk                      first;
+    Chunk*                     tail{&first};
+    std::uint32_t              tid{};
+    std::atomic<ThreadBuffer*> next{nullptr};
+};
+
+std::atomic<ThreadBuffer*> gBuffers{nullptr};
+std::atomic<std::uint32_t> gNextTid{1};
+
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = [] {
+        auto* b = new ThreadBuffer;
+        b->tid = gNextTid.fetch_add(1, std::memory_order_relaxed);
+        auto* head = gBuffers.load(std::memory_order_relaxed);
+        do { b->next.store(head, std::memory_order_relaxed); }
+        while (!gBuffers.compare_exchange_weak(head, b, std::memory_order_release, std::memory_order_relaxed));
+        return b;
+    }();
+    return *buffer;
+}
+
+void writeJsonString(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; ++s) {
+        const char ch = *s;
+        if (ch == '"' || ch == '\\') out << '\\' << ch;
+        else if (static_cast<unsigned char>(ch) < 0x20) out << ' ';
+        else out << ch;
+    }
+    out << '"';
+}
+
+// Chrome trace timestamps are microseconds; keep sub-microsecond precision.
+void writeMicros(std::ostream& out, std::int64_t nanos) {
+    out << nanos / 1000 << '.';
+    const auto frac = nanos % 1000;
+    if (frac < 100) out << '0';
+    if (frac < 10) out << '0';
+    out << frac;
+}
+
+}
+
+namespace hms::diagnostics {
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::enable(const fs::path& path) {
+    path_ = path;
+    enabled_.store(true, std::memory_order_release);
+}
+
+void Tracer::enableFromEnvironment() {
+    const char* value = std::getenv("HMS_TRACE");
+    if (value == nullptr || *value == '\0') return;
+    const std::string setting{value};
+    enable(setting == "1" ? defaultTracePath() : fs::path(setting));
+}
+
+void Tracer::record(const char* name, const char* category, clock::time_point begin, clock::time_point end) {
+    auto& buffer = localBuffer();
+    Chunk* chunk = buffer.tail;
+    auto n = chunk->size.load(std::memory_order_relaxed);
+    if (n == Chunk::kCapacity) {
+        auto* fresh = new Chunk;
+        chunk->next.store(fresh, std::memory_order_release);
+        buffer.tail = chunk = fresh;
+        n = 0;
+    }
+    if (begin < epoch_) begin = epoch_; // span opened before the tracer existed
+    chunk->events[n] = Event{
+        name, category,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch_).count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()};
+    chunk->size.store(n + 1, std::memory_order_release);
+}
+
+bool Tracer::flush() const {
+    if (!enabled() || !ensureParentDir(path_)) return false;
+
+    std::ofstream out(path_, std::ios::trunc);
+    if (!out.good()) return false;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Hotel_Management_System\"}}";
+    for (auto* b = gBuffers.load(std::memory_order_acquire); b; b = b->next.load(std::memory_order_relaxed)) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+            << ",\"args\":{\"name\":\"thread-" << b->tid << "\"}}";
+        for (const Chunk* c = &b->first; c; c = c->next.load(std::memory_order_acquire)) {
+            const auto n = c->size.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto& e = c->events[i];
+                out << ",\n{\"name\":";
+                writeJsonString(out, e.name);
+                out << ",\"cat\":";
+                writeJsonString(out, e.category);
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid << ",\"ts\":";
+                writeMicros(out, e.beginNanos);
+                out << ",\"dur\":";
+                writeMicros(out, e.durationNanos);
+                out << '}';
+            }
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    return out.good();
+}
+
+fs::path defaultTracePath() {
+    const auto stamp = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return (baseDataDir() / "diagnostics" / ("trace-" + std::to_string(stamp) + ".json")).lexically_normal();
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+namespace hms::diagnostics {
+
+    // Span recorder that writes Chrome trace-event JSON (chrome://tracing,
+    // ui.perfetto.dev). Off by default; when off a span costs one relaxed load.
+    //
+    // Each thread appends finished spans to its own chunked buffer and
+    // publishes them with a release store, so recording never locks or
+    // contends with other threads. Span names and categories must be string
+    // literals (or otherwise outlive the trace).
+    class Tracer {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static Tracer& instance();
+
+        // Starts collecting; the trace is written to `path` by flush().
+        void enable(const std::filesystem::path& path);
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+        const std::filesystem::path& outputPath() const { return path_; }
+
+        // Writes every span recorded so far. Safe while other threads record;
+        // spans still open are not included.
+        bool flush() const;
+
+        void record(const char* name, const char* category, clock::time_point begin, clock::time_point end);
+
+        // Reads HMS_TRACE: unset or empty leaves tracing off, "1" traces to
+        // defaultTracePath(), anything else is used as the output path.
+        void enableFromEnvironment();
+
+    private:
+        Tracer() = default;
+
+        std::atomic<bool>     enabled_{false};
+        std::filesystem::path path_;
+        clock::time_point     epoch_{clock::now()};
+    };
+
+    std::filesystem::path defaultTracePath();
+
+    class TraceSpan {
+    public:
+        TraceSpan(const char* name, const char* category)
+            : name_(name), category_(category) {
+            if (Tracer::instance().enabled()) begin_ = Tracer::clock::now();
+        }
+        ~TraceSpan() {
+            if (begin_ != Tracer::clock::time_point{}) {
+                Tracer::instance().record(name_, category_, begin_, Tracer::clock::now());
+            }
+        }
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+    private:
+        const char* name_;
+        const char* category_;
+        Tracer::clock::time_point begin_{};
+    };
+
+}
+
+#define HMS_TRACE_CONCAT_INNER(a, b) a##b
+#define HMS_TRACE_CONCAT(a, b) HMS_TRACE_CONCAT_INNER(a, b)
+
+// Traces the rest of the enclosing scope as `name` in `category` (string literals).
+#define HMS_TRACE_SPAN(name, category) \
+    const ::hms::diagnostics::TraceSpan HMS_TRACE_CONCAT(hmsTraceSpan_, __LINE__){name, category}
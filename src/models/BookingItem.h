@@ -1,8 +1,8 @@
 #pragma once
+#include <array>
+#include <string_view>
 #include <variant>
-#include <string>
-#include <stdexcept>
-#include <nlohmann/json.hpp>
+#include "Schema.h"
 
 #include "RoomStayItem.h"
 #include "RestaurantOrderLine.h"
@@ -20,34 +20,10 @@ namespace hms {
         return BookingType::RoomStayItem;
     }
 
-    // ---------- JSON (de)serialization for BookingItem ----------
-    // We serialize as an object: { "kind": "...", "value": { ... } }
-    inline void to_json(nlohmann::json& j, const BookingItem& bi) {
-        if (std::holds_alternative<RoomStayItem>(bi)) {
-            j = nlohmann::json{
-                {"kind",  "RoomStayItem"},
-                {"value", std::get<RoomStayItem>(bi)}
-            };
-        }
-        else {
-            j = nlohmann::json{
-                {"kind",  "RestaurantOrder"},
-                {"value", std::get<RestaurantOrderLine>(bi)}
-            };
-        }
-    }
-
-    inline void from_json(const nlohmann::json& j, BookingItem& bi) {
-        const std::string kind = j.at("kind").get<std::string>();
-        if (kind == "RoomStayItem") {
-            bi = j.at("value").get<RoomStayItem>();
-        }
-        else if (kind == "RestaurantOrder") {
-            bi = j.at("value").get<RestaurantOrderLine>();
-        }
-        else {
-            throw std::runtime_error("Unknown BookingItem kind: " + kind);
-        }
-    }
+    // Serialized flat as { "t": <index>, ...fields }; see Schema.h. The
+    // legacy { "kind": <name>, "value": { ... } } form is read by name.
+    template <> struct VariantKinds<BookingItem> {
+        static constexpr std::array<std::string_view, 2> names{"RoomStayItem", "RestaurantOrder"};
+    };
 
 }
@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "BookingItem.h"
+#include "Codec.h"
+
+namespace hms {
+
+    // The items of a booking. Bookings read by BookingRepository::load keep
+    // their items as the compact JSON text of the file and decode it the
+    // first time anything looks at them (iteration, indexing, changes), so
+    // a history that is only listed never pays for rooms, occupants and
+    // order lines. Bookings built in memory hold decoded items throughout.
+    //
+    // Const accessors may decode in place: like the other model types, one
+    // BookingItems must not be used from two threads at once. Repositories
+    // hand out copies, so their own rows stay encoded.
+    class BookingItems {
+    public:
+        using value_type     = BookingItem;
+        using iterator       = std::vector<BookingItem>::iterator;
+        using const_iterator = std::vector<BookingItem>::const_iterator;
+
+        BookingItems() = default;
+        BookingItems(std::initializer_list<BookingItem> items) : items_(items) {}
+
+        // `count` items still encoded as the JSON array `text`.
+        static BookingItems deferred(std::string text, std::size_t count) {
+            BookingItems out;
+            out.encoded_ = std::move(text);
+            out.count_ = count;
+            out.state_ = State::Pending;
+            return out;
+        }
+
+        bool isDecoded() const noexcept { return state_ == State::Decoded; }
+        // The encoded text could not be turned into items (hand-edited file):
+        // the list reads as empty and saving the booking fails rather than
+        // dropping it.
+        bool decodeFailed() const noexcept { return state_ == State::Broken; }
+
+        std::size_t size() const noexcept  { return state_ == State::Pending ? count_ : items_.size(); }
+        bool        empty() const noexcept { return size() == 0; }
+
+        const std::vector<BookingItem>& decoded() const { decode(); return items_; }
+        std::vector<BookingItem>&       decoded()       { decode(); return items_; }
+
+        // Decoded items without caching them here; throws when the text is
+        // not a valid item list.
+        std::vector<BookingItem> decodedCopy() const {
+            if (state_ == State::Decoded) return items_;
+            std::vector<BookingItem> out;
+            if (!decodeText(encoded_, out)) throw std::runtime_error("booking items cannot be decoded");
+            return out;
+        }
+
+        const_iterator begin() const { return decoded().begin(); }
+        const_iterator end() const   { return decoded().end(); }
+        iterator       begin()       { return decoded().begin(); }
+        iterator       end()         { return decoded().end(); }
+
+        const BookingItem& operator[](std::size_t i) const { return decoded()[i]; }
+        BookingItem&       operator[](std::size_t i)       { return decoded()[i]; }
+        const BookingItem& at(std::size_t i) const { return decoded().at(i); }
+        BookingItem&       at(std::size_t i)       { return decoded().at(i); }
+        const BookingItem& front() const { return decoded().front(); }
+        const BookingItem& back() const  { return decoded().back(); }
+
+        void push_back(BookingItem item) { decoded().push_back(std::move(item)); }
+        template <typename... Args>
+        BookingItem& emplace_back(Args&&... args) { return decoded().emplace_back(std::forward<Args>(args)...); }
+        void pop_back() { decoded().pop_back(); }
+        void reserve(std::size_t n) { decoded().reserve(n); }
+        void resize(std::size_t n)  { decoded().resize(n); }
+        void clear() {
+            items_.clear();
+            encoded_.clear();
+            count_ = 0;
+            state_ = State::Decoded;
+        }
+
+    private:
+        enum class State : unsigned char { Decoded, Pending, Broken };
+
+        static bool decodeText(std::string_view text, std::vector<BookingItem>& out) {
+            const auto doc = nlohmann::json::parse(text, nullptr, /*allow_exceptions=*/false);
+            if (!doc.is_array()) return false;
+            try {
+                doc.get_to(out);
+            }
+            catch (...) {
+                return false;
+            }
+            return true;
+        }
+
+        void decode() const {
+            if (state_ != State::Pending) return;
+            if (decodeText(encoded_, items_)) {
+                encoded_ = std::string();
+                state_ = State::Decoded;
+            }
+            else {
+                items_.clear();
+                state_ = State::Broken; // keep the text so it is not saved away
+            }
+        }
+
+        mutable std::vector<BookingItem> items_;
+        mutable std::string              encoded_; // Pending / Broken only
+        std::size_t                      count_{0};
+        mutable State                    state_{State::Decoded};
+    };
+
+    // Pending items are decoded into a temporary for writing, so saving a
+    // loaded history does not leave every booking decoded in memory.
+    template <typename Sink>
+    void writeJson(JsonWriter<Sink>& w, const BookingItems& items) {
+        if (items.isDecoded()) {
+            writeJson(w, items.decoded());
+            return;
+        }
+        writeJson(w, items.decodedCopy());
+    }
+
+    template <typename BasicJsonType>
+    void to_json(BasicJsonType& j, const BookingItems& items) {
+        if (items.isDecoded()) j = items.decoded();
+        else j = items.decodedCopy();
+    }
+
+    template <typename BasicJsonType>
+    void from_json(const BasicJsonType& j, BookingItems& items) {
+        items.clear();
+        j.get_to(items.decoded());
+    }
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+#include "Booking.h"
+#include "Room.h"
+
+namespace hms {
+
+// Per-booking totals derived from its items (money in cents).
+struct BookingMetrics {
+    int rooms{};
+    int roomNights{};
+    int guests{};
+    std::int64_t roomRevenue{};
+    std::int64_t diningRevenue{};
+};
+
+inline BookingMetrics summarize(const Booking& booking) {
+    BookingMetrics metrics{};
+    for (const auto& item : booking.items) {
+        if (std::holds_alternative<RoomStayItem>(item)) {
+            const auto& stay = std::get<RoomStayItem>(item);
+            ++metrics.rooms;
+            metrics.roomNights += stay.nights;
+            metrics.roomRevenue += stay.nightlyRateLocked * stay.nights;
+            metrics.guests += static_cast<int>(stay.occupants.size());
+        }
+        else if (std::holds_alternative<RestaurantOrderLine>(item)) {
+            const auto& order = std::get<RestaurantOrderLine>(item);
+            metrics.diningRevenue += order.unitPriceSnapshot * order.qty;
+        }
+    }
+    return metrics;
+}
+
+// Figures behind the admin "Operational reports" screen.
+struct OperationsSnapshot {
+    int totalRooms{};
+    int activeRooms{};
+    int activeBookings{};
+    int checkedOutBookings{};
+    int activeRoomUsage{};          // rooms held by active bookings
+    std::int64_t activeRevenue{};   // room + dining, active bookings
+    std::int64_t realizedRevenue{}; // room + dining, checked-out bookings
+
+    double occupancyPercent() const {
+        return activeRooms > 0
+            ? (static_cast<double>(activeRoomUsage) / static_cast<double>(activeRooms)) * 100.0
+            : 0.0;
+    }
+};
+
+// Adds one booking's figures to `snap`; lets archived bookings, which are
+// streamed rather than listed, count towards the same snapshot.
+inline void accumulate(OperationsSnapshot& snap, const Booking& booking) {
+    const auto metrics = summarize(booking);
+    if (booking.status == BookingStatus::ACTIVE) {
+        ++snap.activeBookings;
+        snap.activeRoomUsage += metrics.rooms;
+        snap.activeRevenue += metrics.roomRevenue + metrics.diningRevenue;
+    }
+    else if (booking.status == BookingStatus::CHECKED_OUT) {
+        ++snap.checkedOutBookings;
+        snap.realizedRevenue += metrics.roomRevenue + metrics.diningRevenue;
+    }
+}
+
+inline OperationsSnapshot summarize(const std::vector<Room>& rooms,
+                                    const std::vector<Booking>& bookings) {
+    OperationsSnapshot snap{};
+    snap.totalRooms = static_cast<int>(rooms.size());
+    for (const auto& room : rooms) if (room.active) ++snap.activeRooms;
+
+    for (const auto& booking : bookings) accumulate(snap, booking);
+    return snap;
+}
+
+}
@@ -1,14 +1,25 @@
 #pragma once
-#include <nlohmann/json.hpp>
+#include <string_view>
+#include <utility>
+#include "Schema.h"
 
 namespace hms {
 
 enum class BookingStatus { ACTIVE, CHECKED_OUT, CANCELLED };
 
-NLOHMANN_JSON_SERIALIZE_ENUM(BookingStatus, {
+// JSON names; see EnumWithNames in Schema.h.
+inline constexpr std::pair<BookingStatus, std::string_view> kBookingStatusNames[] = {
     {BookingStatus::ACTIVE, "ACTIVE"},
     {BookingStatus::CHECKED_OUT, "CHECKED_OUT"},
     {BookingStatus::CANCELLED, "CANCELLED"}
-})
+};
+
+constexpr const auto& enumNames(BookingStatus) { return kBookingStatusNames; }
+
+template <typename BasicJsonType>
+void to_json(BasicJsonType& j, const BookingStatus& value) { enumToJson(j, value); }
+
+template <typename BasicJsonType>
+void from_json(const BasicJsonType& j, BookingStatus& value) { enumFromJson(j, value); }
 
 }
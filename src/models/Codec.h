@@ -0,0 +1,423 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "Ids.h"
+#include "Schema.h"
+
+namespace hms {
+
+    // std::vector and vector-like wrappers (e.g. BookingItems).
+    template <typename T>
+    concept Sequence = !std::is_convertible_v<const T&, std::string_view> && requires(T& v, const T& c) {
+        typename T::value_type;
+        c.begin();
+        c.end();
+        c.size();
+        v.clear();
+        v.resize(std::size_t{});
+    };
+
+    template <typename T>
+    inline constexpr bool always_false_v = false;
+
+    // ---- JSON text without a DOM ----
+
+    // Appends to a caller-owned string.
+    struct StringSink {
+        std::string& out;
+
+        void put(char c) { out.push_back(c); }
+        void write(const char* data, std::size_t size) { out.append(data, size); }
+    };
+
+    // Streams JSON tokens into `Sink` (put/write). With indent >= 0 the
+    // layout matches nlohmann's dump(indent); with indent < 0 it matches
+    // dump(). Strings are escaped the same way; UTF-8 is passed through
+    // unchecked. Memory use is one flag per open container. `variants`
+    // picks how tagged unions are written (see Schema.h).
+    template <typename Sink>
+    class JsonWriter {
+    public:
+        explicit JsonWriter(Sink& sink, int indent = -1, VariantLayout variants = VariantLayout::Flat)
+            : sink_(sink), indent_(indent), variants_(variants) {}
+
+        VariantLayout variantLayout() const { return variants_; }
+
+        void beginObject() { beforeValue(); sink_.put('{'); open_.push_back(false); }
+        void endObject()   { close('}'); }
+        void beginArray()  { beforeValue(); sink_.put('['); open_.push_back(false); }
+        void endArray()    { close(']'); }
+
+        void key(std::string_view name) {
+            separate();
+            quoted(name);
+            sink_.put(':');
+            if (indent_ >= 0) sink_.put(' ');
+            afterKey_ = true;
+        }
+
+        void string(std::string_view text) { beforeValue(); quoted(text); }
+        void boolean(bool value)           { beforeValue(); value ? sink_.write("true", 4) : sink_.write("false", 5); }
+        void null()                        { beforeValue(); sink_.write("null", 4); }
+
+        template <typename Int>
+            requires std::is_integral_v<Int>
+        void integer(Int value) {
+            beforeValue();
+            char buf[24];
+            const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+            sink_.write(buf, static_cast<std::size_t>(res.ptr - buf));
+        }
+
+        void number(double value) {
+            beforeValue();
+            char buf[32];
+            const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+            sink_.write(buf, static_cast<std::size_t>(res.ptr - buf));
+        }
+
+    private:
+        // Comma and line break before the next array element or object key.
+        void separate() {
+            if (open_.empty()) return;
+            if (open_.back()) sink_.put(',');
+            open_.back() = true;
+            newline(open_.size());
+        }
+
+        void beforeValue() {
+            if (afterKey_) { afterKey_ = false; return; }
+            separate();
+        }
+
+        void close(char bracket) {
+            const bool hadItems = open_.back();
+            open_.pop_back();
+            if (hadItems) newline(open_.size());
+            sink_.put(bracket);
+        }
+
+        void newline(std::size_t depth) {
+            if (indent_ < 0) return;
+            sink_.put('\n');
+            for (std::size_t i = 0; i < depth * static_cast<std::size_t>(indent_); ++i) sink_.put(' ');
+        }
+
+        void quoted(std::string_view text) {
+            static constexpr char kHex[] = "0123456789abcdef";
+            sink_.put('"');
+            std::size_t run = 0; // start of the pending unescaped run
+            for (std::size_t i = 0; i < text.size(); ++i) {
+                const auto ch = static_cast<unsigned char>(text[i]);
+                if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+                sink_.write(text.data() + run, i - run);
+                run = i + 1;
+                switch (ch) {
+                    case '"':  sink_.write("\\\"", 2); break;
+                    case '\\': sink_.write("\\\\", 2); break;
+                    case '\b': sink_.write("\\b", 2); break;
+                    case '\f': sink_.write("\\f", 2); break;
+                    case '\n': sink_.write("\\n", 2); break;
+                    case '\r': sink_.write("\\r", 2); break;
+                    case '\t': sink_.write("\\t", 2); break;
+                    default: {
+                        const char esc[6] = {'\\', 'u', '0', '0', kHex[ch >> 4], kHex[ch & 0xF]};
+                        sink_.write(esc, sizeof(esc));
+                    }
+                }
+            }
+            sink_.write(text.data() + run, text.size() - run);
+            sink_.put('"');
+        }
+
+        Sink&             sink_;
+        int               indent_;
+        VariantLayout     variants_;
+        std::vector<bool> open_; // per open container: has it written an item yet
+        bool              afterKey_{false};
+    };
+
+    template <typename Sink, typename T>
+    void writeJson(JsonWriter<Sink>& w, const T& value);
+
+    // The written fields of a described struct, without the braces.
+    template <typename Sink, Described T>
+    void writeFields(JsonWriter<Sink>& w, const T& value) {
+        forEachField<T>([&](const auto& f) {
+            if (f.presence == Presence::ReadOnly) return;
+            w.key(f.name);
+            writeJson(w, value.*f.member);
+        });
+    }
+
+    template <typename Sink, typename T>
+    void writeJson(JsonWriter<Sink>& w, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            w.boolean(value);
+        }
+        else if constexpr (EnumWithNames<T>) {
+            w.string(enumName(value));
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            w.integer(value);
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            w.number(value);
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            w.string(value);
+        }
+        else if constexpr (DescribedVariant<T>) {
+            w.beginObject();
+            if (w.variantLayout() == VariantLayout::Nested) {
+                w.key("kind");
+                w.string(kindName(value));
+                w.key("value");
+                std::visit([&](const auto& alt) { writeJson(w, alt); }, value);
+            }
+            else {
+                w.key(kVariantTagKey);
+                w.integer(value.index());
+                std::visit([&](const auto& alt) { writeFields(w, alt); }, value);
+            }
+            w.endObject();
+        }
+        else if constexpr (Described<T>) {
+            w.beginObject();
+            writeFields(w, value);
+            w.endObject();
+        }
+        else if constexpr (Sequence<T>) {
+            w.beginArray();
+            for (const auto& item : value) writeJson(w, item);
+            w.endArray();
+        }
+        else {
+            static_assert(always_false_v<T>, "type has no JSON encoding");
+        }
+    }
+
+    // Convenience: one value as JSON text.
+    template <typename T>
+    std::string toJsonText(const T& value, int indent = -1) {
+        std::string out;
+        StringSink sink{out};
+        JsonWriter<StringSink> w(sink, indent);
+        writeJson(w, value);
+        return out;
+    }
+
+    // ---- Binary ----
+    //
+    // Compact positional encoding: unsigned integers and lengths as LEB128
+    // varints, signed integers zigzagged, strings and vectors length
+    // prefixed, enums as their underlying value, variants as an alternative
+    // index followed by the value. A described struct starts with its field
+    // count, so a reader accepts records written before fields were appended
+    // (missing trailing fields keep their defaults). Only append new fields.
+
+    class BinaryWriter {
+    public:
+        explicit BinaryWriter(std::string& out) : out_(out) {}
+
+        void varint(std::uint64_t v) {
+            while (v >= 0x80) {
+                out_.push_back(static_cast<char>((v & 0x7F) | 0x80));
+                v >>= 7;
+            }
+            out_.push_back(static_cast<char>(v));
+        }
+        void signedVarint(std::int64_t v) {
+            varint((static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+        }
+        void bytes(std::string_view data) {
+            varint(data.size());
+            out_.append(data);
+        }
+        void raw(const void* data, std::size_t size) { out_.append(static_cast<const char*>(data), size); }
+
+    private:
+        std::string& out_;
+    };
+
+    class BinaryReader {
+    public:
+        explicit BinaryReader(std::string_view in) : p_(in.data()), end_(in.data() + in.size()) {}
+
+        bool varint(std::uint64_t& v) {
+            v = 0;
+            for (int shift = 0; shift < 64 && p_ != end_; shift += 7) {
+                const auto byte = static_cast<unsigned char>(*p_++);
+                v |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return true;
+            }
+            return false;
+        }
+        bool signedVarint(std::int64_t& v) {
+            std::uint64_t u = 0;
+            if (!varint(u)) return false;
+            v = static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1);
+            return true;
+        }
+        bool bytes(std::string_view& data) {
+            std::uint64_t size = 0;
+            if (!varint(size) || size > remaining()) return false;
+            data = std::string_view(p_, static_cast<std::size_t>(size));
+            p_ += size;
+            return true;
+        }
+        bool raw(void* data, std::size_t size) {
+            if (size > remaining()) return false;
+            std::memcpy(data, p_, size);
+            p_ += size;
+            return true;
+        }
+
+        std::size_t remaining() const { return static_cast<std::size_t>(end_ - p_); }
+        bool        atEnd() const { return p_ == end_; }
+
+    private:
+        const char* p_;
+        const char* end_;
+    };
+
+    template <typename T>
+    void writeBinary(BinaryWriter& w, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            w.varint(value ? 1 : 0);
+        }
+        else if constexpr (std::is_enum_v<T>) {
+            w.varint(static_cast<std::uint64_t>(value));
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            w.signedVarint(value);
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            w.varint(value);
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            const double d = value;
+            w.raw(&d, sizeof(d));
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            w.bytes(value);
+        }
+        else if constexpr (DescribedVariant<T>) {
+            w.varint(value.index());
+            std::visit([&](const auto& alt) { writeBinary(w, alt); }, value);
+        }
+        else if constexpr (Described<T>) {
+            std::uint64_t count = 0;
+            forEachField<T>([&](const auto& f) { count += f.presence != Presence::ReadOnly; });
+            w.varint(count);
+            forEachField<T>([&](const auto& f) {
+                if (f.presence != Presence::ReadOnly) writeBinary(w, value.*f.member);
+            });
+        }
+        else if constexpr (Sequence<T>) {
+            w.varint(value.size());
+            for (const auto& item : value) writeBinary(w, item);
+        }
+        else {
+            static_assert(always_false_v<T>, "type has no binary encoding");
+        }
+    }
+
+    template <typename T>
+    bool readBinary(BinaryReader& r, T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            std::uint64_t v = 0;
+            if (!r.varint(v) || v > 1) return false;
+            value = v != 0;
+            return true;
+        }
+        else if constexpr (std::is_enum_v<T>) {
+            std::uint64_t v = 0;
+            if (!r.varint(v)) return false;
+            value = static_cast<T>(v);
+            return true;
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            std::int64_t v = 0;
+            if (!r.signedVarint(v)) return false;
+            value = static_cast<T>(v);
+            return true;
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            std::uint64_t v = 0;
+            if (!r.varint(v)) return false;
+            value = static_cast<T>(v);
+            return true;
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            double d = 0;
+            if (!r.raw(&d, sizeof(d))) return false;
+            value = static_cast<T>(d);
+            return true;
+        }
+        else if constexpr (is_fixed_id_v<T>) {
+            std::string_view text;
+            return r.bytes(text) && T::parse(text, value);
+        }
+        else if constexpr (std::is_same_v<T, std::string>) {
+            std::string_view text;
+            if (!r.bytes(text)) return false;
+            value.assign(text);
+            return true;
+        }
+        else if constexpr (DescribedVariant<T>) {
+            std::uint64_t index = 0;
+            bool ok = false;
+            if (!r.varint(index)) return false;
+            return emplaceIndex(value, index, [&](auto& alt) { ok = readBinary(r, alt); }) && ok;
+        }
+        else if constexpr (Described<T>) {
+            std::uint64_t count = 0;
+            if (!r.varint(count)) return false;
+            std::uint64_t index = 0;
+            bool ok = true;
+            forEachField<T>([&](const auto& f) {
+                if (!ok || f.presence == Presence::ReadOnly || index >= count) return;
+                ++index;
+                ok = readBinary(r, value.*f.member);
+            });
+            if (!ok || index != count) return false; // unknown trailing fields
+            if constexpr (HasAfterRead<T>) Schema<T>::afterRead(value);
+            return true;
+        }
+        else if constexpr (Sequence<T>) {
+            std::uint64_t count = 0;
+            if (!r.varint(count) || count > r.remaining()) return false; // every item takes >= 1 byte
+            value.clear();
+            value.resize(static_cast<std::size_t>(count));
+            for (auto& item : value) {
+                if (!readBinary(r, item)) return false;
+            }
+            return true;
+        }
+        else {
+            static_assert(always_false_v<T>, "type has no binary encoding");
+        }
+    }
+
+    template <typename T>
+    std::string encodeBinary(const T& value) {
+        std::string out;
+        BinaryWriter w(out);
+        writeBinary(w, value);
+        return out;
+    }
+
+    template <typename T>
+    bool decodeBinary(std::string_view data, T& value) {
+        BinaryReader r(data);
+        return readBinary(r, value) && r.atEnd();
+    }
+
+}
@@ -1,10 +1,12 @@
 #pragma once
 #include <string>
 #include <cstdint>
+#include "Ids.h"
+#include "Schema.h"
 
 namespace hms {
     struct Hotel {
-        std::string id = "HTL-0001";
+        HotelId id = "HTL-0001";
         std::string name;
         std::uint8_t stars{3};
         std::string address;
@@ -13,4 +15,13 @@ namespace hms {
         // roomsCount = RoomsRepository.countActive()
         // restaurantsCount = RestaurantsRepository.countActive()
     };
+
+    // Persisted fields; see Schema.h.
+    template <> struct Schema<Hotel> {
+        static constexpr auto fields = std::make_tuple(
+            field("id",      &Hotel::id),
+            field("name",    &Hotel::name,    Presence::Optional),
+            field("stars",   &Hotel::stars,   Presence::Optional),
+            field("address", &Hotel::address, Presence::Optional));
+    };
 }
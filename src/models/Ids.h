@@ -0,0 +1,139 @@
+#pragma once
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <nlohmann/json.hpp>
+
+namespace hms {
+
+    template <typename Tag, std::size_t Capacity>
+    class FixedId;
+
+    template <typename T>
+    inline constexpr bool is_fixed_id_v = false;
+    template <typename Tag, std::size_t Capacity>
+    inline constexpr bool is_fixed_id_v<FixedId<Tag, Capacity>> = true;
+
+    // Identifier stored inline: up to `Capacity` characters, zero padded,
+    // plus a length byte. Trivially copyable, so rows holding only ids and
+    // numbers relocate with memcpy. Equality and hashing work on whole
+    // 8-byte words; ordering is a single memcmp and matches std::string
+    // ordering because ids never contain '\0'.
+    //
+    // Each key kind gets its own Tag so a HotelId cannot be passed where a
+    // UserId is expected. Strings convert implicitly; input longer than
+    // Capacity yields an empty id (parse() reports it instead).
+    template <typename Tag, std::size_t Capacity = 23>
+    class FixedId {
+        static_assert((Capacity + 1) % 8 == 0, "keep FixedId a whole number of words");
+        static_assert(Capacity < 256, "length is stored in one byte");
+
+    public:
+        static constexpr std::size_t kCapacity = Capacity;
+
+        constexpr FixedId() noexcept = default;
+
+        template <typename S>
+            requires(std::convertible_to<const S&, std::string_view> && !is_fixed_id_v<std::remove_cvref_t<S>>)
+        FixedId(const S& text) noexcept { assign(std::string_view(text)); }
+
+        static bool fits(std::string_view text) noexcept { return text.size() <= Capacity; }
+
+        // Strict conversion for untrusted input: false (and `out` untouched)
+        // when `text` does not fit.
+        static bool parse(std::string_view text, FixedId& out) noexcept {
+            if (!fits(text)) return false;
+            out.assign(text);
+            return true;
+        }
+
+        std::string_view view() const noexcept { return {bytes_, size()}; }
+        operator std::string_view() const noexcept { return view(); }
+        std::string str() const { return std::string(view()); }
+
+        const char* data() const noexcept  { return bytes_; }
+        std::size_t size() const noexcept  { return static_cast<unsigned char>(bytes_[Capacity]); }
+        bool        empty() const noexcept { return size() == 0; }
+
+        std::size_t hash() const noexcept {
+            std::uint64_t h = 0x9E3779B97F4A7C15ull;
+            for (std::size_t i = 0; i < kWords; ++i) {
+                h ^= word(i);
+                h *= 0xBF58476D1CE4E5B9ull;
+                h ^= h >> 31;
+            }
+            return static_cast<std::size_t>(h);
+        }
+
+        friend bool operator==(const FixedId& a, const FixedId& b) noexcept {
+            for (std::size_t i = 0; i < kWords; ++i) {
+                if (a.word(i) != b.word(i)) return false;
+            }
+            return true;
+        }
+
+        friend std::strong_ordering operator<=>(const FixedId& a, const FixedId& b) noexcept {
+            const int c = std::memcmp(a.bytes_, b.bytes_, Capacity);
+            return c == 0 ? std::strong_ordering::equal
+                 : c < 0  ? std::strong_ordering::less
+                          : std::strong_ordering::greater;
+        }
+
+        friend std::string operator+(const FixedId& a, std::string_view b) { return a.str().append(b); }
+        friend std::string operator+(std::string_view a, const FixedId& b) { return std::string(a).append(b.view()); }
+
+        friend std::ostream& operator<<(std::ostream& out, const FixedId& id) { return out << id.view(); }
+
+    private:
+        static constexpr std::size_t kWords = (Capacity + 1) / 8;
+
+        void assign(std::string_view text) noexcept {
+            std::memset(bytes_, 0, sizeof(bytes_));
+            if (!fits(text)) return;
+            std::memcpy(bytes_, text.data(), text.size());
+            bytes_[Capacity] = static_cast<char>(text.size());
+        }
+
+        std::uint64_t word(std::size_t i) const noexcept {
+            std::uint64_t w;
+            std::memcpy(&w, bytes_ + i * 8, sizeof(w));
+            return w;
+        }
+
+        char bytes_[Capacity + 1]{}; // characters, zero padding, length
+    };
+
+    using BookingId   = FixedId<struct BookingIdTag>;
+    using HotelId     = FixedId<struct HotelIdTag>;
+    using RoomId      = FixedId<struct RoomIdTag>;
+    using OrderLineId = FixedId<struct OrderLineIdTag>;
+    using UserId      = FixedId<struct UserIdTag>;
+
+    // JSON keeps plain strings; ids that do not fit fail the record.
+    template <typename BasicJsonType, typename Tag, std::size_t Capacity>
+    inline void to_json(BasicJsonType& j, const FixedId<Tag, Capacity>& id) {
+        j = id.str();
+    }
+
+    template <typename BasicJsonType, typename Tag, std::size_t Capacity>
+    inline void from_json(const BasicJsonType& j, FixedId<Tag, Capacity>& id) {
+        const auto& text = j.template get_ref<const typename BasicJsonType::string_t&>();
+        if (!FixedId<Tag, Capacity>::parse(std::string_view(text.data(), text.size()), id)) {
+            throw std::length_error("id longer than " + std::to_string(Capacity) + " characters");
+        }
+    }
+
+}
+
+template <typename Tag, std::size_t Capacity>
+struct std::hash<hms::FixedId<Tag, Capacity>> {
+    std::size_t operator()(const hms::FixedId<Tag, Capacity>& id) const noexcept { return id.hash(); }
+};
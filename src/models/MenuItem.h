@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <cstdint>
+#include "Schema.h"
 
 namespace hms {
     struct MenuItem {
@@ -8,7 +9,21 @@ namespace hms {
         std::string  restaurantId;
         std::string  name;         // "Masala Omelette"
         std::string  category;     // "Breakfast" | "Lunch" | "Dinner" | ...
-        std::int64_t price{};
+        std::int64_t price{};      // in cents
         bool         active{true};
     };
+
+    // Persisted fields; see Schema.h. Menu items are nested under their
+    // restaurant in the catalogue, so restaurantId is filled in by the loader
+    // when absent.
+    template <> struct Schema<MenuItem> {
+        static constexpr auto fields = std::make_tuple(
+            field("id",           &MenuItem::id),
+            field("restaurantId", &MenuItem::restaurantId, Presence::Optional),
+            field("name",         &MenuItem::name),
+            field("category",     &MenuItem::category),
+            field("priceCents",   &MenuItem::price),
+            field("active",       &MenuItem::active, Presence::Optional));
+    };
+
 }
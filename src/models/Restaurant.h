@@ -1,13 +1,29 @@
 #pragma once
 #include <string>
+#include "Schema.h"
+#include "Ids.h"
 
 namespace hms {
     struct Restaurant {
         std::string id;
-        std::string hotelId;
+        HotelId     hotelId;
         std::string name;
         std::string cuisine;
         std::string openHours;
         bool active{true};
     };
-}
\ No newline at end of file
+
+    // Persisted fields; see Schema.h. The catalogue describes the cuisine as
+    // "style"; older files used "cuisine", which is still read.
+    template <> struct Schema<Restaurant> {
+        static constexpr auto fields = std::make_tuple(
+            field("id",        &Restaurant::id),
+            field("hotelId",   &Restaurant::hotelId),
+            field("name",      &Restaurant::name),
+            field("cuisine",   &Restaurant::cuisine,   Presence::ReadOnly),
+            field("style",     &Restaurant::cuisine,   Presence::Optional),
+            field("openHours", &Restaurant::openHours, Presence::Optional),
+            field("active",    &Restaurant::active,    Presence::Optional));
+    };
+
+}
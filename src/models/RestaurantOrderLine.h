@@ -1,12 +1,13 @@
 #pragma once
 #include <string>
 #include <cstdint>
-#include <nlohmann/json.hpp>
+#include "Schema.h"
+#include "Ids.h"
 
 namespace hms {
 
 struct RestaurantOrderLine {
-    std::string  lineId;              // unique within booking, e.g. "ROL-0001"
+    OrderLineId  lineId;              // unique within booking, e.g. "ROL-0001"
     std::string  restaurantId;        // which restaurant fulfilled the order
     std::string  category;            // e.g. "Breakfast", "Dinner"
     std::string  menuItemId;          // MenuItem.id
@@ -15,39 +16,24 @@ struct RestaurantOrderLine {
     int          qty{1};
     int          billedRoomNumber{0}; // link to booked room; 0 if none
     std::string  takenByUsername;     // staff user who took order
-    std::string  orderedByGuestId;    // optional: guest who ordered
+    UserId       orderedByGuestId;    // optional: guest who ordered
     std::int64_t createdAt{0};        // epoch seconds
 };
 
-// JSON serialization helpers
-inline void to_json(nlohmann::json& j, const RestaurantOrderLine& rol) {
-    j = nlohmann::json{
-        {"lineId", rol.lineId},
-        {"restaurantId", rol.restaurantId},
-        {"category", rol.category},
-        {"menuItemId", rol.menuItemId},
-        {"nameSnapshot", rol.nameSnapshot},
-        {"unitPriceSnapshot", rol.unitPriceSnapshot},
-        {"qty", rol.qty},
-        {"billedRoomNumber", rol.billedRoomNumber},
-        {"takenByUsername", rol.takenByUsername},
-        {"orderedByGuestId", rol.orderedByGuestId},
-        {"createdAt", rol.createdAt}
-    };
-}
-
-inline void from_json(const nlohmann::json& j, RestaurantOrderLine& rol) {
-    j.at("lineId").get_to(rol.lineId);
-    j.at("restaurantId").get_to(rol.restaurantId);
-    j.at("category").get_to(rol.category);
-    j.at("menuItemId").get_to(rol.menuItemId);
-    j.at("nameSnapshot").get_to(rol.nameSnapshot);
-    j.at("unitPriceSnapshot").get_to(rol.unitPriceSnapshot);
-    j.at("qty").get_to(rol.qty);
-    j.at("billedRoomNumber").get_to(rol.billedRoomNumber);
-    j.at("takenByUsername").get_to(rol.takenByUsername);
-    j.at("orderedByGuestId").get_to(rol.orderedByGuestId);
-    j.at("createdAt").get_to(rol.createdAt);
-}
+// Persisted fields; see Schema.h.
+template <> struct Schema<RestaurantOrderLine> {
+    static constexpr auto fields = std::make_tuple(
+        field("lineId",            &RestaurantOrderLine::lineId),
+        field("restaurantId",      &RestaurantOrderLine::restaurantId),
+        field("category",          &RestaurantOrderLine::category),
+        field("menuItemId",        &RestaurantOrderLine::menuItemId),
+        field("nameSnapshot",      &RestaurantOrderLine::nameSnapshot),
+        field("unitPriceSnapshot", &RestaurantOrderLine::unitPriceSnapshot),
+        field("qty",               &RestaurantOrderLine::qty),
+        field("billedRoomNumber",  &RestaurantOrderLine::billedRoomNumber),
+        field("takenByUsername",   &RestaurantOrderLine::takenByUsername),
+        field("orderedByGuestId",  &RestaurantOrderLine::orderedByGuestId),
+        field("createdAt",         &RestaurantOrderLine::createdAt));
+};
 
 }
@@ -1,5 +1,7 @@
 #pragma once
-#include <nlohmann/json.hpp>
+#include <string_view>
+#include <utility>
+#include "Schema.h"
 
 namespace hms {
 
@@ -9,11 +11,19 @@ enum class Role {
     ADMIN
 };
 
-// JSON serialization mapping
-NLOHMANN_JSON_SERIALIZE_ENUM(Role, {
+// JSON names (unknown values fall back to GUEST); see EnumWithNames in Schema.h.
+inline constexpr std::pair<Role, std::string_view> kRoleNames[] = {
     {Role::GUEST, "GUEST"},
     {Role::MANAGER, "MANAGER"},
     {Role::ADMIN, "ADMIN"}
-})
+};
+
+constexpr const auto& enumNames(Role) { return kRoleNames; }
+
+template <typename BasicJsonType>
+void to_json(BasicJsonType& j, const Role& value) { enumToJson(j, value); }
+
+template <typename BasicJsonType>
+void from_json(const BasicJsonType& j, Role& value) { enumFromJson(j, value); }
 
-}
\ No newline at end of file
+}
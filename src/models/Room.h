@@ -1,13 +1,14 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <nlohmann/json.hpp>
+#include "Schema.h"
+#include "Ids.h"
 
 namespace hms {
 
 struct Room {
-    std::string   id;                 // e.g. "RM-000123" (stable key)
-    std::string   hotelId{"HTL-0001"}; // associate room with a hotel
+    RoomId        id;                 // e.g. "HTL-0001-101" (stable key)
+    HotelId       hotelId{"HTL-0001"}; // associate room with a hotel
     int           number{0};          // human-facing room number
     std::string   typeId;             // foreign key -> RoomType.id
     int           sizeSqm{0};
@@ -17,42 +18,29 @@ struct Room {
     bool          active{true};
 };
 
-// JSON (de)serialization
-inline void to_json(nlohmann::json& j, const Room& r) {
-    j = nlohmann::json{
-        {"id", r.id},
-        {"hotelId", r.hotelId},
-        {"number", r.number},
-        {"typeId", r.typeId},
-        {"sizeSqm", r.sizeSqm},
-        {"beds", r.beds},
-        {"amenities", r.amenities},
-        {"notes", r.notes},
-        {"active", r.active}
-    };
-}
-inline void from_json(const nlohmann::json& j, Room& r) {
-    j.at("hotelId").get_to(r.hotelId);
-    if (j.contains("id"))      j.at("id").get_to(r.id);
-    if (j.contains("number"))  j.at("number").get_to(r.number);
-    if (j.contains("typeId"))  j.at("typeId").get_to(r.typeId);
-
-    if (j.contains("sizeSqm"))   j.at("sizeSqm").get_to(r.sizeSqm);
-    if (j.contains("beds"))      j.at("beds").get_to(r.beds);
-    if (j.contains("amenities")) j.at("amenities").get_to(r.amenities);
-    if (j.contains("notes"))     j.at("notes").get_to(r.notes);
-    if (j.contains("active"))    j.at("active").get_to(r.active);
+// Persisted fields; see Schema.h.
+template <> struct Schema<Room> {
+    static constexpr auto fields = std::make_tuple(
+        field("id",        &Room::id,        Presence::Optional),
+        field("hotelId",   &Room::hotelId),
+        field("number",    &Room::number,    Presence::Optional),
+        field("typeId",    &Room::typeId,    Presence::Optional),
+        field("sizeSqm",   &Room::sizeSqm,   Presence::Optional),
+        field("beds",      &Room::beds,      Presence::Optional),
+        field("amenities", &Room::amenities, Presence::Optional),
+        field("notes",     &Room::notes,     Presence::Optional),
+        field("active",    &Room::active,    Presence::Optional));
 
-    if (r.id.empty()) {
+    static void afterRead(Room& r) {
+        if (!r.id.empty()) return;
         // Legacy data might omit a stable ID; derive one from hotelId + room number.
-        const int number = r.number;
-        if (!r.hotelId.empty() && number > 0) {
-            r.id = r.hotelId + "-" + std::to_string(number);
+        if (!r.hotelId.empty() && r.number > 0) {
+            r.id = r.hotelId + "-" + std::to_string(r.number);
         }
         else {
-            r.id = "ROOM-" + std::to_string(number);
+            r.id = "ROOM-" + std::to_string(r.number);
         }
     }
-}
+};
 
 }
@@ -0,0 +1,212 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <nlohmann/json.hpp>
+
+namespace hms {
+
+    // How a field takes part in (de)serialization.
+    enum class Presence {
+        Required, // must be present when reading
+        Optional, // keeps the member's default when absent
+        ReadOnly  // accepted when reading (legacy names), never written
+    };
+
+    template <typename T, typename M>
+    struct Field {
+        using owner_type  = T;
+        using member_type = M;
+
+        std::string_view name;
+        M T::*           member;
+        Presence         presence;
+    };
+
+    template <typename T, typename M>
+    constexpr Field<T, M> field(std::string_view name, M T::*member, Presence presence = Presence::Required) {
+        return {name, member, presence};
+    }
+
+    // Each persisted model specializes Schema<T> once, next to its struct:
+    //
+    //     template <> struct Schema<Hotel> {
+    //         static constexpr auto fields = std::make_tuple(
+    //             field("id", &Hotel::id), field("name", &Hotel::name), ...);
+    //     };
+    //
+    // Fields are written in declaration order. An optional
+    // `static void afterRead(T&)` runs after every decode (legacy fix-ups).
+    // From that single list come the nlohmann to_json/from_json below, the
+    // DOM-free JsonWriter and the binary codec in Codec.h.
+    template <typename T>
+    struct Schema;
+
+    template <typename T>
+    concept Described = requires { Schema<T>::fields; };
+
+    template <typename T>
+    concept HasAfterRead = Described<T> && requires(T& value) { Schema<T>::afterRead(value); };
+
+    // Tagged unions of described structs. Current files store them flat,
+    // {"t": <alternative index>, <alternative's fields>...}; the legacy
+    // layout {"kind": <name>, "value": {...}} is still read (and written on
+    // request, see VariantLayout). Each variant lists the kind name of every
+    // alternative, in index order; indexes are part of the format, so only
+    // append alternatives.
+    template <typename V>
+    struct VariantKinds;
+
+    template <typename V>
+    concept DescribedVariant = requires { VariantKinds<V>::names; };
+
+    enum class VariantLayout { Flat, Nested };
+
+    inline constexpr std::string_view kVariantTagKey = "t";
+
+    // Enums are stored by name. An enum opts in by providing, next to its
+    // declaration, `constexpr const auto& enumNames(E)` returning an array
+    // of {value, name} pairs; unknown names decode to the first entry.
+    template <typename E>
+    concept EnumWithNames = std::is_enum_v<E> && requires(E e) { enumNames(e); };
+
+    template <EnumWithNames E>
+    std::string_view enumName(E value) {
+        const auto& names = enumNames(value);
+        for (const auto& [v, text] : names) {
+            if (v == value) return text;
+        }
+        return names[0].second;
+    }
+
+    template <EnumWithNames E>
+    E enumFromName(std::string_view name) {
+        const auto& names = enumNames(E{});
+        for (const auto& [v, text] : names) {
+            if (text == name) return v;
+        }
+        return names[0].first;
+    }
+
+    template <typename T, typename F>
+    constexpr void forEachField(F&& f) {
+        std::apply([&](const auto&... fields) { (f(fields), ...); }, Schema<T>::fields);
+    }
+
+    template <typename T>
+    constexpr bool declaresField(std::string_view name) {
+        return std::apply([&](const auto&... fields) { return (... || (fields.name == name)); }, Schema<T>::fields);
+    }
+
+    template <typename V>
+    std::string_view kindName(const V& value) {
+        return VariantKinds<V>::names[value.index()];
+    }
+
+    // Sets `value` to the alternative named `kind` and hands it to `f`;
+    // false when the name is unknown.
+    template <typename V, typename F, std::size_t I = 0>
+    bool emplaceKind(V& value, std::string_view kind, F&& f) {
+        if constexpr (I == std::variant_size_v<V>) {
+            return false;
+        }
+        else {
+            if (VariantKinds<V>::names[I] == kind) {
+                f(value.template emplace<I>());
+                return true;
+            }
+            return emplaceKind<V, F, I + 1>(value, kind, std::forward<F>(f));
+        }
+    }
+
+    template <typename V, typename F, std::size_t I = 0>
+    bool emplaceIndex(V& value, std::size_t index, F&& f) {
+        if constexpr (I == std::variant_size_v<V>) {
+            return false;
+        }
+        else {
+            if (index == I) {
+                f(value.template emplace<I>());
+                return true;
+            }
+            return emplaceIndex<V, F, I + 1>(value, index, std::forward<F>(f));
+        }
+    }
+
+    // ---- nlohmann::json (and ArenaJson) adapters ----
+
+    // Enums forward to these from per-enum to_json/from_json overloads: a
+    // generic constrained overload would be ambiguous with nlohmann's own
+    // (numeric) enum conversion.
+    template <typename BasicJsonType, EnumWithNames E>
+    void enumToJson(BasicJsonType& j, E value) {
+        j = std::string(enumName(value));
+    }
+
+    template <typename BasicJsonType, EnumWithNames E>
+    void enumFromJson(const BasicJsonType& j, E& value) {
+        if (!j.is_string()) { value = enumNames(E{})[0].first; return; }
+        const auto& name = j.template get_ref<const typename BasicJsonType::string_t&>();
+        value = enumFromName<E>(std::string_view(name.data(), name.size()));
+    }
+
+    template <typename BasicJsonType, Described T>
+    void to_json(BasicJsonType& j, const T& value) {
+        j = BasicJsonType::object();
+        forEachField<T>([&](const auto& f) {
+            if (f.presence == Presence::ReadOnly) return;
+            j[typename BasicJsonType::string_t(f.name)] = value.*f.member;
+        });
+    }
+
+    template <typename BasicJsonType, Described T>
+    void from_json(const BasicJsonType& j, T& value) {
+        if (!j.is_object()) throw std::invalid_argument("expected an object");
+        forEachField<T>([&](const auto& f) {
+            const auto it = j.find(f.name);
+            if (it == j.end()) {
+                if (f.presence == Presence::Required) {
+                    throw std::out_of_range("missing field '" + std::string(f.name) + "'");
+                }
+                return;
+            }
+            it->get_to(value.*f.member);
+        });
+        if constexpr (HasAfterRead<T>) Schema<T>::afterRead(value);
+    }
+
+    template <typename BasicJsonType, typename... Ts>
+        requires DescribedVariant<std::variant<Ts...>>
+    void to_json(BasicJsonType& j, const std::variant<Ts...>& value) {
+        static_assert((... && !declaresField<Ts>(kVariantTagKey)), "field name clashes with the variant tag");
+        std::visit([&](const auto& alt) { to_json(j, alt); }, value);
+        j[typename BasicJsonType::string_t(kVariantTagKey)] = value.index();
+    }
+
+    template <typename BasicJsonType, typename... Ts>
+        requires DescribedVariant<std::variant<Ts...>>
+    void from_json(const BasicJsonType& j, std::variant<Ts...>& value) {
+        if (!j.is_object()) throw std::invalid_argument("expected an object");
+        const auto tag = j.find(kVariantTagKey);
+        if (tag != j.end()) {
+            const auto index = tag->is_number_unsigned() ? tag->template get<std::size_t>() : sizeof...(Ts);
+            if (!emplaceIndex(value, index, [&](auto& alt) { from_json(j, alt); })) {
+                throw std::runtime_error("Unknown kind index: " + std::to_string(index));
+            }
+            return;
+        }
+        const auto& kind = j.at("kind").template get_ref<const typename BasicJsonType::string_t&>();
+        const auto& body = j.at("value");
+        const std::string_view name(kind.data(), kind.size());
+        if (!emplaceKind(value, name, [&](auto& alt) { body.get_to(alt); })) {
+            throw std::runtime_error("Unknown kind: " + std::string(name));
+        }
+    }
+
+}
@@ -1,12 +1,13 @@
 #pragma once
 #include <string>
-#include <nlohmann/json.hpp>
+#include "Schema.h"
+#include "Ids.h"
 #include "Role.h"
 
 namespace hms {
 
 struct User {
-    std::string userId;       // stable key, e.g., "USR-0001"
+    UserId      userId;       // stable key, e.g., "USR-0001"
     std::string firstName;
     std::string lastName;
     std::string address;
@@ -24,36 +25,21 @@ struct User {
     bool        active{true};
 };
 
-// ---- JSON helpers ----
-// We DO NOT serialize the raw 'password'. We persist 'passwordHash' instead.
-inline void to_json(nlohmann::json& j, const User& u) {
-    j = nlohmann::json{
-        {"userId", u.userId},
-        {"firstName", u.firstName},
-        {"lastName", u.lastName},
-        {"address", u.address},
-        {"phone", u.phone},
-        {"login", u.login},
-        {"passwordHash", u.passwordHash},
-        {"role", u.role},
-        {"active", u.active}
-    };
-}
-
-inline void from_json(const nlohmann::json& j, User& u) {
-    j.at("userId").get_to(u.userId);
-    j.at("firstName").get_to(u.firstName);
-    j.at("lastName").get_to(u.lastName);
-    if (j.contains("address")) j.at("address").get_to(u.address);
-    if (j.contains("phone"))   j.at("phone").get_to(u.phone);
-    if (j.contains("login"))   j.at("login").get_to(u.login);
-
-    // backward-compat: accept either passwordHash or legacy plain "password"
-    if (j.contains("passwordHash")) j.at("passwordHash").get_to(u.passwordHash);
-    else if (j.contains("password")) j.at("password").get_to(u.password);
-
-    if (j.contains("role"))   j.at("role").get_to(u.role);
-    if (j.contains("active")) j.at("active").get_to(u.active);
-}
+// Persisted fields; see Schema.h.
+// We DO NOT serialize the raw 'password'. We persist 'passwordHash' instead,
+// but still accept a legacy plain "password" on read.
+template <> struct Schema<User> {
+    static constexpr auto fields = std::make_tuple(
+        field("userId",       &User::userId),
+        field("firstName",    &User::firstName,    Presence::Optional),
+        field("lastName",     &User::lastName,     Presence::Optional),
+        field("address",      &User::address,      Presence::Optional),
+        field("phone",        &User::phone,        Presence::Optional),
+        field("login",        &User::login,        Presence::Optional),
+        field("passwordHash", &User::passwordHash, Presence::Optional),
+        field("password",     &User::password,     Presence::ReadOnly),
+        field("role",         &User::role,         Presence::Optional),
+        field("active",       &User::active,       Presence::Optional));
+};
 
 }
@@ -0,0 +1,283 @@
+#include "PricingEngine.h"
+
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <system_error>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path baseDataDir() {
+#ifdef HMS_DATA_DIR
+    return fs::path{HMS_DATA_DIR};
+#else
+    return (fs::current_path() / "data").lexically_normal();
+#endif
+}
+
+bool ensureParentDir(const fs::path& p) {
+    try {
+        auto dir = p.parent_path();
+        if (!dir.empty() && !fs::exists(dir)) {
+            return fs::create_directories(dir);
+        }
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+template <typename T>
+void readOptional(const json& j, const char* key, T& out) {
+    if (j.contains(key)) j.at(key).get_to(out);
+}
+
+}
+
+namespace hms {
+
+PricingEngine::path_t PricingEngine::defaultPath() {
+    return (baseDataDir() / "pricing.json").lexically_normal();
+}
+
+PricingEngine::PricingEngine(path_t path)
+        : path_(std::move(path)) {
+    resetToDefaults();
+}
+
+// The tariff the guest dashboard used to hard-code; also what a fresh data
+// directory starts with.
+void PricingEngine::resetToDefaults() {
+    rules_ = PricingRules{};
+    types_ = {
+        {"STANDARD", "Standard", 11000, true},
+        {"DELUXE",   "Deluxe",   15000, true},
+        {"LUXURY",   "Luxury",   15000, true},
+        {"SUITE",    "Suite",    22000, true},
+    };
+    surcharges_ = {
+        {"Sea View", 1800},
+        {"Balcony",  1800},
+        {"Jacuzzi",  1200},
+        {"Mini Bar", 1200},
+    };
+    reindex();
+}
+
+void PricingEngine::reindex() {
+    typeById_.clear();
+    std::vector<RoomType> unique;
+    unique.reserve(types_.size());
+    for (auto& t : types_) {
+        auto [it, inserted] = typeById_.try_emplace(t.id, unique.size());
+        if (!inserted) {
+            unique[it->second] = std::move(t); // last definition wins
+            continue;
+        }
+        unique.push_back(std::move(t));
+    }
+    types_ = std::move(unique);
+    quotes_.clear();
+}
+
+bool PricingEngine::load() {
+    const std::unique_lock lock(mutex_);
+    resetToDefaults();
+    if (!ensureParentDir(path_)) return false;
+
+    if (!fs::exists(path_)) return writeFile();
+
+    std::ifstream in(path_);
+    if (!in.good()) return false;
+
+    json doc;
+    try { in >> doc; }
+    catch (...) { return false; }
+
+    if (doc.is_null()) return true;
+    if (!doc.is_object()) return false;
+
+    try {
+        PricingRules rules;
+        doc.get_to(rules);
+
+        std::vector<RoomType> types;
+        readOptional(doc, "roomTypes", types);
+
+        std::unordered_map<std::string, std::int64_t> surcharges;
+        readOptional(doc, "amenitySurchargesCents", surcharges);
+
+        rules_ = rules;
+        types_ = std::move(types);
+        surcharges_ = std::move(surcharges);
+    }
+    catch (...) {
+        resetToDefaults();
+        return false;
+    }
+    reindex();
+    return true;
+}
+
+bool PricingEngine::saveAll() const {
+    const std::lock_guard saving(saveMutex_);
+    const std::shared_lock lock(mutex_);
+    return writeFile();
+}
+
+bool PricingEngine::writeFile() const {
+    if (!ensureParentDir(path_)) return false;
+
+    const fs::path tmp = path_.string() + ".tmp";
+    json doc = rules_;
+    doc["roomTypes"]               = types_;
+    // Sorted so the file diffs cleanly between saves.
+    doc["amenitySurchargesCents"]  = std::map<std::string, std::int64_t>(surcharges_.begin(),
+                                                                         surcharges_.end());
+
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out.good()) return false;
+        out << doc.dump(2) << '\n';
+        out.flush();
+        if (!out.good()) return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, path_, ec);
+    if (ec) {
+        fs::remove(tmp);
+        return false;
+    }
+    return true;
+}
+
+std::int64_t PricingEngine::rateFor(const Room& room) const {
+    const std::shared_lock lock(mutex_);
+    return computeRate(room);
+}
+
+std::int64_t PricingEngine::computeRate(const Room& room) const {
+    std::int64_t rate = rules_.defaultNightlyRateCents;
+    if (auto it = typeById_.find(room.typeId); it != typeById_.end() && types_[it->second].active) {
+        rate = types_[it->second].nightlyRateCents;
+    }
+
+    rate += static_cast<std::int64_t>(std::max(room.beds - 1, 0)) * rules_.extraBedCents;
+    rate += static_cast<std::int64_t>(std::max(room.sizeSqm, 0)) * rules_.perSqmCents;
+
+    for (const auto& amenity : room.amenities) {
+        rate += surchargeFor(amenity);
+    }
+
+    return std::max(rate, rules_.minimumNightlyRateCents);
+}
+
+std::int64_t PricingEngine::quote(const Room& room) {
+    {
+        const std::shared_lock lock(mutex_);
+        if (auto it = quotes_.find(room.id); it != quotes_.end()) return it->second;
+    }
+    const std::unique_lock lock(mutex_);
+    const auto rate = computeRate(room);
+    if (!room.id.empty()) quotes_.emplace(room.id, rate);
+    return rate;
+}
+
+void PricingEngine::precompute(const std::vector<Room>& rooms) {
+    const std::unique_lock lock(mutex_);
+    quotes_.reserve(quotes_.size() + rooms.size());
+    for (const auto& room : rooms) {
+        if (!room.id.empty()) quotes_.insert_or_assign(room.id, computeRate(room));
+    }
+}
+
+void PricingEngine::invalidateRoom(const RoomId& roomId) {
+    const std::unique_lock lock(mutex_);
+    quotes_.erase(roomId);
+}
+
+void PricingEngine::invalidateAll() {
+    const std::unique_lock lock(mutex_);
+    quotes_.clear();
+}
+
+std::size_t PricingEngine::cachedCount() const {
+    const std::shared_lock lock(mutex_);
+    return quotes_.size();
+}
+
+PricingRules PricingEngine::rules() const {
+    const std::shared_lock lock(mutex_);
+    return rules_;
+}
+
+std::optional<RoomType> PricingEngine::getType(const std::string& typeId) const {
+    const std::shared_lock lock(mutex_);
+    auto it = typeById_.find(typeId);
+    if (it == typeById_.end()) return std::nullopt;
+    return types_[it->second];
+}
+
+std::vector<RoomType> PricingEngine::listTypes() const {
+    const std::shared_lock lock(mutex_);
+    return types_;
+}
+
+bool PricingEngine::upsertType(const RoomType& type) {
+    if (type.id.empty() || type.nightlyRateCents < 0) return false;
+    const std::unique_lock lock(mutex_);
+    if (auto it = typeById_.find(type.id); it != typeById_.end()) {
+        types_[it->second] = type;
+    }
+    else {
+        typeById_.emplace(type.id, types_.size());
+        types_.push_back(type);
+    }
+    quotes_.clear();
+    return true;
+}
+
+bool PricingEngine::removeType(const std::string& typeId) {
+    const std::unique_lock lock(mutex_);
+    auto it = typeById_.find(typeId);
+    if (it == typeById_.end()) return false;
+    types_.erase(types_.begin() + static_cast<std::ptrdiff_t>(it->second));
+    reindex();
+    return true;
+}
+
+std::int64_t PricingEngine::amenitySurcharge(const std::string& amenity) const {
+    const std::shared_lock lock(mutex_);
+    return surchargeFor(amenity);
+}
+
+std::int64_t PricingEngine::surchargeFor(const std::string& amenity) const {
+    auto it = surcharges_.find(amenity);
+    return it == surcharges_.end() ? 0 : it->second;
+}
+
+void PricingEngine::setAmenitySurcharge(const std::string& amenity, std::int64_t cents) {
+    const std::unique_lock lock(mutex_);
+    if (cents == 0) surcharges_.erase(amenity);
+    else            surcharges_.insert_or_assign(amenity, cents);
+    quotes_.clear();
+}
+
+void PricingEngine::setRules(const PricingRules& rules) {
+    const std::unique_lock lock(mutex_);
+    rules_ = rules;
+    quotes_.clear();
+}
+
+}
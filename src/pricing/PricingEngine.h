@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <optional>
+#include <filesystem>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include "../models/Room.h"
+#include "../models/RoomType.h"
+
+namespace hms {
+
+    // Tariff inputs that do not depend on the room type.
+    struct PricingRules {
+        std::int64_t defaultNightlyRateCents{9000}; // unknown or inactive room type
+        std::int64_t minimumNightlyRateCents{5000};
+        std::int64_t extraBedCents{2000};           // per bed beyond the first
+        std::int64_t perSqmCents{70};
+    };
+
+    // Stored at the top level of pricing.json; every rule is optional.
+    template <> struct Schema<PricingRules> {
+        static constexpr auto fields = std::make_tuple(
+            field("defaultNightlyRateCents", &PricingRules::defaultNightlyRateCents, Presence::Optional),
+            field("minimumNightlyRateCents", &PricingRules::minimumNightlyRateCents, Presence::Optional),
+            field("extraBedCents",           &PricingRules::extraBedCents,           Presence::Optional),
+            field("perSqmCents",             &PricingRules::perSqmCents,             Presence::Optional));
+    };
+
+    // Nightly room rates driven by pricing.json (room types, amenity surcharges
+    // and the rules above). Quotes are cached per room id, so listing or booking
+    // rooms repeatedly costs one hash lookup per room. Callers that change a
+    // room must invalidate it; changing a room type drops the whole cache.
+    // Safe to share between threads: every member takes an internal lock.
+    class PricingEngine {
+    public:
+        using path_t = std::filesystem::path;
+
+        explicit PricingEngine(path_t path = defaultPath());
+
+        // Disk I/O
+        bool load();          // read JSON -> memory (writes the built-in tariff if missing)
+        bool saveAll() const; // memory -> JSON (atomic via temp+rename)
+
+        // Quotes
+        std::int64_t rateFor(const Room& room) const;  // computed, never cached
+        std::int64_t quote(const Room& room);          // cached by room.id
+        void         precompute(const std::vector<Room>& rooms);
+        void         invalidateRoom(const RoomId& roomId);
+        void         invalidateAll();
+        std::size_t  cachedCount() const;
+
+        // Room types (each edit invalidates every cached quote)
+        std::optional<RoomType> getType(const std::string& typeId) const;
+        std::vector<RoomType>   listTypes() const;
+        bool upsertType(const RoomType& type);
+        bool removeType(const std::string& typeId);
+
+        // Amenity surcharges (each edit invalidates every cached quote)
+        std::int64_t amenitySurcharge(const std::string& amenity) const;
+        void         setAmenitySurcharge(const std::string& amenity, std::int64_t cents);
+
+        PricingRules rules() const;
+        void setRules(const PricingRules& rules);
+
+        // Paths
+        static path_t defaultPath();                 //../src/data/pricing.json (normalized)
+        const path_t& resolvedPath() const { return path_; }
+
+    private:
+        void resetToDefaults();
+        void reindex();
+        bool writeFile() const;
+        std::int64_t computeRate(const Room& room) const;
+        std::int64_t surchargeFor(const std::string& amenity) const;
+
+    private:
+        mutable std::shared_mutex mutex_;
+        mutable std::mutex        saveMutex_; // one saveAll (and temp file) at a time
+        path_t path_;
+        PricingRules rules_;
+        std::vector<RoomType> types_;                                  // file order
+
+        std::unordered_map<std::string, std::size_t>  typeById_;       // typeId -> position in types_
+        std::unordered_map<std::string, std::int64_t> surcharges_;     // amenity -> cents
+        std::unordered_map<RoomId, std::int64_t>      quotes_;         // roomId -> nightly rate
+    };
+
+}
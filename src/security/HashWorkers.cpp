@@ -0,0 +1,90 @@
+#include "HashWorkers.h"
+#include "../diagnostics/Metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace hms {
+
+namespace {
+
+thread_local WorkWaiter* tWaiter = nullptr;
+
+}
+
+WorkWaiter* exchangeWorkWaiter(WorkWaiter* waiter) {
+    WorkWaiter* previous = tWaiter;
+    tWaiter = waiter;
+    return previous;
+}
+
+HashWorkers& HashWorkers::instance() {
+    static HashWorkers workers(std::clamp(std::thread::hardware_concurrency(), 1u, 4u));
+    return workers;
+}
+
+HashWorkers::HashWorkers(unsigned threads) {
+    threads_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        threads_.emplace_back([this](std::stop_token stop) { work(stop); });
+    }
+}
+
+HashWorkers::~HashWorkers() {
+    for (auto& thread : threads_) thread.request_stop(); // wakes the wait in work()
+    threads_.clear();                                    // joins
+}
+
+void HashWorkers::run(const std::function<void()>& job) {
+    WorkWaiter* waiter = tWaiter;
+    if (waiter == nullptr) {
+        job();
+        return;
+    }
+
+    // Shared with the worker, which may still be signalling when the
+    // waiter has already seen `done` and returned.
+    struct State {
+        std::atomic<bool>     done{false};
+        std::exception_ptr    error;
+        std::function<void()> notify;
+    };
+    auto state = std::make_shared<State>();
+    state->notify = waiter->notifier();
+    {
+        const std::lock_guard lock(mutex_);
+        queue_.emplace_back([state, &job] {
+            try {
+                job();
+            }
+            catch (...) {
+                state->error = std::current_exception();
+            }
+            auto notify = std::move(state->notify);
+            state->done.store(true, std::memory_order_release);
+            notify();
+        });
+    }
+    ready_.notify_one();
+    HMS_COUNTER_ADD("security.hashJobsQueued", 1);
+
+    while (!state->done.load(std::memory_order_acquire)) waiter->suspend();
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+void HashWorkers::work(std::stop_token stop) {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(mutex_);
+            if (!ready_.wait(lock, stop, [this] { return !queue_.empty(); })) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        job();
+    }
+}
+
+}
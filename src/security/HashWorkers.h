@@ -0,0 +1,57 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hms {
+
+    // How a thread waits for work it handed to HashWorkers. The session
+    // server installs one on each event-loop thread that parks the calling
+    // session's fiber, so other sessions on that loop keep running while a
+    // password is hashed.
+    class WorkWaiter {
+    public:
+        virtual ~WorkWaiter() = default;
+
+        // On the waiting thread, before the work is queued: what the worker
+        // calls (on its own thread) once the work is done.
+        virtual std::function<void()> notifier() = 0;
+        // On the waiting thread, until the work is done. May return early.
+        virtual void suspend() = 0;
+    };
+
+    // Installs `waiter` for the calling thread (nullptr: none) and returns
+    // the previous one.
+    WorkWaiter* exchangeWorkWaiter(WorkWaiter* waiter);
+
+    // A few threads for CPU-heavy password hashing. Without a WorkWaiter on
+    // the calling thread (the console app, tools, tests) run() simply runs
+    // the job inline: blocking the one thread there is all waiting could
+    // do anyway.
+    class HashWorkers {
+    public:
+        // Shared pool; up to four threads, fewer on smaller machines.
+        static HashWorkers& instance();
+
+        explicit HashWorkers(unsigned threads);
+        ~HashWorkers();
+        HashWorkers(const HashWorkers&) = delete;
+        HashWorkers& operator=(const HashWorkers&) = delete;
+
+        // Runs `job` and returns once it has finished. Exceptions from the
+        // job are rethrown here.
+        void run(const std::function<void()>& job);
+
+    private:
+        void work(std::stop_token stop);
+
+        std::mutex                        mutex_;
+        std::condition_variable_any       ready_;
+        std::deque<std::function<void()>> queue_;
+        std::vector<std::jthread>         threads_; // last: started once the rest is set up
+    };
+
+}
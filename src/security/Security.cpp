@@ -1,11 +1,55 @@
 #include "Security.h"
+#include "HashWorkers.h"
+#include "Sha256.h"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <cstdint>
-#include <iomanip>
-#include <sstream>
+#include <cstring>
+#include <random>
 
 namespace {
-    std::string fnv1a64(const std::string& input) {
+    constexpr std::string_view kScheme      = "pbkdf2-sha256";
+    constexpr std::size_t      kSaltBytes   = 16;
+    constexpr std::size_t      kKeyBytes    = 32;
+    constexpr std::size_t      kLegacyBytes = 8;
+
+    std::atomic<std::uint32_t> gIterations{hms::kDefaultPasswordIterations};
+
+    std::string toHex(std::string_view bytes) {
+        static constexpr char kHex[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(bytes.size() * 2);
+        for (const unsigned char c : bytes) {
+            out.push_back(kHex[c >> 4]);
+            out.push_back(kHex[c & 0xF]);
+        }
+        return out;
+    }
+
+    bool fromHex(std::string_view hex, std::string& bytes) {
+        if (hex.size() % 2 != 0) return false;
+        bytes.resize(hex.size() / 2);
+        for (std::size_t i = 0; i < bytes.size(); ++i) {
+            unsigned value = 0;
+            const auto [end, ec] = std::from_chars(hex.data() + 2 * i, hex.data() + 2 * i + 2, value, 16);
+            if (ec != std::errc{} || end != hex.data() + 2 * i + 2) return false;
+            bytes[i] = static_cast<char>(value);
+        }
+        return true;
+    }
+
+    // No early exit: the time depends on the length only.
+    bool equalConstantTime(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        unsigned char diff = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+        return diff == 0;
+    }
+
+    // The hash format before PBKDF2, as raw bytes.
+    std::string legacyFnv1a64(std::string_view input) {
         constexpr std::uint64_t offset = 1469598103934665603ULL;
         constexpr std::uint64_t prime  = 1099511628211ULL;
 
@@ -14,21 +58,97 @@ namespace {
             hash ^= static_cast<std::uint64_t>(c);
             hash *= prime;
         }
+        std::string out(kLegacyBytes, '\0');
+        for (std::size_t i = 0; i < kLegacyBytes; ++i) out[i] = static_cast<char>(hash >> (56 - 8 * i));
+        return out;
+    }
+
+    struct Parsed {
+        std::uint32_t iterations{0};
+        std::string   salt;
+        std::string   key;
+    };
+
+    // "pbkdf2-sha256$<iterations>$<salt hex>$<key hex>"
+    bool parse(std::string_view text, Parsed& out) {
+        if (text.substr(0, kScheme.size()) != kScheme || text.size() <= kScheme.size() ||
+            text[kScheme.size()] != '$') return false;
+        text.remove_prefix(kScheme.size() + 1);
+        const auto cost = text.find('$');
+        const auto salt = cost == std::string_view::npos ? cost : text.find('$', cost + 1);
+        if (salt == std::string_view::npos) return false;
+        const auto [end, ec] = std::from_chars(text.data(), text.data() + cost, out.iterations);
+        return ec == std::errc{} && end == text.data() + cost && out.iterations > 0 &&
+               fromHex(text.substr(cost + 1, salt - cost - 1), out.salt) &&
+               fromHex(text.substr(salt + 1), out.key) && !out.key.empty();
+    }
 
-        std::ostringstream oss;
-        oss << std::hex << std::setw(16) << std::setfill('0') << hash;
-        return oss.str();
+    // Derived on a hash worker: many logins at once use several cores and
+    // do not hold up the sessions sharing an event loop.
+    std::string derive(std::string_view password, std::string_view salt, std::uint32_t iterations,
+                       std::size_t keyBytes) {
+        std::string key;
+        hms::HashWorkers::instance().run([&] {
+            key = hms::Pbkdf2HmacSha256(password, salt, iterations, keyBytes);
+        });
+        return key;
     }
 }
 
 namespace hms {
 
-std::string HashPasswordDemo(const std::string& password) {
-    return fnv1a64(password);
+void SetPasswordIterations(std::uint32_t iterations) {
+    gIterations = iterations == 0 ? 1 : iterations;
+}
+
+std::uint32_t PasswordIterations() {
+    return gIterations;
+}
+
+std::string Pbkdf2HmacSha256(std::string_view password, std::string_view salt, std::uint32_t iterations,
+                             std::size_t keyBytes) {
+    const HmacSha256 prf(password);
+    std::string out;
+    out.reserve(keyBytes);
+    std::string first(salt);
+    for (std::uint32_t block = 1; out.size() < keyBytes; ++block) {
+        first.resize(salt.size());
+        for (int shift = 24; shift >= 0; shift -= 8) first.push_back(static_cast<char>(block >> shift));
+        auto u = prf.mac(first.data(), first.size());
+        auto t = u;
+        for (std::uint32_t i = 1; i < iterations; ++i) {
+            u = prf.mac(u.data(), u.size());
+            for (std::size_t j = 0; j < t.size(); ++j) t[j] ^= u[j];
+        }
+        out.append(reinterpret_cast<const char*>(t.data()), std::min(t.size(), keyBytes - out.size()));
+    }
+    return out;
+}
+
+std::string HashPassword(std::string_view password) {
+    std::random_device random; // the OS generator where there is one
+    std::string salt(kSaltBytes, '\0');
+    for (auto& byte : salt) byte = static_cast<char>(random());
+    const std::uint32_t iterations = PasswordIterations();
+    return std::string(kScheme) + '$' + std::to_string(iterations) + '$' + toHex(salt) + '$' +
+           toHex(derive(password, salt, iterations, kKeyBytes));
+}
+
+bool VerifyPassword(std::string_view passwordHash, std::string_view candidate) {
+    Parsed stored;
+    if (parse(passwordHash, stored)) {
+        return equalConstantTime(stored.key, derive(candidate, stored.salt, stored.iterations, stored.key.size()));
+    }
+    std::string legacy;
+    if (passwordHash.size() == 2 * kLegacyBytes && fromHex(passwordHash, legacy)) {
+        return equalConstantTime(legacy, legacyFnv1a64(candidate));
+    }
+    return false;
 }
 
-bool VerifyPasswordDemo(const std::string& passwordHash, const std::string& candidate) {
-    return passwordHash == HashPasswordDemo(candidate);
+bool PasswordNeedsRehash(std::string_view passwordHash) {
+    Parsed stored;
+    return !parse(passwordHash, stored) || stored.iterations < PasswordIterations();
 }
 
 }
@@ -1,12 +1,34 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace hms {
 
-// NOTE: These helpers are intentionally simple and deterministic so that
-// credentials stored in fixture JSON files keep working across platforms.
-// Swap them out for Argon2/bcrypt/Scrypt in production.
-std::string HashPasswordDemo(const std::string& password);
-bool        VerifyPasswordDemo(const std::string& passwordHash, const std::string& candidate);
+// Password hashes are PBKDF2-HMAC-SHA256 with a random 16-byte salt per
+// hash, stored as "pbkdf2-sha256$<iterations>$<salt hex>$<key hex>" so the
+// cost can rise later without invalidating existing hashes. The key
+// derivation runs on HashWorkers (see HashWorkers.h).
+//
+// Hashes from before this format (16 hex digits of FNV-1a) are still
+// accepted by VerifyPassword and reported by PasswordNeedsRehash; the
+// login screen replaces them on the next successful login.
+
+// PBKDF2 iterations for new hashes. The default takes a few tens of
+// milliseconds on current hardware; tests lower it.
+constexpr std::uint32_t kDefaultPasswordIterations = 100'000;
+void          SetPasswordIterations(std::uint32_t iterations); // clamped to at least 1
+std::uint32_t PasswordIterations();
+
+std::string HashPassword(std::string_view password);
+// Compares in constant time (for a given hash format and length).
+bool VerifyPassword(std::string_view passwordHash, std::string_view candidate);
+// True for legacy hashes and for hashes below the current iteration count.
+bool PasswordNeedsRehash(std::string_view passwordHash);
+
+// PBKDF2-HMAC-SHA256 (RFC 8018) of `keyBytes` bytes.
+std::string Pbkdf2HmacSha256(std::string_view password, std::string_view salt, std::uint32_t iterations,
+                             std::size_t keyBytes);
 
 }
@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace hms {
+
+    // SHA-256 (FIPS 180-4), fed incrementally. Only what the password KDF
+    // needs; not hardened against side channels beyond being branch-free
+    // on the data.
+    class Sha256 {
+    public:
+        static constexpr std::size_t kDigestBytes = 32;
+        static constexpr std::size_t kBlockBytes  = 64;
+        using Digest = std::array<unsigned char, kDigestBytes>;
+
+        Sha256() { reset(); }
+
+        void   reset();
+        void   update(const void* data, std::size_t size);
+        void   update(std::string_view text) { update(text.data(), text.size()); }
+        Digest finish(); // the object must be reset() before reuse
+
+    private:
+        void compress(const unsigned char* block);
+
+        std::array<std::uint32_t, 8> state_{};
+        std::array<unsigned char, kBlockBytes> buffer_{};
+        std::size_t   buffered_{0};
+        std::uint64_t length_{0}; // bytes hashed so far
+    };
+
+    // HMAC-SHA256 with the key schedule done once, so PBKDF2's many MACs
+    // under one key only hash the message part.
+    class HmacSha256 {
+    public:
+        explicit HmacSha256(std::string_view key);
+
+        Sha256::Digest mac(const void* data, std::size_t size) const;
+
+    private:
+        Sha256 inner_; // key ^ ipad absorbed
+        Sha256 outer_; // key ^ opad absorbed
+    };
+
+}
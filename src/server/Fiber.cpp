@@ -0,0 +1,101 @@
+#include "Fiber.h"
+
+#if defined(__linux__)
+
+#include <new>
+#include <utility>
+
+#include <cxxabi.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+namespace hms::server {
+
+namespace {
+
+thread_local Fiber* tCurrent = nullptr;
+
+// The C++ runtime tracks the exceptions currently being handled per
+// thread. A fiber can suspend inside a catch block (e.g. while printing an
+// error), so each fiber keeps its own copy of that state across switches.
+// Same layout in libstdc++ and libc++abi.
+struct EhGlobals {
+    void*        caughtExceptions;
+    unsigned int uncaughtExceptions;
+};
+
+EhGlobals& threadEhGlobals() {
+    return *reinterpret_cast<EhGlobals*>(abi::__cxa_get_globals());
+}
+
+}
+
+struct Fiber::Context {
+    ucontext_t fiber{};
+    ucontext_t caller{};
+    EhGlobals  eh{nullptr, 0};
+};
+
+Fiber::Fiber(std::function<void()> body, std::size_t stackBytes)
+    : body_(std::move(body)), context_(std::make_unique<Context>()) {
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t usable = (stackBytes + page - 1) / page * page;
+    mappedBytes_ = usable + page;
+    stack_ = ::mmap(nullptr, mappedBytes_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (stack_ == MAP_FAILED) {
+        stack_ = nullptr;
+        throw std::bad_alloc();
+    }
+    ::mprotect(stack_, page, PROT_NONE); // stacks grow down: the guard is the lowest page
+
+    if (::getcontext(&context_->fiber) != 0) {
+        ::munmap(stack_, mappedBytes_);
+        throw std::bad_alloc();
+    }
+    context_->fiber.uc_stack.ss_sp   = static_cast<char*>(stack_) + page;
+    context_->fiber.uc_stack.ss_size = usable;
+    context_->fiber.uc_link          = &context_->caller; // where the body returns to
+    ::makecontext(&context_->fiber, &Fiber::trampoline, 0);
+}
+
+Fiber::~Fiber() {
+    if (stack_ != nullptr) ::munmap(stack_, mappedBytes_);
+}
+
+void Fiber::trampoline() {
+    Fiber* self = tCurrent;
+    try {
+        self->body_();
+    }
+    catch (...) {
+        self->error_ = std::current_exception();
+    }
+    self->finished_ = true;
+}
+
+bool Fiber::resume() {
+    if (finished_) return false;
+    Fiber* outer = tCurrent;
+    tCurrent = this;
+    const EhGlobals outerEh = std::exchange(threadEhGlobals(), context_->eh);
+    ::swapcontext(&context_->caller, &context_->fiber);
+    context_->eh = std::exchange(threadEhGlobals(), outerEh);
+    tCurrent = outer;
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+    return !finished_;
+}
+
+void Fiber::yield() {
+    Fiber* self = tCurrent;
+    ::swapcontext(&self->context_->fiber, &self->context_->caller);
+}
+
+Fiber* Fiber::current() noexcept {
+    return tCurrent;
+}
+
+}
+
+#endif
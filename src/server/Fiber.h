@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+
+namespace hms::server {
+
+    // Stackful coroutine: resume() runs the body on its own stack until the
+    // body calls Fiber::yield() or returns. The console flows are ordinary
+    // blocking code; running one on a fiber lets it suspend in the middle
+    // of a read and an event loop resume it when the socket has data.
+    //
+    // The stack is reserved with mmap and committed by the kernel as it is
+    // touched, so a fiber parked at a prompt costs the few pages it used,
+    // not its full size. A guard page turns overflow into a crash instead
+    // of heap corruption. A fiber must stay on the thread that first
+    // resumed it, and must have finished before it is destroyed (a
+    // suspended stack is discarded without unwinding).
+    class Fiber {
+    public:
+        static constexpr std::size_t kDefaultStackBytes = 256 * 1024;
+
+        explicit Fiber(std::function<void()> body, std::size_t stackBytes = kDefaultStackBytes);
+        ~Fiber();
+        Fiber(const Fiber&) = delete;
+        Fiber& operator=(const Fiber&) = delete;
+
+        // Runs until the next yield() or the end of the body and returns
+        // whether the fiber can be resumed again. An exception that escapes
+        // the body is rethrown here.
+        bool resume();
+        bool finished() const noexcept { return finished_; }
+
+        // Suspends the calling fiber; execution continues after the resume()
+        // that started it. Only valid on a fiber.
+        static void yield();
+        // The fiber running on this thread, or nullptr.
+        static Fiber* current() noexcept;
+
+    private:
+        struct Context;
+
+        static void trampoline();
+
+        std::function<void()>    body_;
+        std::unique_ptr<Context> context_;
+        void*                    stack_{nullptr};
+        std::size_t              mappedBytes_{0};
+        std::exception_ptr       error_;
+        bool                     finished_{false};
+    };
+
+}
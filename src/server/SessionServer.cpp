@@ -0,0 +1,574 @@
+#include "SessionServer.h"
+#include "../ui/Router.h"
+#include "../ui/core/ConsoleIO.h"
+#include "../diagnostics/Trace.h"
+
+#include <iostream>
+#include <system_error>
+
+#if defined(__linux__)
+#include "Fiber.h"
+#include "../security/HashWorkers.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace hms::server {
+
+fs::path defaultSocketPath() {
+    std::error_code ec;
+    fs::path dir = fs::temp_directory_path(ec);
+    if (ec) dir = ".";
+    return dir / "hms.sock";
+}
+
+#if !defined(__linux__)
+
+bool serve(const Services&, const fs::path&) {
+    std::cerr << "Server mode needs epoll and is only available on Linux.\n";
+    return false;
+}
+
+int connect(const fs::path&) {
+    std::cerr << "Server mode needs epoll and is only available on Linux.\n";
+    return 1;
+}
+
+#else
+
+namespace {
+
+struct Session {
+    explicit Session(int socket) : fd(socket) {}
+
+    int                    fd;
+    std::uint32_t          waitingFor{0}; // epoll events the fiber is parked on
+    ui::StreamBinding      streams{&std::cin, &std::cout};
+    std::unique_ptr<Fiber> fiber;
+};
+
+// Called on a session's fiber when its socket would block: gives the thread
+// back to the event loop until the socket reports one of `events`.
+void park(Session& session, std::uint32_t events) {
+    session.waitingFor = events;
+    Fiber::yield();
+    session.waitingFor = 0;
+}
+
+// A session's non-blocking socket as both its input and its output. Where a
+// blocking socket would stall the thread, this parks the session's fiber.
+// Output collects in a buffer and is sent on flush (the session's istream
+// is tied to its ostream, so at the latest before every read).
+class SocketStreamBuf : public std::streambuf {
+public:
+    explicit SocketStreamBuf(Session& session) : session_(session) {
+        setg(in_.data(), in_.data(), in_.data());
+        setp(out_.data(), out_.data() + out_.size());
+    }
+    ~SocketStreamBuf() override { drain(); }
+
+protected:
+    int_type underflow() override {
+        for (;;) {
+            const ssize_t n = ::recv(session_.fd, in_.data(), in_.size(), 0);
+            if (n > 0) {
+                setg(in_.data(), in_.data(), in_.data() + n);
+                return traits_type::to_int_type(in_[0]);
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { park(session_, EPOLLIN); continue; }
+            return traits_type::eof(); // client gone, or the server is stopping
+        }
+    }
+
+    int_type overflow(int_type ch) override {
+        if (!drain()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override { return drain() ? 0 : -1; }
+
+private:
+    bool drain() {
+        const char* p = pbase();
+        bool ok = true;
+        while (p < pptr()) {
+            const ssize_t n = ::send(session_.fd, p, static_cast<std::size_t>(pptr() - p), MSG_NOSIGNAL);
+            if (n > 0) { p += n; continue; }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { park(session_, EPOLLOUT); continue; }
+            ok = false;
+            break;
+        }
+        setp(out_.data(), out_.data() + out_.size());
+        return ok;
+    }
+
+    Session&               session_;
+    std::array<char, 4096> in_;
+    std::array<char, 4096> out_;
+};
+
+void runSession(const Services& svc, Session& session, const std::atomic<bool>& stopping) {
+    HMS_TRACE_SPAN("server.session", "server");
+    try {
+        SocketStreamBuf buffer(session);
+        std::istream input(&buffer);
+        std::ostream output(&buffer);
+        const ui::SessionStreams streams(input, output);
+
+        AppContext ctx{ .svc = svc, .currentUser = std::nullopt, .running = true };
+        ui::RunSession(ctx);
+        if (!stopping) ui::SaveAll(ctx); // the server saves once for everybody when it stops
+        output.flush();
+    }
+    catch (...) {
+        // A session must not take the server down; the loop closes its socket.
+    }
+}
+
+// One epoll instance and the sessions it runs, each on a fiber, all on the
+// thread that calls run(). A session parked at a prompt costs its socket,
+// a few touched stack pages and a map entry. Sockets are registered once,
+// edge-triggered; a session is resumed when its socket reports what it is
+// parked on (a spurious resume just parks it again). A session waiting for
+// a password hash is parked too, and resumed when the worker reports back.
+class EventLoop : public WorkWaiter {
+public:
+    EventLoop(const Services& svc, const std::atomic<bool>& stopping)
+        : svc_(svc), stopping_(stopping),
+          epoll_(::epoll_create1(EPOLL_CLOEXEC)),
+          wake_(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+        if (epoll_ < 0 || wake_ < 0) return;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wake_;
+        if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, wake_, &ev) != 0) {
+            ::close(wake_);
+            wake_ = -1;
+        }
+    }
+    ~EventLoop() {
+        if (wake_ >= 0) ::close(wake_);
+        if (epoll_ >= 0) ::close(epoll_);
+    }
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool ok() const { return epoll_ >= 0 && wake_ >= 0; }
+
+    // Any thread: hands a connected, non-blocking socket to this loop.
+    void adopt(int fd) {
+        {
+            const std::lock_guard lock(mutex_);
+            incoming_.push_back(fd);
+        }
+        wake();
+    }
+
+    // Any thread: closes every session's socket; run() returns once all of
+    // them have wound down.
+    void stop() {
+        {
+            const std::lock_guard lock(mutex_);
+            stopRequested_ = true;
+        }
+        wake();
+    }
+
+    std::function<void()> notifier() override {
+        Session* const session = running_;
+        return [this, session] {
+            {
+                const std::lock_guard lock(mutex_);
+                finished_.push_back(session);
+            }
+            wake();
+        };
+    }
+
+    void suspend() override { park(*running_, 0); }
+
+    void run() {
+        struct WaiterScope {
+            explicit WaiterScope(WorkWaiter* waiter) : previous(exchangeWorkWaiter(waiter)) {}
+            ~WaiterScope() { exchangeWorkWaiter(previous); }
+            WorkWaiter* previous;
+        } waiter(this);
+        std::array<epoll_event, 64> events;
+        bool closing = false;
+        while (!(closing && sessions_.empty())) {
+            const int n = ::epoll_wait(epoll_, events.data(), static_cast<int>(events.size()), -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                closing = true; // cannot wait any more: close everything and drive it to the end
+                closeAll();
+                for (auto it = sessions_.begin(); it != sessions_.end(); it = sessions_.begin()) resume(*it->second);
+                continue;
+            }
+            for (int i = 0; i < n; ++i) {
+                const int fd = events[i].data.fd;
+                if (fd == wake_) {
+                    closing = takeHandoffs() || closing;
+                    continue;
+                }
+                const auto it = sessions_.find(fd);
+                if (it == sessions_.end()) continue;
+                Session& session = *it->second;
+                if ((events[i].events & (session.waitingFor | EPOLLERR | EPOLLHUP)) != 0) resume(session);
+            }
+        }
+    }
+
+private:
+    void wake() {
+        const std::uint64_t one = 1;
+        (void)!::write(wake_, &one, sizeof one);
+    }
+
+    // Starts sessions for the sockets handed over and resumes those whose
+    // hash work finished; true once stop() was called.
+    bool takeHandoffs() {
+        std::uint64_t count = 0;
+        (void)!::read(wake_, &count, sizeof count);
+        std::vector<int> fds;
+        std::vector<Session*> finished;
+        bool stopping = false;
+        {
+            const std::lock_guard lock(mutex_);
+            fds.swap(incoming_);
+            finished.swap(finished_);
+            stopping = stopRequested_;
+        }
+        for (Session* session : finished) {
+            // Sessions only end when their fiber does, which cannot happen
+            // while it waits for the work; the lookup is a safety net.
+            const auto it = sessions_.find(session->fd);
+            if (it != sessions_.end() && it->second.get() == session) resume(*session);
+        }
+        for (const int fd : fds) {
+            if (stopping) ::close(fd);
+            else start(fd);
+        }
+        if (stopping) closeAll();
+        return stopping;
+    }
+
+    void start(int fd) {
+        auto owned = std::make_unique<Session>(fd);
+        Session& session = *owned;
+        try {
+            session.fiber = std::make_unique<Fiber>([this, &session] { runSession(svc_, session, stopping_); });
+        }
+        catch (const std::bad_alloc&) {
+            ::close(fd);
+            return;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            return;
+        }
+        sessions_.emplace(fd, std::move(owned));
+        resume(session); // show the welcome screen
+    }
+
+    void resume(Session& session) {
+        const ui::StreamBinding outer = ui::exchangeStreams(session.streams);
+        running_ = &session;
+        const bool alive = session.fiber->resume();
+        running_ = nullptr;
+        session.streams = ui::exchangeStreams(outer);
+        if (alive) return;
+        const int fd = session.fd;
+        ::close(fd);
+        sessions_.erase(fd);
+    }
+
+    // Sessions see end of input at their next read and finish.
+    void closeAll() {
+        for (const auto& entry : sessions_) ::shutdown(entry.first, SHUT_RDWR);
+    }
+
+    const Services&          svc_;
+    const std::atomic<bool>& stopping_;
+    int                      epoll_;
+    int                      wake_;
+
+    std::mutex            mutex_; // guards the handoff state below
+    std::vector<int>      incoming_;
+    std::vector<Session*> finished_; // their hash work is done
+    bool                  stopRequested_{false};
+
+    std::unordered_map<int, std::unique_ptr<Session>> sessions_;
+    Session*                                          running_{nullptr}; // the fiber being resumed
+};
+
+// Self-pipe: the signal handler only writes a byte that the accept loop
+// polls for.
+int stopPipe[2] = {-1, -1};
+
+void onStopSignal(int) {
+    const int saved = errno;
+    const char byte = 's';
+    (void)!::write(stopPipe[1], &byte, 1);
+    errno = saved;
+}
+
+bool socketAddress(const fs::path& path, sockaddr_un& addr) {
+    const std::string text = path.string();
+    if (text.empty() || text.size() >= sizeof(addr.sun_path)) return false;
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, text.c_str(), text.size() + 1);
+    return true;
+}
+
+// -1 (errno set) if nothing accepts connections at `path`.
+int dial(const fs::path& path) {
+    sockaddr_un addr{};
+    if (!socketAddress(path, addr)) { errno = ENAMETOOLONG; return -1; }
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0) {
+        const int saved = errno;
+        ::close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Turns the terminal's echo on and off for the client; restores the
+// original settings when destroyed. Does nothing if stdin is not a tty.
+class LocalEcho {
+public:
+    LocalEcho() : tty_(::isatty(STDIN_FILENO) == 1 && ::tcgetattr(STDIN_FILENO, &original_) == 0) {}
+    ~LocalEcho() {
+        if (tty_) ::tcsetattr(STDIN_FILENO, TCSANOW, &original_);
+    }
+    LocalEcho(const LocalEcho&) = delete;
+    LocalEcho& operator=(const LocalEcho&) = delete;
+
+    void set(bool on) {
+        if (!tty_) return;
+        termios t = original_;
+        if (on) t.c_lflag |= ECHO;
+        else    t.c_lflag &= ~static_cast<tcflag_t>(ECHO);
+        ::tcsetattr(STDIN_FILENO, TCSANOW, &t);
+    }
+
+private:
+    termios original_{};
+    bool    tty_;
+};
+
+constexpr std::string_view kMarkerPrefix = "\x1b]hms;";
+
+// Writes `pending` to stdout and acts on the echo markers in it. A marker
+// split across reads stays in `pending` for the next call.
+void relayOutput(std::string& pending, LocalEcho& echo) {
+    std::size_t done = 0;
+    for (;;) {
+        const std::size_t at = pending.find(kMarkerPrefix, done);
+        if (at == std::string::npos) {
+            std::size_t keep = std::min(kMarkerPrefix.size() - 1, pending.size() - done);
+            while (keep > 0 && std::string_view(pending).substr(pending.size() - keep) != kMarkerPrefix.substr(0, keep)) --keep;
+            writeAll(STDOUT_FILENO, pending.data() + done, pending.size() - done - keep);
+            pending.erase(0, pending.size() - keep);
+            return;
+        }
+        writeAll(STDOUT_FILENO, pending.data() + done, at - done);
+        const std::size_t end = pending.find('\x07', at);
+        if (end == std::string::npos) {
+            pending.erase(0, at);
+            return;
+        }
+        const std::string_view marker(pending.data() + at, end + 1 - at);
+        if (marker == ui::kEchoOffMarker) echo.set(false);
+        else if (marker == ui::kEchoOnMarker) echo.set(true);
+        done = end + 1;
+    }
+}
+
+}
+
+bool serve(const Services& svc, const fs::path& socketPath) {
+    sockaddr_un addr{};
+    if (!socketAddress(socketPath, addr)) {
+        std::cerr << "Socket path is empty or too long: " << socketPath.string() << '\n';
+        return false;
+    }
+    std::error_code ec;
+    if (fs::exists(socketPath, ec)) {
+        if (const int other = dial(socketPath); other >= 0) {
+            ::close(other);
+            std::cerr << "Another server is already listening on " << socketPath.string() << '\n';
+            return false;
+        }
+        fs::remove(socketPath, ec); // left behind by a server that did not stop cleanly
+    }
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0 ||
+        ::bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Could not listen on " << socketPath.string() << ": " << std::strerror(errno) << '\n';
+        if (listener >= 0) ::close(listener);
+        return false;
+    }
+    // One event loop per core; each takes every n-th connection.
+    std::atomic<bool> stopping{false};
+    std::vector<std::unique_ptr<EventLoop>> loops;
+    const unsigned loopCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < loopCount; ++i) {
+        loops.push_back(std::make_unique<EventLoop>(svc, stopping));
+        if (!loops.back()->ok()) {
+            std::cerr << "Could not create an event loop: " << std::strerror(errno) << '\n';
+            ::close(listener);
+            fs::remove(socketPath, ec);
+            return false;
+        }
+    }
+    if (::pipe2(stopPipe, O_CLOEXEC) != 0) {
+        std::cerr << "Could not set up signal handling: " << std::strerror(errno) << '\n';
+        ::close(listener);
+        fs::remove(socketPath, ec);
+        return false;
+    }
+
+    struct sigaction stop{};
+    stop.sa_handler = onStopSignal;
+    stop.sa_flags = SA_RESTART;
+    sigemptyset(&stop.sa_mask);
+    struct sigaction oldInt{}, oldTerm{};
+    ::sigaction(SIGINT, &stop, &oldInt);
+    ::sigaction(SIGTERM, &stop, &oldTerm);
+
+    std::vector<std::thread> threads;
+    for (const auto& loop : loops) threads.emplace_back([&loop] { loop->run(); });
+    std::size_t nextLoop = 0;
+
+    std::cout << "Serving on " << socketPath.string() << " with " << loopCount
+              << (loopCount == 1 ? " event loop" : " event loops") << " (Ctrl+C to stop)" << std::endl;
+
+    for (;;) {
+        pollfd fds[2] = { { listener, POLLIN, 0 }, { stopPipe[0], POLLIN, 0 } };
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents != 0) break;
+        if ((fds[0].revents & POLLIN) == 0) continue;
+        const int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) continue;
+        loops[nextLoop++ % loops.size()]->adopt(fd);
+    }
+
+    // Stop: no new clients; every session sees its input close and winds down.
+    stopping = true;
+    ::close(listener);
+    fs::remove(socketPath, ec);
+    for (const auto& loop : loops) loop->stop();
+    for (auto& thread : threads) thread.join();
+
+    ::sigaction(SIGINT, &oldInt, nullptr);
+    ::sigaction(SIGTERM, &oldTerm, nullptr);
+    ::close(stopPipe[0]);
+    ::close(stopPipe[1]);
+    stopPipe[0] = stopPipe[1] = -1;
+
+    AppContext ctx{ .svc = svc, .currentUser = std::nullopt, .running = false };
+    ui::SaveAll(ctx);
+    std::cout << "Server stopped." << std::endl;
+    return true;
+}
+
+int connect(const fs::path& socketPath) {
+    const int fd = dial(socketPath);
+    if (fd < 0) {
+        std::cerr << "Could not connect to " << socketPath.string() << ": " << std::strerror(errno) << '\n';
+        return 1;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN); // a server that went away shows up as a failed write
+    LocalEcho echo;
+    std::string pending;
+    std::array<char, 4096> buffer;
+    bool stdinOpen = true;
+    for (;;) {
+        pollfd fds[2] = { { fd, POLLIN, 0 }, { STDIN_FILENO, POLLIN, 0 } };
+        if (::poll(fds, stdinOpen ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents != 0) {
+            const ssize_t n = ::recv(fd, buffer.data(), buffer.size(), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break; // the session ended
+            pending.append(buffer.data(), static_cast<std::size_t>(n));
+            relayOutput(pending, echo);
+        }
+        if (stdinOpen && fds[1].revents != 0) {
+            const ssize_t n = ::read(STDIN_FILENO, buffer.data(), buffer.size());
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                stdinOpen = false;
+                ::shutdown(fd, SHUT_WR); // the server reads end of input, then finishes
+            }
+            else if (!writeAll(fd, buffer.data(), static_cast<std::size_t>(n))) {
+                break;
+            }
+        }
+    }
+    writeAll(STDOUT_FILENO, pending.data(), pending.size());
+    ::close(fd);
+    return 0;
+}
+
+#endif
+
+}
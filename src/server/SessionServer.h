@@ -0,0 +1,26 @@
+#pragma once
+#include <filesystem>
+#include "../ui/AppContext.h"
+
+namespace hms::server {
+
+    // "<temp dir>/hms.sock": where --serve listens and --connect dials when
+    // no path is given.
+    std::filesystem::path defaultSocketPath();
+
+    // Serves the console UI to every client that connects to the Unix
+    // socket at `socketPath`. Each connection gets its own AppContext and
+    // runs on a fiber of one of a few epoll event loops (one per core), so
+    // sessions waiting at a prompt hold no thread. The repositories in
+    // `svc` must already be loaded and are shared by all sessions. Runs
+    // until SIGINT or SIGTERM, then closes every session, waits for it and
+    // saves. False (after printing why) if the socket could not be set up,
+    // e.g. because another server is already listening there. Linux only.
+    bool serve(const Services& svc, const std::filesystem::path& socketPath);
+
+    // Terminal client for serve(): relays stdin and stdout over the socket
+    // and switches local echo off while the server reads a password.
+    // Returns the process exit code.
+    int connect(const std::filesystem::path& socketPath);
+
+}
@@ -0,0 +1,100 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <fstream>
+#include <new>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+thread_local hms::MonotonicArena* tCurrentArena = nullptr;
+
+constexpr std::size_t kMaxBlockBytes = std::size_t{64} * 1024 * 1024;
+
+}
+
+namespace hms {
+
+MonotonicArena::MonotonicArena(std::size_t firstBlockBytes)
+    : nextBlockBytes_(std::max<std::size_t>(firstBlockBytes, 256)) {}
+
+MonotonicArena::~MonotonicArena() {
+    release();
+}
+
+void MonotonicArena::grow(std::size_t minBytes) {
+    const std::size_t size = std::max(nextBlockBytes_, minBytes + alignof(std::max_align_t));
+    auto* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->prev = head_;
+    block->size = size;
+    head_   = block;
+    cursor_ = reinterpret_cast<char*>(block + 1);
+    end_    = cursor_ + size;
+    reserved_ += size;
+    ++blocks_;
+    nextBlockBytes_ = std::min(nextBlockBytes_ * 2, kMaxBlockBytes);
+}
+
+void* MonotonicArena::allocate(std::size_t bytes, std::size_t alignment) {
+    auto aligned = [&] {
+        const auto p = reinterpret_cast<std::uintptr_t>(cursor_);
+        return reinterpret_cast<char*>((p + alignment - 1) & ~(std::uintptr_t{alignment} - 1));
+    };
+    char* p = aligned();
+    if (cursor_ == nullptr || p + bytes > end_) {
+        grow(bytes + alignment);
+        p = aligned();
+    }
+    cursor_ = p + bytes;
+    allocated_ += bytes;
+    return p;
+}
+
+void MonotonicArena::release() {
+    while (head_ != nullptr) {
+        Block* prev = head_->prev;
+        ::operator delete(head_);
+        head_ = prev;
+    }
+    cursor_ = end_ = nullptr;
+    allocated_ = reserved_ = blocks_ = 0;
+}
+
+ArenaScope::ArenaScope(MonotonicArena& arena)
+    : previous_(tCurrentArena) {
+    tCurrentArena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    tCurrentArena = previous_;
+}
+
+MonotonicArena* ArenaScope::current() {
+    return tCurrentArena;
+}
+
+bool readFileText(const fs::path& path, MonotonicArena& arena, std::string_view& text) {
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec) return false;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in.good()) return false;
+    auto* data = static_cast<char*>(arena.allocate(size, 1));
+    if (!in.read(data, static_cast<std::streamsize>(size))) return false;
+    text = std::string_view(data, static_cast<std::size_t>(size));
+    return true;
+}
+
+const ArenaJson* parseJsonFile(const fs::path& path, MonotonicArena& arena) {
+    std::string_view text;
+    if (!readFileText(path, arena, text)) return nullptr;
+
+    auto parsed = ArenaJson::parse(text.begin(), text.end(), nullptr, /*allow_exceptions=*/false);
+    if (parsed.is_discarded()) return nullptr;
+    return new (arena.allocate(sizeof(ArenaJson), alignof(ArenaJson))) ArenaJson(std::move(parsed));
+}
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace hms {
+
+    // Bump allocator for load-time data. Allocation is a pointer increment;
+    // nothing is freed individually. Blocks grow geometrically and are all
+    // returned at once by release() or the destructor.
+    class MonotonicArena {
+    public:
+        explicit MonotonicArena(std::size_t firstBlockBytes = 64 * 1024);
+        ~MonotonicArena();
+        MonotonicArena(const MonotonicArena&) = delete;
+        MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+        void* allocate(std::size_t bytes, std::size_t alignment);
+        void  release(); // frees every block; outstanding pointers dangle
+
+        std::size_t bytesAllocated() const { return allocated_; } // handed out
+        std::size_t bytesReserved() const  { return reserved_; }  // held in blocks
+        std::size_t blockCount() const     { return blocks_; }
+
+    private:
+        struct Block {
+            Block*      prev;
+            std::size_t size; // usable bytes after the header
+        };
+
+        void grow(std::size_t minBytes);
+
+        Block*      head_{nullptr};
+        char*       cursor_{nullptr};
+        char*       end_{nullptr};
+        std::size_t nextBlockBytes_;
+        std::size_t allocated_{0};
+        std::size_t reserved_{0};
+        std::size_t blocks_{0};
+    };
+
+    // Makes `arena` the current thread's allocation target for ArenaAllocator
+    // until the scope ends. Scopes nest; the innermost one wins.
+    class ArenaScope {
+    public:
+        explicit ArenaScope(MonotonicArena& arena);
+        ~ArenaScope();
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+
+        static MonotonicArena* current();
+
+    private:
+        MonotonicArena* previous_;
+    };
+
+    // Stateless allocator over the thread's current arena (see ArenaScope).
+    // Outside a scope it falls back to the global heap. Containers using it
+    // must not outlive the scope they were filled in: inside a scope
+    // deallocation is a no-op and the arena reclaims the memory wholesale.
+    template <typename T>
+    struct ArenaAllocator {
+        using value_type = T;
+
+        ArenaAllocator() noexcept = default;
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n) {
+            if (auto* arena = ArenaScope::current()) {
+                return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+            }
+            return std::allocator<T>{}.allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            if (ArenaScope::current() == nullptr) std::allocator<T>{}.deallocate(p, n);
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>&) const noexcept { return true; }
+    };
+
+    using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+    // JSON DOM whose nodes, arrays, object maps and strings all live in the
+    // current arena. Repositories parse into it and convert to model types;
+    // from_json overloads used with it must not cache JSON values in statics.
+    using ArenaJson = nlohmann::basic_json<std::map, std::vector, ArenaString, bool,
+                                           std::int64_t, std::uint64_t, double, ArenaAllocator>;
+
+    // Reads the whole of `path` into `arena`; false when it cannot be read.
+    bool readFileText(const std::filesystem::path& path, MonotonicArena& arena, std::string_view& text);
+
+    // Reads and parses `path` with both the file text and the DOM placed in
+    // `arena`. The returned document is never destroyed; it disappears with
+    // the arena. Must be called inside an ArenaScope for `arena`. Returns
+    // nullptr when the file cannot be read or is not valid JSON.
+    const ArenaJson* parseJsonFile(const std::filesystem::path& path, MonotonicArena& arena);
+
+}
@@ -0,0 +1,31 @@
+#include "BackgroundCompactor.h"
+#include "BookingRepository.h"
+
+#include <mutex>
+
+namespace hms {
+
+BackgroundCompactor::BackgroundCompactor(BookingRepository& bookings, std::uint64_t threshold,
+                                         std::chrono::milliseconds interval)
+        : bookings_(bookings), threshold_(threshold), interval_(interval),
+          thread_([this](std::stop_token stop) { run(stop); }) {}
+
+BackgroundCompactor::~BackgroundCompactor() {
+    thread_.request_stop(); // wakes the wait in run()
+    thread_.join();
+}
+
+void BackgroundCompactor::run(std::stop_token stop) {
+    std::mutex sleeping;
+    std::unique_lock lock(sleeping);
+    for (;;) {
+        // Returns early only when a stop is requested.
+        wake_.wait_for(lock, stop, interval_, [] { return false; });
+        if (stop.stop_requested()) return;
+        if (bookings_.journalBytes() <= threshold_) continue;
+        // A shard that fails keeps its journals and is retried next time.
+        if (bookings_.compact()) ++compactions_;
+    }
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <stop_token>
+#include <thread>
+
+namespace hms {
+
+    class BookingRepository;
+
+    // Keeps a journaled BookingRepository's journals short: a thread that
+    // wakes every `interval` and runs compact() once more than `threshold`
+    // journal bytes have built up. Compaction happens next to the writers
+    // (see BookingRepository::compact), so nobody waits for a full save.
+    // Stops (after any compaction in progress) when destroyed.
+    class BackgroundCompactor {
+    public:
+        static constexpr std::uint64_t kDefaultThreshold = 1024 * 1024;
+
+        explicit BackgroundCompactor(BookingRepository& bookings,
+                                     std::uint64_t threshold = kDefaultThreshold,
+                                     std::chrono::milliseconds interval = std::chrono::seconds(1));
+        ~BackgroundCompactor();
+        BackgroundCompactor(const BackgroundCompactor&) = delete;
+        BackgroundCompactor& operator=(const BackgroundCompactor&) = delete;
+
+        std::uint64_t compactions() const { return compactions_; } // completed so far
+
+    private:
+        void run(std::stop_token stop);
+
+        BookingRepository&              bookings_;
+        const std::uint64_t             threshold_;
+        const std::chrono::milliseconds interval_;
+        std::condition_variable_any     wake_;
+        std::atomic<std::uint64_t>      compactions_{0};
+        std::jthread                    thread_; // last: started once the rest is set up
+    };
+
+}
@@ -0,0 +1,408 @@
+#include "BookingArchive.h"
+#include "Crc32.h"
+#include "FileSink.h"
+#include "Lz.h"
+#include "../models/Codec.h"
+#include "../diagnostics/Metrics.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path baseDataDir() {
+#ifdef HMS_DATA_DIR
+    return fs::path{HMS_DATA_DIR};
+#else
+    return (fs::current_path() / "data").lexically_normal();
+#endif
+}
+
+// Segment file layout (fixed-size integers little-endian):
+//   "HMSSEG3\n"
+//   blocks: u32 rawSize, u32 storedSize, u32 bookings, u32 CRC-32 of the
+//           stored bytes, storedSize bytes of LZ-compressed, binary-encoded
+//           bookings
+//   index:  varint blockCount, then per block (Codec.h varints): offset,
+//           rawSize, storedSize, bookings, min and max createdAt, min and
+//           max hotelId
+//   footer: u64 index offset, u32 CRC-32 of the index, "HMSIDX3\n"
+// Version 2 segments ("HMSSEG2\n") have no checksums (12-byte block
+// headers, footer without the CRC, "HMSIDX2\n"); version 1 ("HMSSEG1\n")
+// also has no index or footer and is read front to back.
+constexpr char        kMagicV1[] = "HMSSEG1\n";
+constexpr char        kMagicV2[] = "HMSSEG2\n";
+constexpr char        kMagic[] = "HMSSEG3\n";
+constexpr char        kIndexMagicV2[] = "HMSIDX2\n";
+constexpr char        kIndexMagic[] = "HMSIDX3\n";
+constexpr std::size_t kMagicBytes = sizeof(kMagic) - 1;
+constexpr std::size_t kBlockHeaderBytes = 16;
+constexpr std::size_t kFooterBytes = 12 + kMagicBytes;
+constexpr char        kPrefix[] = "segment-";
+constexpr char        kExtension[] = ".seg";
+
+void putU32(char* at, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) at[i] = static_cast<char>((v >> (8 * i)) & 0xff);
+}
+
+std::uint32_t getU32(const char* at) {
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= std::uint32_t{static_cast<unsigned char>(at[i])} << (8 * i);
+    return v;
+}
+
+std::uint64_t getU64(const char* at) {
+    return getU32(at) | (std::uint64_t{getU32(at + 4)} << 32);
+}
+
+// "segment-000042.seg" -> 42; 0 for anything else.
+std::uint64_t segmentNumber(const fs::path& p) {
+    const std::string name = p.filename().string();
+    if (p.extension() != kExtension || name.rfind(kPrefix, 0) != 0) return 0;
+    const char* first = name.data() + sizeof(kPrefix) - 1;
+    const char* last  = name.data() + name.size() - (sizeof(kExtension) - 1);
+    std::uint64_t number = 0;
+    auto [end, ec] = std::from_chars(first, last, number);
+    return ec == std::errc{} && end == last ? number : 0;
+}
+
+// Where a block is and the range of what it holds (its zone map).
+struct BlockInfo {
+    std::uint64_t offset{0};
+    std::uint32_t rawSize{0};
+    std::uint32_t storedSize{0};
+    std::uint32_t count{0};
+    std::int64_t  minCreatedAt{std::numeric_limits<std::int64_t>::max()};
+    std::int64_t  maxCreatedAt{std::numeric_limits<std::int64_t>::min()};
+    std::string   minHotelId;
+    std::string   maxHotelId;
+
+    void cover(const hms::Booking& b) {
+        const std::string_view hotel = b.hotelId;
+        if (count == 0 || hotel < minHotelId) minHotelId.assign(hotel);
+        if (count == 0 || hotel > maxHotelId) maxHotelId.assign(hotel);
+        minCreatedAt = std::min(minCreatedAt, b.createdAt);
+        maxCreatedAt = std::max(maxCreatedAt, b.createdAt);
+        ++count;
+    }
+};
+
+// Cuts bookings into blocks as they come, then writes the index.
+class SegmentWriter {
+public:
+    explicit SegmentWriter(hms::FileSink& sink) : sink_(sink) {
+        sink_.write(kMagic, kMagicBytes);
+        offset_ = kMagicBytes;
+    }
+
+    void add(const hms::Booking& b) {
+        hms::BinaryWriter writer(raw_);
+        writeBinary(writer, b);
+        block_.cover(b);
+        if (raw_.size() >= hms::BookingArchive::kBlockBytes) flush();
+    }
+
+    void finish() {
+        flush();
+        std::string index;
+        hms::BinaryWriter writer(index);
+        writer.varint(blocks_.size());
+        for (const auto& block : blocks_) {
+            writer.varint(block.offset);
+            writer.varint(block.rawSize);
+            writer.varint(block.storedSize);
+            writer.varint(block.count);
+            writer.signedVarint(block.minCreatedAt);
+            writer.signedVarint(block.maxCreatedAt);
+            writer.bytes(block.minHotelId);
+            writer.bytes(block.maxHotelId);
+        }
+        sink_.write(index.data(), index.size());
+
+        char footer[kFooterBytes];
+        putU32(footer, static_cast<std::uint32_t>(offset_ & 0xffffffffu));
+        putU32(footer + 4, static_cast<std::uint32_t>(offset_ >> 32));
+        putU32(footer + 8, hms::crc32(index));
+        std::copy(kIndexMagic, kIndexMagic + kMagicBytes, footer + 12);
+        sink_.write(footer, sizeof footer);
+    }
+
+private:
+    void flush() {
+        if (block_.count == 0) return;
+        hms::lz::compress(raw_, stored_);
+        block_.offset = offset_;
+        block_.rawSize = static_cast<std::uint32_t>(raw_.size());
+        block_.storedSize = static_cast<std::uint32_t>(stored_.size());
+
+        char header[kBlockHeaderBytes];
+        putU32(header, block_.rawSize);
+        putU32(header + 4, block_.storedSize);
+        putU32(header + 8, block_.count);
+        putU32(header + 12, hms::crc32(stored_));
+        sink_.write(header, sizeof header);
+        sink_.write(stored_.data(), stored_.size());
+        offset_ += sizeof header + stored_.size();
+
+        blocks_.push_back(std::move(block_));
+        block_ = BlockInfo{};
+        raw_.clear();
+    }
+
+    hms::FileSink&         sink_;
+    std::uint64_t          offset_{0};
+    std::string            raw_;
+    std::string            stored_;
+    BlockInfo              block_;
+    std::vector<BlockInfo> blocks_;
+};
+
+// Reads the block whose header is at the stream position into `raw`.
+// `checksummed`: the header carries the stored bytes' CRC (version 3).
+bool readBlock(std::istream& in, bool checksummed, BlockInfo& block, std::string& stored, std::string& raw) {
+    char header[kBlockHeaderBytes];
+    const std::size_t headerBytes = checksummed ? kBlockHeaderBytes : kBlockHeaderBytes - 4;
+    if (!in.read(header, static_cast<std::streamsize>(headerBytes))) return false;
+    block.rawSize = getU32(header);
+    block.storedSize = getU32(header + 4);
+    block.count = getU32(header + 8);
+    // A block never decodes to more than its bound allows; anything else
+    // is a corrupt size, not a reason to allocate gigabytes.
+    if (block.storedSize > hms::lz::compressBound(block.rawSize) ||
+        block.rawSize > 64 * hms::BookingArchive::kBlockBytes) return false;
+    stored.resize(block.storedSize);
+    if (!in.read(stored.data(), block.storedSize)) return false;
+    HMS_COUNTER_ADD("archive.bytesRead", headerBytes + block.storedSize);
+    HMS_COUNTER_ADD("archive.blocksRead", 1);
+    if (checksummed && hms::crc32(stored) != getU32(header + 12)) {
+        HMS_COUNTER_ADD("archive.checksumErrors", 1);
+        return false;
+    }
+    return hms::lz::decompress(stored, block.rawSize, raw);
+}
+
+bool visitBlock(std::string_view raw, std::uint32_t count, const hms::BookingFilter& filter,
+                const hms::BookingArchive::Visit& visit, bool& stopped) {
+    hms::BinaryReader reader(raw);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        hms::Booking b;
+        if (!readBinary(reader, b)) return false;
+        if (filter.matches(b) && !visit(b)) {
+            stopped = true;
+            return true;
+        }
+    }
+    return reader.atEnd();
+}
+
+bool readIndex(std::istream& in, std::uint64_t fileBytes, bool checksummed, std::vector<BlockInfo>& blocks) {
+    const std::size_t footerBytes = checksummed ? kFooterBytes : kFooterBytes - 4;
+    const char* const indexMagic = checksummed ? kIndexMagic : kIndexMagicV2;
+    if (fileBytes < kMagicBytes + footerBytes) return false;
+    char footer[kFooterBytes];
+    in.seekg(static_cast<std::streamoff>(fileBytes - footerBytes));
+    if (!in.read(footer, static_cast<std::streamsize>(footerBytes)) ||
+        !std::equal(footer + footerBytes - kMagicBytes, footer + footerBytes, indexMagic)) return false;
+    const std::uint64_t indexOffset = getU64(footer);
+    if (indexOffset < kMagicBytes || indexOffset > fileBytes - footerBytes) return false;
+
+    std::string index(static_cast<std::size_t>(fileBytes - footerBytes - indexOffset), '\0');
+    in.seekg(static_cast<std::streamoff>(indexOffset));
+    if (!in.read(index.data(), static_cast<std::streamsize>(index.size()))) return false;
+    HMS_COUNTER_ADD("archive.bytesRead", footerBytes + index.size());
+    if (checksummed && hms::crc32(index) != getU32(footer + 8)) return false;
+
+    hms::BinaryReader reader(index);
+    std::uint64_t count = 0;
+    if (!reader.varint(count) || count > reader.remaining()) return false;
+    blocks.resize(static_cast<std::size_t>(count));
+    for (auto& block : blocks) {
+        std::uint64_t rawSize = 0, storedSize = 0, bookings = 0;
+        std::string_view minHotel, maxHotel;
+        if (!reader.varint(block.offset) || !reader.varint(rawSize) || !reader.varint(storedSize) ||
+            !reader.varint(bookings) || !reader.signedVarint(block.minCreatedAt) ||
+            !reader.signedVarint(block.maxCreatedAt) || !reader.bytes(minHotel) || !reader.bytes(maxHotel)) {
+            return false;
+        }
+        if (block.offset >= indexOffset) return false;
+        block.rawSize = static_cast<std::uint32_t>(rawSize);
+        block.storedSize = static_cast<std::uint32_t>(storedSize);
+        block.count = static_cast<std::uint32_t>(bookings);
+        block.minHotelId.assign(minHotel);
+        block.maxHotelId.assign(maxHotel);
+    }
+    return reader.atEnd();
+}
+
+}
+
+namespace hms {
+
+BookingArchive::path_t BookingArchive::defaultPath() {
+    return (baseDataDir() / "archive").lexically_normal();
+}
+
+BookingArchive::BookingArchive(path_t directory)
+        : directory_(std::move(directory)) {}
+
+std::vector<BookingArchive::path_t> BookingArchive::segments() const {
+    std::vector<path_t> out;
+    std::error_code ec;
+    if (!fs::is_directory(directory_, ec)) return out;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (entry.is_regular_file(ec) && segmentNumber(entry.path()) != 0) out.push_back(entry.path());
+    }
+    // Zero-padded numbers: name order is append order.
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::size_t BookingArchive::segmentCount() const {
+    return segments().size();
+}
+
+bool BookingArchive::append(std::vector<Booking> bookings) {
+    HMS_SCOPED_LATENCY("archive.append");
+    if (bookings.empty()) return true;
+    // Clustered by hotel, oldest first within one: blocks then cover few
+    // hotels and a short period each, which is what makes their ranges
+    // worth checking.
+    std::sort(bookings.begin(), bookings.end(), [](const Booking& a, const Booking& b) {
+        if (a.hotelId != b.hotelId) return a.hotelId < b.hotelId;
+        if (a.createdAt != b.createdAt) return a.createdAt < b.createdAt;
+        return a.bookingId < b.bookingId;
+    });
+    const std::lock_guard appending(appendMutex_);
+
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    const auto existing = segments();
+    const std::uint64_t number = existing.empty() ? 1 : segmentNumber(existing.back()) + 1;
+    char name[40];
+    std::snprintf(name, sizeof name, "%s%06llu%s", kPrefix, static_cast<unsigned long long>(number), kExtension);
+    const path_t target = directory_ / name;
+    const path_t tmp = target.string() + ".tmp";
+
+    std::uint64_t bytes = 0;
+    {
+        FileSink sink(tmp);
+        if (!sink.good()) return false;
+        // Pending items are decoded one booking at a time while encoding.
+        try {
+            SegmentWriter writer(sink);
+            for (const auto& b : bookings) writer.add(b);
+            writer.finish();
+        }
+        catch (...) {
+            sink.fail();
+        }
+        bytes = sink.bytesWritten();
+        if (!sink.finish()) {
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, target, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    // The caller drops the hot copies next; the segment must outlive a
+    // power loss first.
+    syncDirectory(directory_);
+    HMS_COUNTER_ADD("archive.bytesWritten", bytes);
+    return true;
+}
+
+bool BookingArchive::readSegment(const path_t& segment, const BookingFilter& filter, const Visit& visit,
+                                 bool& stopped) const {
+    std::ifstream in(segment, std::ios::binary);
+    char magic[kMagicBytes];
+    if (!in.read(magic, kMagicBytes)) return false;
+    const bool v1 = std::equal(magic, magic + kMagicBytes, kMagicV1);
+    const bool v2 = std::equal(magic, magic + kMagicBytes, kMagicV2);
+    const bool checksummed = std::equal(magic, magic + kMagicBytes, kMagic);
+    if (!v1 && !v2 && !checksummed) return false;
+    std::string stored;
+    std::string raw;
+
+    std::error_code ec;
+    const auto size = fs::file_size(segment, ec);
+    std::vector<BlockInfo> blocks;
+    if (ec) return false;
+    if (v1 || !readIndex(in, size, checksummed, blocks)) {
+        if (v2) return false;
+        // No index (version 1), or a damaged one: read the blocks front to
+        // back. With checksums, the blocks before the first bad one are
+        // still good; what follows is dropped and counted.
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(kMagicBytes));
+        BlockInfo block;
+        while (in.peek() != std::char_traits<char>::eof()) {
+            if (!readBlock(in, checksummed, block, stored, raw)) {
+                if (!checksummed) return false;
+                HMS_COUNTER_ADD("archive.damagedSegments", 1);
+                return true;
+            }
+            if (!visitBlock(raw, block.count, filter, visit, stopped)) return false;
+            if (stopped) return true;
+        }
+        return true;
+    }
+    for (const auto& entry : blocks) {
+        if (!filter.mayMatch(entry.minCreatedAt, entry.maxCreatedAt, entry.minHotelId, entry.maxHotelId)) {
+            HMS_COUNTER_ADD("archive.blocksSkipped", 1);
+            continue;
+        }
+        BlockInfo block;
+        in.seekg(static_cast<std::streamoff>(entry.offset));
+        if (!readBlock(in, checksummed, block, stored, raw) || block.count != entry.count ||
+            block.rawSize != entry.rawSize) {
+            return false;
+        }
+        if (!visitBlock(raw, block.count, filter, visit, stopped)) return false;
+        if (stopped) return true;
+    }
+    return true;
+}
+
+bool BookingArchive::scan(const BookingFilter& filter, const Visit& visit) const {
+    HMS_SCOPED_LATENCY("archive.scan");
+    bool stopped = false;
+    for (const auto& segment : segments()) {
+        if (!readSegment(segment, filter, visit, stopped)) return false;
+        if (stopped) break;
+    }
+    return true;
+}
+
+std::optional<Booking> BookingArchive::get(const BookingId& bookingId) const {
+    // A booking archived twice (hot copy kept after a failed save) is
+    // found in the later segment, which holds the newer copy.
+    std::optional<Booking> found;
+    forEach([&](const Booking& b) {
+        if (b.bookingId == bookingId) found = b;
+        return true;
+    });
+    return found;
+}
+
+std::vector<Booking> BookingArchive::listByHotel(const HotelId& hotelId) const {
+    std::vector<Booking> out;
+    BookingFilter filter;
+    filter.hotelId = hotelId;
+    scan(filter, [&](const Booking& b) {
+        out.push_back(b);
+        return true;
+    });
+    return out;
+}
+
+}
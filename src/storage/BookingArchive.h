@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../models/Booking.h"
+
+namespace hms {
+
+    // Which bookings a scan wants; unset fields match everything.
+    struct BookingFilter {
+        std::optional<HotelId>      hotelId;
+        std::optional<std::int64_t> createdFrom;   // epoch seconds, inclusive
+        std::optional<std::int64_t> createdBefore; // epoch seconds, exclusive
+
+        bool matches(const Booking& b) const {
+            return (!hotelId || b.hotelId == *hotelId) &&
+                   (!createdFrom || b.createdAt >= *createdFrom) &&
+                   (!createdBefore || b.createdAt < *createdBefore);
+        }
+
+        // False when nothing with createdAt and hotelId in these (inclusive)
+        // ranges can match, so a block with that zone map can be skipped.
+        bool mayMatch(std::int64_t minCreatedAt, std::int64_t maxCreatedAt,
+                      std::string_view minHotelId, std::string_view maxHotelId) const {
+            if (createdFrom && maxCreatedAt < *createdFrom) return false;
+            if (createdBefore && minCreatedAt >= *createdBefore) return false;
+            if (hotelId && (hotelId->view() < minHotelId || hotelId->view() > maxHotelId)) return false;
+            return true;
+        }
+    };
+
+    // Cold tier for bookings nobody changes any more. Closed bookings
+    // (checked out or cancelled) past a minimum age are moved here by
+    // BookingRepository::archiveClosed, so the hot repository keeps only
+    // active and recent ones in memory and in its JSON files.
+    //
+    // The archive is a directory of append-only segment files; each
+    // append() writes one new segment and existing segments are never
+    // modified. A segment is a run of blocks of binary-encoded bookings
+    // (see Codec.h), each block LZ-compressed (see Lz.h) on its own, so
+    // reads hold one block in memory at a time. Bookings are written in
+    // hotel, then creation order, and an index at the end of the segment
+    // records each block's createdAt and hotelId range: a scan with a
+    // BookingFilter reads only the blocks that may hold matches. Nothing
+    // is cached: queries stream the segments from disk on demand. Every
+    // block and the index carry a CRC-32, so damage is detected rather
+    // than decoded into wrong bookings.
+    //
+    // Safe to share between threads: appends are serialized and readers
+    // only see complete segments (written to a temp file and renamed).
+    class BookingArchive {
+    public:
+        using path_t = std::filesystem::path;
+        using Visit  = std::function<bool(const Booking&)>; // false stops the scan
+
+        // Raw bytes of bookings per block before compression.
+        static constexpr std::size_t kBlockBytes = 64 * 1024;
+
+        explicit BookingArchive(path_t directory = defaultPath());
+
+        // How long (seconds since the last update) a closed booking stays
+        // hot before archiveClosed moves it here. 0 keeps everything hot.
+        void         setMinimumAge(std::int64_t seconds) { minimumAge_ = seconds < 0 ? 0 : seconds; }
+        std::int64_t minimumAge() const { return minimumAge_; }
+
+        // Writes `bookings` as a new segment. False (and no segment) when
+        // the directory or file cannot be written.
+        bool append(std::vector<Booking> bookings);
+
+        // Streams the archived bookings matching `filter`, oldest segment
+        // first, skipping blocks whose ranges rule out a match. A segment
+        // whose index is damaged is read front to back up to its first bad
+        // block (counted in archive.damagedSegments). False when a segment
+        // cannot be read or a block fails its checksum; bookings before the
+        // bad block have been visited by then.
+        bool scan(const BookingFilter& filter, const Visit& visit) const;
+        bool forEach(const Visit& visit) const { return scan({}, visit); }
+
+        // On-demand lookups; each one scans the archive.
+        std::optional<Booking> get(const BookingId& bookingId) const;
+        std::vector<Booking>   listByHotel(const HotelId& hotelId) const;
+        std::size_t            segmentCount() const;
+
+        static path_t defaultPath();                 //../src/data/archive (normalized)
+        const path_t& directory() const { return directory_; }
+
+    private:
+        std::vector<path_t> segments() const; // oldest first
+        bool readSegment(const path_t& segment, const BookingFilter& filter, const Visit& visit,
+                         bool& stopped) const;
+
+        mutable std::mutex appendMutex_; // one new segment at a time
+        path_t             directory_;
+        std::int64_t       minimumAge_{0};
+    };
+
+}
@@ -0,0 +1,117 @@
+#include "BookingExport.h"
+#include "FileSink.h"
+#include "../models/BookingMetrics.h"
+#include "../diagnostics/Metrics.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+namespace {
+
+void putField(hms::FileSink& sink, std::string_view text) {
+    const bool quote = text.find_first_of(",\"\r\n") != std::string_view::npos;
+    if (!quote) {
+        sink.write(text.data(), text.size());
+        return;
+    }
+    sink.put('"');
+    for (char ch : text) {
+        if (ch == '"') sink.put('"');
+        sink.put(ch);
+    }
+    sink.put('"');
+}
+
+void putTime(hms::FileSink& sink, std::int64_t secs) {
+    std::time_t t = static_cast<std::time_t>(secs);
+    std::tm tm{};
+#if defined(_WIN32)
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+    char text[32];
+    const auto size = std::strftime(text, sizeof text, "%Y-%m-%dT%H:%M:%SZ", &tm);
+    sink.write(text, size);
+}
+
+void putNumber(hms::FileSink& sink, std::int64_t value) {
+    char text[24];
+    const int size = std::snprintf(text, sizeof text, "%lld", static_cast<long long>(value));
+    sink.write(text, static_cast<std::size_t>(size));
+}
+
+void putMoney(hms::FileSink& sink, std::int64_t cents) {
+    char text[32];
+    const auto whole = static_cast<long long>(cents / 100);
+    const auto part  = static_cast<long long>(cents < 0 ? -(cents % 100) : cents % 100);
+    const int size = std::snprintf(text, sizeof text, "%s%lld.%02lld", cents < 0 && whole == 0 ? "-" : "", whole, part);
+    sink.write(text, static_cast<std::size_t>(size));
+}
+
+// Rows start with the line break: writeFileAtomically ends the last one.
+void putRow(hms::FileSink& sink, const hms::Booking& b) {
+    const auto metrics = hms::summarize(b);
+    sink.put('\n');
+    putField(sink, b.bookingId);
+    sink.put(',');
+    putField(sink, b.hotelId);
+    sink.put(',');
+    putField(sink, hms::enumName(b.status));
+    sink.put(',');
+    putTime(sink, b.createdAt);
+    sink.put(',');
+    putTime(sink, b.updatedAt);
+    sink.put(',');
+    putField(sink, b.primaryGuestId);
+    sink.put(',');
+    putNumber(sink, metrics.rooms);
+    sink.put(',');
+    putNumber(sink, metrics.roomNights);
+    sink.put(',');
+    putMoney(sink, metrics.roomRevenue);
+    sink.put(',');
+    putMoney(sink, metrics.diningRevenue);
+}
+
+}
+
+namespace hms {
+
+bool exportBookingsCsv(const BookingRepository& bookings, const BookingArchive* archive,
+                       const BookingFilter& filter, const std::filesystem::path& target,
+                       std::size_t& rows) {
+    HMS_SCOPED_LATENCY("bookings.exportCsv");
+    rows = 0;
+    std::uint64_t bytes = 0;
+    const bool ok = writeFileAtomically(target, [&](FileSink& sink) {
+        static constexpr std::string_view kHeader =
+            "bookingId,hotelId,status,createdAt,updatedAt,primaryGuestId,rooms,roomNights,roomRevenue,diningRevenue";
+        sink.write(kHeader.data(), kHeader.size());
+        try {
+            const auto hot = filter.hotelId ? bookings.listByHotel(*filter.hotelId) : bookings.list();
+            for (const auto& b : hot) {
+                if (!filter.matches(b)) continue;
+                putRow(sink, b);
+                ++rows;
+            }
+            if (!archive) return;
+            const bool scanned = archive->scan(filter, [&](const Booking& b) {
+                if (bookings.get(b.bookingId)) return true;
+                putRow(sink, b);
+                ++rows;
+                return true;
+            });
+            if (!scanned) sink.fail();
+        }
+        catch (...) {
+            sink.fail(); // items that cannot be decoded
+        }
+    }, bytes);
+    return ok;
+}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include "BookingArchive.h"
+#include "BookingRepository.h"
+
+namespace hms {
+
+    // Booking history as CSV, one row per booking with its totals:
+    //   bookingId,hotelId,status,createdAt,updatedAt,primaryGuestId,
+    //   rooms,roomNights,roomRevenue,diningRevenue
+    // (times as UTC "YYYY-MM-DDTHH:MM:SSZ", money as decimal euros). Hot
+    // bookings matching `filter` come first, then archived ones streamed
+    // from `archive` (may be null), skipping the blocks `filter` rules out;
+    // rows go straight to the file, so memory use does not grow with the
+    // archive. An archived booking that is also still hot is written once.
+    // `rows` receives the number of bookings written; false (and `target`
+    // left as it was) when anything could not be read or written.
+    bool exportBookingsCsv(const BookingRepository& bookings, const BookingArchive* archive,
+                           const BookingFilter& filter, const std::filesystem::path& target,
+                           std::size_t& rows);
+
+}
@@ -0,0 +1,313 @@
+#include "BookingFileReader.h"
+#include "../models/Codec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+
+namespace hms {
+
+namespace {
+
+// One scalar SAX event, as offered to a header field.
+struct Scalar {
+    enum class Kind { Null, Boolean, Integer, Unsigned, Float, String };
+
+    Kind             kind{Kind::Null};
+    std::int64_t     integer{0};
+    std::uint64_t    unsignedValue{0};
+    double           floating{0};
+    std::string_view text;
+};
+
+// Same conversions as the Schema from_json for these member types; false
+// where from_json would throw.
+template <typename M>
+bool assign(M& member, const Scalar& v) {
+    if constexpr (is_fixed_id_v<M>) {
+        return v.kind == Scalar::Kind::String && M::parse(v.text, member);
+    }
+    else if constexpr (EnumWithNames<M>) {
+        member = v.kind == Scalar::Kind::String ? enumFromName<M>(v.text) : enumNames(M{})[0].first;
+        return true;
+    }
+    else if constexpr (std::is_same_v<M, std::string>) {
+        if (v.kind != Scalar::Kind::String) return false;
+        member.assign(v.text);
+        return true;
+    }
+    else if constexpr (std::is_integral_v<M>) {
+        switch (v.kind) {
+            case Scalar::Kind::Integer:  member = static_cast<M>(v.integer); return true;
+            case Scalar::Kind::Unsigned: member = static_cast<M>(v.unsignedValue); return true;
+            case Scalar::Kind::Float:    member = static_cast<M>(v.floating); return true;
+            default:                     return false;
+        }
+    }
+    else {
+        return false; // containers are not scalar header fields
+    }
+}
+
+template <typename T>
+void afterRead(T& value) {
+    if constexpr (HasAfterRead<T>) Schema<T>::afterRead(value);
+}
+
+constexpr std::size_t kBookingFields = std::tuple_size_v<decltype(Schema<Booking>::fields)>;
+static_assert(kBookingFields <= 32, "seen-field mask is 32 bits");
+
+// nlohmann SAX handler. Nesting is tracked with a small state machine;
+// values nobody reads are skipped, and "items" arrays are re-emitted through
+// a JsonWriter into a per-booking string.
+class BookingSax {
+public:
+    using number_integer_t  = json::number_integer_t;
+    using number_unsigned_t = json::number_unsigned_t;
+    using number_float_t    = json::number_float_t;
+    using string_t          = json::string_t;
+    using binary_t          = json::binary_t;
+
+    BookingSax(int maxVersion, std::vector<Booking>& out, std::uint64_t& journalGeneration)
+        : maxVersion_(maxVersion), out_(out), journalGeneration_(journalGeneration) {
+        std::size_t index = 0;
+        forEachField<Booking>([&](const auto& f) {
+            if (f.name == "items") itemsField_ = index;
+            ++index;
+        });
+    }
+
+    bool null()                                   { return scalar({}); }
+    bool boolean(bool value)                      { Scalar s; s.kind = Scalar::Kind::Boolean; s.integer = value; return scalar(s); }
+    bool number_integer(number_integer_t value)   { Scalar s; s.kind = Scalar::Kind::Integer; s.integer = value; return scalar(s); }
+    bool number_unsigned(number_unsigned_t value) { Scalar s; s.kind = Scalar::Kind::Unsigned; s.unsignedValue = value; return scalar(s); }
+    bool number_float(number_float_t value, const string_t&) { Scalar s; s.kind = Scalar::Kind::Float; s.floating = value; return scalar(s); }
+    bool string(string_t& value)                  { Scalar s; s.kind = Scalar::Kind::String; s.text = value; return scalar(s); }
+    bool binary(binary_t&)                        { return false; }
+
+    bool start_object(std::size_t) {
+        if (capturing()) { countCapturedValue(); capture_->beginObject(); ++captureDepth_; return true; }
+        if (skipDepth_ > 0) { ++skipDepth_; return true; }
+        switch (where_) {
+            case Where::Top:
+                envelope_ = true;
+                where_ = Where::Envelope;
+                return true;
+            case Where::Envelope: return skipValue(envelopeKey_ == EnvelopeKey::Other);
+            case Where::Records:
+                out_.emplace_back();
+                seen_ = 0;
+                where_ = Where::Record;
+                return true;
+            case Where::Record:   return skipValue(field_ == kUnknownField);
+            case Where::Done:     return false;
+        }
+        return false;
+    }
+
+    bool end_object() {
+        if (capturing()) { capture_->endObject(); --captureDepth_; return true; }
+        if (skipDepth_ > 0) { --skipDepth_; return true; }
+        if (where_ == Where::Record) {
+            if (!requiredFieldsSeen()) return false;
+            afterRead(out_.back());
+            where_ = Where::Records;
+            return true;
+        }
+        if (where_ == Where::Envelope) {
+            where_ = Where::Done;
+            return sawVersion_ && sawRecords_;
+        }
+        return false;
+    }
+
+    bool start_array(std::size_t) {
+        if (capturing()) { countCapturedValue(); capture_->beginArray(); ++captureDepth_; return true; }
+        if (skipDepth_ > 0) { ++skipDepth_; return true; }
+        switch (where_) {
+            case Where::Top:
+                where_ = Where::Records; // version 1: a bare array
+                sawVersion_ = sawRecords_ = true;
+                return true;
+            case Where::Envelope:
+                if (envelopeKey_ == EnvelopeKey::Bookings) {
+                    sawRecords_ = true;
+                    where_ = Where::Records;
+                    return true;
+                }
+                return skipValue(envelopeKey_ == EnvelopeKey::Other);
+            case Where::Record:
+                if (field_ == itemsField_) {
+                    captureText_.clear();
+                    captureCount_ = 0;
+                    capture_.emplace(captureSink_);
+                    capture_->beginArray();
+                    captureDepth_ = 1;
+                    return true;
+                }
+                return skipValue(field_ == kUnknownField);
+            case Where::Records:
+            case Where::Done:
+                return false;
+        }
+        return false;
+    }
+
+    bool end_array() {
+        if (capturing()) {
+            capture_->endArray();
+            if (--captureDepth_ == 0) finishItems();
+            return true;
+        }
+        if (skipDepth_ > 0) { --skipDepth_; return true; }
+        if (where_ != Where::Records) return false;
+        where_ = envelope_ ? Where::Envelope : Where::Done;
+        return true;
+    }
+
+    bool key(string_t& name) {
+        if (capturing()) { capture_->key(name); return true; }
+        if (skipDepth_ > 0) return true;
+        if (where_ == Where::Envelope) {
+            envelopeKey_ = name == "formatVersion" ? EnvelopeKey::Version
+                         : name == "bookings"      ? EnvelopeKey::Bookings
+                         : name == "journal"       ? EnvelopeKey::Journal
+                                                   : EnvelopeKey::Other;
+            return true;
+        }
+        if (where_ == Where::Record) {
+            field_ = kUnknownField;
+            std::size_t index = 0;
+            forEachField<Booking>([&](const auto& f) {
+                if (f.name == name) field_ = index;
+                ++index;
+            });
+            return true;
+        }
+        return false;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) { return false; }
+
+private:
+    enum class Where { Top, Envelope, Records, Record, Done };
+    enum class EnvelopeKey { Version, Bookings, Journal, Other };
+
+    static constexpr std::size_t kUnknownField = static_cast<std::size_t>(-1);
+
+    bool capturing() const { return captureDepth_ > 0; }
+
+    void countCapturedValue() {
+        if (captureDepth_ == 1) ++captureCount_;
+    }
+
+    bool skipValue(bool allowed) {
+        if (!allowed) return false;
+        skipDepth_ = 1;
+        return true;
+    }
+
+    bool scalar(const Scalar& v) {
+        if (capturing()) {
+            countCapturedValue();
+            switch (v.kind) {
+                case Scalar::Kind::Null:     capture_->null(); break;
+                case Scalar::Kind::Boolean:  capture_->boolean(v.integer != 0); break;
+                case Scalar::Kind::Integer:  capture_->integer(v.integer); break;
+                case Scalar::Kind::Unsigned: capture_->integer(v.unsignedValue); break;
+                case Scalar::Kind::Float:    capture_->number(v.floating); break;
+                case Scalar::Kind::String:   capture_->string(v.text); break;
+            }
+            return true;
+        }
+        if (skipDepth_ > 0) return true;
+
+        switch (where_) {
+            case Where::Top:
+                where_ = Where::Done;
+                return v.kind == Scalar::Kind::Null; // an empty (null) file holds no bookings
+            case Where::Envelope:
+                if (envelopeKey_ == EnvelopeKey::Journal) {
+                    journalGeneration_ = v.unsignedValue;
+                    return v.kind == Scalar::Kind::Unsigned;
+                }
+                if (envelopeKey_ != EnvelopeKey::Version) return envelopeKey_ == EnvelopeKey::Other;
+                sawVersion_ = true;
+                return v.kind == Scalar::Kind::Unsigned &&
+                       v.unsignedValue <= static_cast<std::uint64_t>(maxVersion_);
+            case Where::Record: {
+                if (field_ == kUnknownField) return true;
+                bool ok = false;
+                std::size_t index = 0;
+                forEachField<Booking>([&](const auto& f) {
+                    if (index++ != field_) return;
+                    ok = assign(out_.back().*f.member, v);
+                });
+                if (ok) seen_ |= std::uint32_t{1} << field_;
+                return ok;
+            }
+            case Where::Records:
+            case Where::Done:
+                return false;
+        }
+        return false;
+    }
+
+    void finishItems() {
+        auto& items = out_.back().items;
+        if (captureCount_ == 0) items.clear();
+        else items = BookingItems::deferred(std::string(captureText_), captureCount_);
+        capture_.reset();
+        seen_ |= std::uint32_t{1} << field_;
+    }
+
+    bool requiredFieldsSeen() const {
+        bool ok = true;
+        std::size_t index = 0;
+        forEachField<Booking>([&](const auto& f) {
+            if (f.presence == Presence::Required && (seen_ & (std::uint32_t{1} << index)) == 0) ok = false;
+            ++index;
+        });
+        return ok;
+    }
+
+    int                   maxVersion_;
+    std::vector<Booking>& out_;
+    std::uint64_t&        journalGeneration_;
+    std::size_t           itemsField_{kUnknownField};
+
+    Where         where_{Where::Top};
+    bool          envelope_{false};
+    bool          sawVersion_{false};
+    bool          sawRecords_{false};
+    EnvelopeKey   envelopeKey_{EnvelopeKey::Other};
+    std::size_t   field_{kUnknownField};
+    std::uint32_t seen_{0};
+    std::size_t   skipDepth_{0};
+
+    std::string                           captureText_;
+    StringSink                            captureSink_{captureText_};
+    std::optional<JsonWriter<StringSink>> capture_;
+    std::size_t                           captureDepth_{0};
+    std::size_t                           captureCount_{0};
+};
+
+}
+
+bool readBookingFile(std::string_view text, int maxVersion, std::vector<Booking>& out,
+                     std::uint64_t* journalGeneration) {
+    out.clear();
+    std::uint64_t generation = 0;
+    BookingSax sax(maxVersion, out, generation);
+    const bool ok = json::sax_parse(text.begin(), text.end(), &sax);
+    if (journalGeneration) *journalGeneration = generation;
+    return ok;
+}
+
+}
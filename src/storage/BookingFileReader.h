@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../models/Booking.h"
+
+namespace hms {
+
+    // Reads the text of a bookings.json file, any format version up to
+    // `maxVersion`, without building a JSON tree. Header fields go straight
+    // into each Booking; every "items" array is copied, minified, into a
+    // deferred BookingItems that is decoded on first use. False on invalid
+    // JSON, an unexpected layout, a missing or mistyped header field, or a
+    // newer formatVersion; `out` is unspecified then. `journalGeneration`,
+    // if given, receives the envelope's "journal" field (0 when absent).
+    bool readBookingFile(std::string_view text, int maxVersion, std::vector<Booking>& out,
+                         std::uint64_t* journalGeneration = nullptr);
+
+}
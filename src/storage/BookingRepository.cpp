@@ -1,9 +1,23 @@
 #include "BookingRepository.h"
+#include "Arena.h"
+#include "BookingArchive.h"
+#include "BookingFileReader.h"
+#include "Crc32.h"
+#include "FileSink.h"
+#include "../models/Codec.h"
+#include "../diagnostics/Metrics.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <charconv>
 #include <fstream>
+#include <iomanip>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <iterator>
+#include <sstream>
 #include <system_error>
 #include <utility>
 
@@ -22,6 +36,139 @@ fs::path baseDataDir() {
 #endif
 }
 
+std::uintmax_t fileSize(const fs::path& p) {
+    std::error_code ec;
+    const auto size = fs::file_size(p, ec);
+    return ec ? 0 : size;
+}
+
+// Numeric suffix of "BKG-000042"-style ids; 0 when there is none.
+int idSuffix(std::string_view id) {
+    const auto pos = id.find_last_of('-');
+    if (pos == std::string_view::npos) return 0;
+    const char* first = id.data() + pos + 1;
+    const char* last  = id.data() + id.size();
+    int number = 0;
+    auto [end, ec] = std::from_chars(first, last, number);
+    return ec == std::errc{} && end == last && first != last ? number : 0;
+}
+
+// Only the header fields are decoded here; each booking keeps its items
+// as text until they are first used (see BookingItems).
+bool readBookings(const fs::path& path, int maxVersion, std::vector<hms::Booking>& out,
+                  std::uint64_t* journalGeneration = nullptr) {
+    HMS_COUNTER_ADD("bookings.bytesRead", fileSize(path));
+    hms::MonotonicArena arena;
+    std::string_view text;
+    if (!hms::readFileText(path, arena, text)) return false;
+    if (!hms::readBookingFile(text, maxVersion, out, journalGeneration)) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+constexpr std::string_view kJournalInfix = ".journal.";
+
+// "<snapshot>.journal.<n>" -> n; nullopt for other names.
+std::optional<std::uint64_t> journalNumber(const fs::path& journal, std::string_view snapshotName) {
+    const std::string name = journal.filename().string();
+    if (name.size() <= snapshotName.size() + kJournalInfix.size() ||
+        name.compare(0, snapshotName.size(), snapshotName) != 0 ||
+        name.compare(snapshotName.size(), kJournalInfix.size(), kJournalInfix) != 0) {
+        return std::nullopt;
+    }
+    const char* first = name.data() + snapshotName.size() + kJournalInfix.size();
+    const char* last  = name.data() + name.size();
+    std::uint64_t number = 0;
+    auto [end, ec] = std::from_chars(first, last, number);
+    if (ec != std::errc{} || end != last) return std::nullopt;
+    return number;
+}
+
+// The snapshot a "<name>.json.journal.<n>" file belongs to.
+std::optional<fs::path> journalSnapshot(const fs::path& journal) {
+    const std::string name = journal.filename().string();
+    const auto infix = name.rfind(kJournalInfix);
+    if (infix == std::string::npos) return std::nullopt;
+    const auto snapshot = journal.parent_path() / name.substr(0, infix);
+    if (snapshot.extension() != ".json" || !journalNumber(journal, snapshot.filename().string())) return std::nullopt;
+    return snapshot;
+}
+
+// Journals of `snapshot`, oldest first.
+std::vector<std::pair<std::uint64_t, fs::path>> journalsOf(const fs::path& snapshot) {
+    std::vector<std::pair<std::uint64_t, fs::path>> out;
+    std::error_code ec;
+    const std::string snapshotName = snapshot.filename().string();
+    for (const auto& entry : fs::directory_iterator(snapshot.parent_path(), ec)) {
+        if (auto number = journalNumber(entry.path(), snapshotName)) out.emplace_back(*number, entry.path());
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+fs::path journalPath(const fs::path& snapshot, std::uint64_t generation) {
+    return snapshot.string() + std::string(kJournalInfix) + std::to_string(generation);
+}
+
+// A journal line: the record's CRC-32 as 8 hex digits, a space, the
+// record, a newline.
+std::string checksummedLine(std::string_view record) {
+    char crc[10];
+    std::snprintf(crc, sizeof crc, "%08x ", static_cast<unsigned>(hms::crc32(record)));
+    std::string line;
+    line.reserve(9 + record.size() + 1);
+    line.append(crc, 9).append(record).push_back('\n');
+    return line;
+}
+
+// The record in one journal line (without its newline), or nullopt when
+// the line is torn (`complete` false: no newline) or fails its checksum.
+std::optional<std::string_view> checkedRecord(std::string_view line, bool complete) {
+    if (!complete) return std::nullopt;
+    if (line.empty()) return line;
+    std::uint32_t crc = 0;
+    if (line.size() < 9 || line[8] != ' ') return std::nullopt;
+    const auto [end, ec] = std::from_chars(line.data(), line.data() + 8, crc, 16);
+    if (ec != std::errc{} || end != line.data() + 8) return std::nullopt;
+    const std::string_view record = line.substr(9);
+    if (hms::crc32(record) != crc) return std::nullopt;
+    return record;
+}
+
+// Journal records, one compact JSON object per line.
+std::string putRecord(const hms::Booking& b) {
+    std::string out;
+    hms::StringSink sink{out};
+    hms::JsonWriter<hms::StringSink> w(sink, -1);
+    w.beginObject();
+    w.key("op");
+    w.string("put");
+    w.key("booking");
+    hms::writeJson(w, b);
+    w.endObject();
+    return out;
+}
+
+std::string deleteRecord(const hms::BookingId& bookingId) {
+    std::string out;
+    hms::StringSink sink{out};
+    hms::JsonWriter<hms::StringSink> w(sink, -1);
+    w.beginObject();
+    w.key("op");
+    w.string("del");
+    w.key("bookingId");
+    w.string(bookingId);
+    w.endObject();
+    return out;
+}
+
+bool newestFirst(const hms::Booking& a, const hms::Booking& b) {
+    return hms::NewestFirst{}(hms::BookingCursor{a.createdAt, a.bookingId},
+                              hms::BookingCursor{b.createdAt, b.bookingId});
+}
+
 bool ensureParentDir(const fs::path& p) {
     try {
         auto dir = p.parent_path();
@@ -44,102 +191,735 @@ BookingRepository::path_t BookingRepository::defaultPath() {
 }
 
 BookingRepository::BookingRepository(path_t path)
-        : path_(std::move(path)) {}
+        : path_(std::move(path)) {
+    addShard("");
+}
+
+void BookingRepository::setSharded(bool sharded) {
+    const std::unique_lock lock(shardsMutex_);
+    sharded_ = sharded;
+    shards_.clear();
+    if (!sharded_) addShard("");
+}
+
+BookingRepository::path_t BookingRepository::shardDirectory() const {
+    return path_.parent_path() / path_.stem();
+}
+
+std::size_t BookingRepository::shardCount() const {
+    const ShardsLock shards(shardsMutex_);
+    return shards_.size();
+}
+
+// Hotel ids become file names, so anything but [A-Za-z0-9_-] is replaced.
+// Ids that collide after that share a shard, which is harmless: every
+// per-hotel query still filters on hotelId.
+std::string BookingRepository::shardKey(const HotelId& hotelId) const {
+    if (!sharded_) return {};
+    std::string key{std::string_view(hotelId)};
+    for (auto& ch : key) {
+        const bool plain = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+                           (ch >= '0' && ch <= '9') || ch == '-' || ch == '_';
+        if (!plain) ch = '_';
+    }
+    return key.empty() ? "_" : key;
+}
+
+BookingRepository::Shard* BookingRepository::findShard(const HotelId& hotelId) const {
+    auto it = shards_.find(shardKey(hotelId));
+    return it == shards_.end() ? nullptr : it->second.get();
+}
+
+BookingRepository::Shard& BookingRepository::addShard(const std::string& key) {
+    auto& slot = shards_[key];
+    if (!slot) {
+        slot = std::make_unique<Shard>(sharded_ ? shardDirectory() / (key + ".json") : path_);
+        slot->journaled = journaled_ && !loading_;
+    }
+    return *slot;
+}
+
+BookingRepository::Shard& BookingRepository::shardFor(const HotelId& hotelId, ShardsLock& shards) {
+    if (auto* shard = findShard(hotelId)) return *shard;
+    // First booking for this hotel: briefly take the map exclusively.
+    shards.unlock();
+    {
+        const std::unique_lock adding(shardsMutex_);
+        addShard(shardKey(hotelId));
+    }
+    shards.lock();
+    return *findShard(hotelId); // shards are only dropped by load()/setSharded()
+}
+
+BookingRepository::Shard* BookingRepository::shardHolding(const BookingId& bookingId, const Shard* skip) const {
+    for (const auto& [key, shard] : shards_) {
+        if (shard.get() == skip) continue;
+        const std::shared_lock lock(shard->mutex);
+        if (shard->byId.count(bookingId) != 0) return shard.get();
+    }
+    return nullptr;
+}
 
 bool BookingRepository::load() {
-    items_.clear();
+    HMS_SCOPED_LATENCY("bookings.load");
+    const std::unique_lock lock(shardsMutex_);
+    shards_.clear();
     if (!ensureParentDir(path_)) return false;
 
-    if (!fs::exists(path_)) {
-        std::ofstream out(path_, std::ios::trunc);
-        if (!out.good()) return false;
-        out << "[]\n";
+    // Snapshot files and the journals to replay after them.
+    struct Source {
+        fs::path file;
+        Shard*   own{nullptr}; // the file's own shard; null while migrating
+        std::uint64_t generation{0};
+    };
+    std::vector<Source> sources;
+    bool migrating = false;
+    recovery_ = {};
+    loading_ = true;
+    const auto loaded = [&] {
+        if (!sharded_) {
+            auto& shard = addShard("");
+            if (!fs::exists(path_)) {
+                std::ofstream out(path_, std::ios::trunc);
+                if (!out.good()) return false;
+                out << "[]\n";
+            }
+            else if (!readBookings(path_, kFormatVersion, shard.items, &shard.journalGeneration)) {
+                return false;
+            }
+            shard.reindex();
+            sources.push_back({path_, &shard, shard.journalGeneration});
+            return true;
+        }
+
+        const auto dir = shardDirectory();
+        std::error_code ec;
+        std::vector<fs::path> files;
+        if (fs::is_directory(dir, ec)) {
+            std::set<fs::path> names;
+            for (const auto& entry : fs::directory_iterator(dir, ec)) {
+                if (!entry.is_regular_file(ec)) continue;
+                if (entry.path().extension() == ".json") names.insert(entry.path());
+                // A hotel whose first bookings are only in a journal yet.
+                else if (auto snapshot = journalSnapshot(entry.path())) names.insert(*snapshot);
+            }
+            if (ec) return false;
+            files.assign(names.begin(), names.end());
+        }
+        else {
+            // First start in sharded mode: split the single file; the next
+            // saveAll writes the shards.
+            if (!fs::create_directories(dir, ec)) return false;
+            if (fs::exists(path_)) files.push_back(path_);
+            migrating = true;
+        }
+
+        for (const auto& file : files) {
+            std::vector<Booking> loaded;
+            std::uint64_t generation = 0;
+            if (fs::exists(file) && !readBookings(file, kFormatVersion, loaded, &generation)) return false;
+            // A file normally holds exactly its own shard; anything else is
+            // moved to where it belongs and both files are rewritten.
+            Shard* own = migrating ? nullptr : &addShard(file.stem().string());
+            if (own) own->journalGeneration = generation;
+            for (auto& b : loaded) {
+                auto& target = addShard(shardKey(b.hotelId));
+                if (&target != own) {
+                    target.dirty = true;
+                    if (own) own->dirty = true;
+                }
+                target.items.push_back(std::move(b));
+            }
+            sources.push_back({file, own, generation});
+        }
+        for (auto& [key, shard] : shards_) shard->reindex();
         return true;
+    }();
+    if (!loaded) {
+        loading_ = false;
+        shards_.clear();
+        return false;
     }
 
-    std::ifstream in(path_);
-    if (!in.good()) return false;
+    // Journals hold changes made after their snapshot was written. When
+    // journaling stays on they remain the record of those changes; without
+    // it (or when migrating) the snapshots have to be rewritten.
+    std::map<const Shard*, bool> unsaved;
+    for (const auto& [key, shard] : shards_) unsaved[shard.get()] = shard->dirty;
+    for (const auto& source : sources) {
+        for (const auto& [generation, journal] : journalsOf(source.file)) {
+            if (generation < source.generation) continue; // already in the snapshot
+            if (!replayJournal(journal, source.own)) {
+                loading_ = false;
+                shards_.clear();
+                return false;
+            }
+            if (source.own) {
+                source.own->journalGeneration = generation;
+                source.own->journalBytes += fileSize(journal);
+                if (!journaled_) unsaved[source.own] = true;
+            }
+        }
+    }
+    loading_ = false;
+    for (auto& [key, shard] : shards_) {
+        shard->dirty = migrating || unsaved[shard.get()];
+        shard->journaled = journaled_;
+    }
+    return true;
+}
 
-    json doc;
-    try { in >> doc; }
-    catch (...) { return false; }
+bool BookingRepository::replayJournal(const path_t& file, Shard* own) {
+    HMS_COUNTER_ADD("bookings.bytesRead", fileSize(file));
+    std::string text;
+    {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) return false;
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (in.bad()) return false;
+    }
 
-    if (doc.is_null()) return true;
-    if (!doc.is_array()) return false;
+    for (std::size_t at = 0; at < text.size();) {
+        const auto end = text.find('\n', at);
+        const auto body = checkedRecord(std::string_view(text).substr(at, end == std::string::npos ? std::string::npos : end - at),
+                                        end != std::string::npos);
+        if (!body) {
+            // A torn or damaged record: it and everything after it in this
+            // file are dropped, and the file is cut back so appends resume
+            // after the last good record.
+            const std::string_view rest = std::string_view(text).substr(at);
+            const auto dropped = static_cast<std::size_t>(std::count(rest.begin(), rest.end(), '\n')) +
+                                 (rest.back() != '\n' ? 1 : 0);
+            recovery_.droppedRecords += dropped;
+            recovery_.droppedBytes += rest.size();
+            recovery_.truncatedFiles.push_back(file);
+            HMS_COUNTER_ADD("bookings.journalRecordsDropped", dropped);
+            std::error_code ec;
+            fs::resize_file(file, at, ec);
+            return !ec;
+        }
+        at = end + 1;
+        if (body->empty()) continue;
+        const auto record = json::parse(*body, nullptr, /*allow_exceptions=*/false);
+        if (!record.is_object() || !record.contains("op")) return false;
+        try {
+            if (record.at("op") == "del") {
+                const auto bookingId = record.at("bookingId").get<BookingId>();
+                for (auto& [key, shard] : shards_) {
+                    if (own && shard.get() != own) continue;
+                    auto it = shard->byId.find(bookingId);
+                    if (it != shard->byId.end()) shard->eraseAt(it->second);
+                }
+                continue;
+            }
+            if (record.at("op") != "put") return false;
+            const auto b = record.at("booking").get<Booking>();
+            // Copies left in other shards by a move are older; a newer copy
+            // elsewhere means this record was superseded.
+            auto& target = addShard(shardKey(b.hotelId));
+            bool superseded = false;
+            for (auto& [key, shard] : shards_) {
+                auto it = shard->byId.find(b.bookingId);
+                if (it == shard->byId.end() || shard.get() == &target) continue;
+                if (shard->items[it->second].version > b.version) superseded = true;
+                else shard->eraseAt(it->second);
+            }
+            if (!superseded) target.store(b, b.version);
+        }
+        catch (...) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    try {
-        items_ = doc.get<std::vector<Booking>>();
+void BookingRepository::setJournaled(bool journaled) {
+    const std::unique_lock lock(shardsMutex_);
+    journaled_ = journaled;
+    for (auto& [key, shard] : shards_) shard->journaled = journaled;
+}
+
+bool BookingRepository::saveAll() const {
+    HMS_SCOPED_LATENCY("bookings.saveAll");
+    const ShardsLock shards(shardsMutex_);
+    if (journaled_) {
+        // Everything else is in a journal already.
+        bool ok = true;
+        for (const auto& [key, shard] : shards_) {
+            if (shard->dirty && !compactShard(*shard)) ok = false;
+        }
+        return ok;
     }
-    catch (...) {
+    if (!sharded_) return saveShard(*shards_.begin()->second, /*onlyIfDirty=*/false);
+
+    std::error_code ec;
+    fs::create_directories(shardDirectory(), ec);
+    bool ok = true;
+    for (const auto& [key, shard] : shards_) {
+        if (!saveShard(*shard, /*onlyIfDirty=*/true)) ok = false;
+    }
+    return ok;
+}
+
+bool BookingRepository::saveShard(const Shard& shard, bool onlyIfDirty) const {
+    const std::lock_guard saving(shard.saveMutex); // one writer of the temp file at a time
+    const std::shared_lock lock(shard.mutex);
+    // Writers need the lock exclusively, so nothing can slip in between
+    // clearing the flag and writing the file.
+    if (!shard.dirty.exchange(false) && onlyIfDirty) return true;
+
+    std::uint64_t bytes = 0;
+    if (!writeSnapshot(shard.path, shard.items, std::nullopt, bytes)) {
+        shard.dirty = true;
         return false;
     }
+    HMS_COUNTER_ADD("bookings.bytesWritten", bytes);
+    if (shard.journalBytes != 0) {
+        // Journals replayed by load() while journaling is off: the snapshot
+        // has their changes now.
+        for (const auto& [generation, journal] : journalsOf(shard.path)) {
+            std::error_code ec;
+            fs::remove(journal, ec);
+        }
+        shard.journalBytes = 0;
+    }
     return true;
 }
 
-bool BookingRepository::saveAll() const {
-    if (!ensureParentDir(path_)) return false;
+bool BookingRepository::writeSnapshot(const path_t& file, const std::vector<Booking>& items,
+                                      std::optional<std::uint64_t> journalGeneration,
+                                      std::uint64_t& bytes) const {
+    if (!ensureParentDir(file)) return false;
+    // Streamed straight from the models: no DOM and no whole-file string.
+    // Items still pending are decoded one booking at a time while writing;
+    // one that cannot be decoded aborts the save and keeps the old file.
+    return writeFileAtomically(file, [&](FileSink& sink) {
+        try {
+            if (formatVersion_ == 1 && !journalGeneration) {
+                JsonWriter<FileSink> writer(sink, indentFor(style_), VariantLayout::Nested);
+                writeJson(writer, items);
+                return;
+            }
+            JsonWriter<FileSink> writer(sink, indentFor(style_));
+            writer.beginObject();
+            writer.key("formatVersion");
+            writer.integer(journalGeneration ? kFormatVersion : formatVersion_);
+            if (journalGeneration) {
+                writer.key("journal");
+                writer.integer(*journalGeneration);
+            }
+            writer.key("bookings");
+            writeJson(writer, items);
+            writer.endObject();
+        }
+        catch (...) {
+            sink.fail();
+        }
+    }, bytes);
+}
 
-    const fs::path tmp = path_.string() + ".tmp";
-    json arr = json::array();
-    for (const auto& b : items_) arr.push_back(b);
+bool BookingRepository::compact() {
+    HMS_SCOPED_LATENCY("bookings.compact");
+    if (!journaled_) return saveAll();
+    const ShardsLock shards(shardsMutex_);
+    bool ok = true;
+    for (const auto& [key, shard] : shards_) {
+        if (!compactShard(*shard)) ok = false;
+    }
+    return ok;
+}
 
+bool BookingRepository::compactShard(Shard& shard) const {
+    const std::lock_guard saving(shard.saveMutex); // one compaction per shard at a time
+    std::vector<Booking> view;
+    std::uint64_t generation = 0;
     {
-        std::ofstream out(tmp, std::ios::trunc);
-        if (!out.good()) return false;
-        out << arr.dump(2) << '\n';
-        out.flush();
-        if (!out.good()) return false;
+        // Shared is enough: writers (the only users of the journal) are
+        // shut out, readers are not.
+        const std::shared_lock lock(shard.mutex);
+        if (!shard.dirty && shard.journalBytes == 0) return true;
+        view = shard.items;
+        generation = shard.journalGeneration + 1;
+        shard.journalFile.reset();
+        shard.journalGeneration = generation;
+        shard.journalBroken = false;
+        shard.journalBytes = 0;
+        shard.dirty = false;
     }
 
-    std::error_code ec;
-    fs::rename(tmp, path_, ec);
-    if (ec) {
-        fs::remove(tmp);
+    std::uint64_t bytes = 0;
+    if (!writeSnapshot(shard.path, view, generation, bytes)) {
+        shard.dirty = true; // the old snapshot and every journal are still in place
         return false;
     }
+    HMS_COUNTER_ADD("bookings.bytesWritten", bytes);
+    HMS_COUNTER_ADD("bookings.snapshotBytesWritten", bytes);
+    for (const auto& [covered, journal] : journalsOf(shard.path)) {
+        std::error_code ec;
+        if (covered < generation) fs::remove(journal, ec);
+    }
     return true;
 }
 
-std::optional<Booking> BookingRepository::get(const std::string& bookingId) const {
-    auto it = std::find_if(items_.begin(), items_.end(),
-                           [&](const Booking& b){ return b.bookingId == bookingId; });
-    if (it == items_.end()) return std::nullopt;
-    return *it;
+std::uint64_t BookingRepository::journalBytes() const {
+    const ShardsLock shards(shardsMutex_);
+    std::uint64_t total = 0;
+    for (const auto& [key, shard] : shards_) total += shard->journalBytes;
+    return total;
+}
+
+bool BookingRepository::setFormatVersion(int version) {
+    if (version < 1 || version > kFormatVersion) return false;
+    formatVersion_ = version;
+    return true;
+}
+
+void BookingRepository::Shard::reindex() {
+    byId.clear();
+    byCreated.clear();
+    byGuest.clear();
+    highestIdSuffix = 0;
+
+    // Keep the last occurrence of a duplicated bookingId, like repeated upserts would.
+    std::vector<Booking> unique;
+    unique.reserve(items.size());
+    for (auto& b : items) {
+        if (b.version == 0) b.version = 1; // files from before versioning
+        auto found = byId.find(b.bookingId);
+        if (found != byId.end()) {
+            indexErase(unique[found->second]);
+            unique[found->second] = std::move(b);
+            indexInsert(unique[found->second], found->second);
+            continue;
+        }
+        unique.push_back(std::move(b));
+        indexInsert(unique.back(), unique.size() - 1);
+    }
+    items = std::move(unique);
+}
+
+void BookingRepository::Shard::indexInsert(const Booking& b, std::size_t pos) {
+    byId[b.bookingId] = pos;
+    byCreated.insert(BookingCursor{b.createdAt, b.bookingId});
+    byGuest[b.primaryGuestId].insert(BookingCursor{b.createdAt, b.bookingId});
+    highestIdSuffix = std::max(highestIdSuffix, idSuffix(b.bookingId));
+}
+
+void BookingRepository::Shard::indexErase(const Booking& b) {
+    byId.erase(b.bookingId);
+    byCreated.erase(BookingCursor{b.createdAt, b.bookingId});
+    auto guest = byGuest.find(b.primaryGuestId);
+    if (guest != byGuest.end()) {
+        guest->second.erase(BookingCursor{b.createdAt, b.bookingId});
+        if (guest->second.empty()) byGuest.erase(guest);
+    }
+}
+
+void BookingRepository::Shard::store(const Booking& b, std::uint64_t version) {
+    auto it = byId.find(b.bookingId);
+    std::size_t pos = 0;
+    if (it == byId.end()) {
+        items.push_back(b);
+        pos = items.size() - 1;
+    }
+    else {
+        pos = it->second;
+        indexErase(items[pos]);
+        items[pos] = b;
+    }
+    items[pos].version = version;
+    indexInsert(items[pos], pos);
+    if (journaled) journal(putRecord(items[pos]));
+    else dirty = true;
+}
+
+void BookingRepository::Shard::eraseAt(std::size_t pos) {
+    if (journaled) journal(deleteRecord(items[pos].bookingId));
+    else dirty = true;
+    indexErase(items[pos]);
+    items.erase(items.begin() + static_cast<std::ptrdiff_t>(pos));
+    for (auto& entry : byId) {
+        if (entry.second > pos) --entry.second;
+    }
+}
+
+void BookingRepository::Shard::journal(std::string_view record) {
+    if (journalBroken) {
+        dirty = true;
+        return;
+    }
+    if (!journalFile) {
+        if (!ensureParentDir(path)) {
+            journalBroken = true;
+        }
+        else {
+            journalFile.reset(std::fopen(journalPath(path, journalGeneration).string().c_str(), "ab"));
+        }
+    }
+    // Flushed to the OS per record, so a crashed process loses nothing it
+    // reported as written. A power loss can still tear the last records;
+    // the checksum lets load() find where they start.
+    const std::string line = checksummedLine(record);
+    const bool written = journalFile &&
+                         std::fwrite(line.data(), 1, line.size(), journalFile.get()) == line.size() &&
+                         std::fflush(journalFile.get()) == 0;
+    if (!written) {
+        // Whatever reached the file is superseded by the next snapshot.
+        journalBroken = true;
+        journalFile.reset();
+        dirty = true;
+        HMS_COUNTER_ADD("bookings.journalErrors", 1);
+        return;
+    }
+    journalBytes += line.size();
+    HMS_COUNTER_ADD("bookings.journalBytesWritten", line.size());
+}
+
+std::optional<Booking> BookingRepository::get(const BookingId& bookingId) const {
+    HMS_SCOPED_LATENCY("bookings.get");
+    const ShardsLock shards(shardsMutex_);
+    for (const auto& [key, shard] : shards_) {
+        const std::shared_lock lock(shard->mutex);
+        auto it = shard->byId.find(bookingId);
+        if (it != shard->byId.end()) return shard->items[it->second];
+    }
+    return std::nullopt;
+}
+
+std::uint64_t BookingRepository::write(const Booking& b, std::optional<std::uint64_t> expectedVersion,
+                                       ShardsLock& shards) {
+    auto& target = shardFor(b.hotelId, shards);
+    for (;;) {
+        // Usually the booking is new or already in its hotel's shard. If the
+        // hotel changed, both shards are locked so the move is atomic.
+        bool inTarget = false;
+        {
+            const std::shared_lock peek(target.mutex);
+            inTarget = target.byId.count(b.bookingId) != 0;
+        }
+        Shard* previous = sharded_ && !inTarget ? shardHolding(b.bookingId, &target) : nullptr;
+        std::unique_lock targetLock(target.mutex, std::defer_lock);
+        std::unique_lock<std::shared_mutex> previousLock;
+        if (previous) {
+            previousLock = std::unique_lock(previous->mutex, std::defer_lock);
+            std::lock(targetLock, previousLock);
+        }
+        else {
+            targetLock.lock();
+        }
+
+        Shard* holder = target.byId.count(b.bookingId) != 0 ? &target : nullptr;
+        if (!holder && previous) {
+            if (previous->byId.count(b.bookingId) == 0) continue; // moved again meanwhile
+            holder = previous;
+        }
+        const std::uint64_t stored = holder ? holder->items[holder->byId.at(b.bookingId)].version : 0;
+        if (expectedVersion && *expectedVersion != stored) {
+            HMS_COUNTER_ADD("bookings.writeConflicts", 1);
+            return 0;
+        }
+        const std::uint64_t version = (holder ? stored : b.version) + 1;
+        // Put before delete, so a crash between the two journal appends
+        // leaves a copy (the newer one wins on replay), never none.
+        target.store(b, version);
+        if (holder && holder != &target) holder->eraseAt(holder->byId.at(b.bookingId));
+        return version;
+    }
 }
 
 bool BookingRepository::upsert(const Booking& b) {
+    HMS_SCOPED_LATENCY("bookings.upsert");
+    if (b.bookingId.empty()) return false;
+    ShardsLock shards(shardsMutex_);
+    return write(b, std::nullopt, shards) != 0;
+}
+
+bool BookingRepository::upsertIfUnchanged(Booking& b) {
+    HMS_SCOPED_LATENCY("bookings.upsert");
     if (b.bookingId.empty()) return false;
-    auto it = std::find_if(items_.begin(), items_.end(),
-                           [&](const Booking& x){ return x.bookingId == b.bookingId; });
-    if (it == items_.end()) items_.push_back(b);
-    else                    *it = b;
+    ShardsLock shards(shardsMutex_);
+    const auto version = write(b, b.version, shards);
+    if (version == 0) return false;
+    b.version = version;
     return true;
 }
 
-bool BookingRepository::remove(const std::string& bookingId) {
-    auto it = std::remove_if(items_.begin(), items_.end(),
-                             [&](const Booking& x){ return x.bookingId == bookingId; });
-    if (it == items_.end()) return false;
-    items_.erase(it, items_.end());
+bool BookingRepository::erase(const BookingId& bookingId, std::optional<std::uint64_t> expectedVersion) {
+    const ShardsLock shards(shardsMutex_);
+    for (;;) {
+        Shard* holder = shardHolding(bookingId, nullptr);
+        if (!holder) return false;
+        const std::unique_lock lock(holder->mutex);
+        auto it = holder->byId.find(bookingId);
+        if (it == holder->byId.end()) continue; // moved to another shard meanwhile
+        if (expectedVersion && holder->items[it->second].version != *expectedVersion) {
+            HMS_COUNTER_ADD("bookings.writeConflicts", 1);
+            return false;
+        }
+        holder->eraseAt(it->second);
+        return true;
+    }
+}
+
+bool BookingRepository::remove(const BookingId& bookingId) {
+    HMS_SCOPED_LATENCY("bookings.remove");
+    return erase(bookingId, std::nullopt);
+}
+
+bool BookingRepository::removeIfUnchanged(const Booking& b) {
+    HMS_SCOPED_LATENCY("bookings.remove");
+    return erase(b.bookingId, b.version);
+}
+
+bool BookingRepository::archiveClosed(BookingArchive& archive, std::int64_t closedBefore, std::size_t& moved) {
+    HMS_SCOPED_LATENCY("bookings.archiveClosed");
+    moved = 0;
+    const ShardsLock shards(shardsMutex_);
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    for (const auto& [key, shard] : shards_) locks.emplace_back(shard->mutex);
+
+    std::optional<BookingId> newest;
+    int newestSuffix = -1;
+    for (const auto& [key, shard] : shards_) {
+        for (const auto& b : shard->items) {
+            if (idSuffix(b.bookingId) > newestSuffix) {
+                newestSuffix = idSuffix(b.bookingId);
+                newest = b.bookingId;
+            }
+        }
+    }
+    const auto cold = [&](const Booking& b) {
+        const bool closed = b.status == BookingStatus::CHECKED_OUT || b.status == BookingStatus::CANCELLED;
+        return closed && b.bookingId != newest && std::max(b.createdAt, b.updatedAt) < closedBefore;
+    };
+
+    std::vector<Booking> archived;
+    for (const auto& [key, shard] : shards_) {
+        std::copy_if(shard->items.begin(), shard->items.end(), std::back_inserter(archived), cold);
+    }
+    if (archived.empty()) return true;
+    const std::size_t count = archived.size();
+    if (!archive.append(std::move(archived))) return false;
+
+    for (auto& [key, shard] : shards_) {
+        const int highest = shard->highestIdSuffix;
+        const auto before = shard->items.size();
+        if (shard->journaled) {
+            for (const auto& b : shard->items) {
+                if (cold(b)) shard->journal(deleteRecord(b.bookingId));
+            }
+        }
+        std::erase_if(shard->items, cold);
+        if (shard->items.size() == before) continue;
+        shard->reindex();
+        shard->highestIdSuffix = highest;
+        if (!shard->journaled) shard->dirty = true;
+    }
+    moved = count;
+    HMS_COUNTER_ADD("bookings.archived", moved);
     return true;
 }
 
+BookingId BookingRepository::nextBookingId() const {
+    HMS_SCOPED_LATENCY("bookings.nextBookingId");
+    const std::lock_guard issuing(idMutex_);
+    const ShardsLock shards(shardsMutex_);
+    int maxValue = lastIssuedId_; // handed out but maybe not upserted yet
+    for (const auto& [key, shard] : shards_) {
+        const std::shared_lock lock(shard->mutex);
+        maxValue = std::max(maxValue, shard->highestIdSuffix);
+    }
+
+    lastIssuedId_ = maxValue + 1;
+    std::ostringstream oss;
+    oss << "BKG-" << std::setw(6) << std::setfill('0') << lastIssuedId_;
+    return oss.str();
+}
+
+std::size_t BookingRepository::count() const {
+    const ShardsLock shards(shardsMutex_);
+    std::size_t total = 0;
+    for (const auto& [key, shard] : shards_) {
+        const std::shared_lock lock(shard->mutex);
+        total += shard->items.size();
+    }
+    return total;
+}
+
 std::vector<Booking> BookingRepository::list() const {
-    return items_;
+    HMS_SCOPED_LATENCY("bookings.list");
+    const ShardsLock shards(shardsMutex_);
+    std::vector<Booking> out;
+    for (const auto& [key, shard] : shards_) {
+        const std::shared_lock lock(shard->mutex);
+        out.insert(out.end(), shard->items.begin(), shard->items.end());
+    }
+    return out;
 }
 
 std::vector<Booking> BookingRepository::listActive() const {
+    HMS_SCOPED_LATENCY("bookings.listActive");
+    const ShardsLock shards(shardsMutex_);
     std::vector<Booking> out;
-    std::copy_if(items_.begin(), items_.end(), std::back_inserter(out),
-                 [](const Booking& b){ return b.status == BookingStatus::ACTIVE; });
+    for (const auto& [key, shard] : shards_) {
+        const std::shared_lock lock(shard->mutex);
+        std::copy_if(shard->items.begin(), shard->items.end(), std::back_inserter(out),
+                     [](const Booking& b){ return b.status == BookingStatus::ACTIVE; });
+    }
     return out;
 }
 
-std::vector<Booking> BookingRepository::listByHotel(const std::string& hotelId) const {
+std::vector<Booking> BookingRepository::listByHotel(const HotelId& hotelId) const {
+    HMS_SCOPED_LATENCY("bookings.listByHotel");
+    const ShardsLock shards(shardsMutex_);
     std::vector<Booking> out;
-    std::copy_if(items_.begin(), items_.end(), std::back_inserter(out),
+    const Shard* shard = findShard(hotelId);
+    if (!shard) return out;
+    const std::shared_lock lock(shard->mutex);
+    std::copy_if(shard->items.begin(), shard->items.end(), std::back_inserter(out),
                  [&](const Booking& b){ return b.hotelId == hotelId; });
     return out;
 }
 
+BookingPage BookingRepository::listPage(const std::optional<BookingCursor>& after,
+                                        std::size_t limit) const {
+    HMS_SCOPED_LATENCY("bookings.listPage");
+    const ShardsLock shards(shardsMutex_);
+    BookingPage page;
+    if (limit == 0) return page;
+
+    // Up to limit + 1 rows from each shard: enough for the page and to
+    // tell whether another one follows.
+    for (const auto& [key, shard] : shards_) {
+        const std::shared_lock lock(shard->mutex);
+        auto it = after ? shard->byCreated.upper_bound(*after) : shard->byCreated.begin();
+        for (std::size_t taken = 0; it != shard->byCreated.end() && taken <= limit; ++it, ++taken) {
+            page.items.push_back(shard->items[shard->byId.at(it->bookingId)]);
+        }
+    }
+    std::sort(page.items.begin(), page.items.end(), newestFirst);
+    if (page.items.size() > limit) {
+        page.items.resize(limit);
+        const auto& last = page.items.back();
+        page.next = BookingCursor{last.createdAt, last.bookingId};
+    }
+    return page;
+}
+
+std::vector<Booking> BookingRepository::listByGuest(const UserId& guestId) const {
+    HMS_SCOPED_LATENCY("bookings.listByGuest");
+    const ShardsLock shards(shardsMutex_);
+    std::vector<Booking> out;
+    for (const auto& [key, shard] : shards_) {
+        const std::shared_lock lock(shard->mutex);
+        auto guest = shard->byGuest.find(guestId);
+        if (guest == shard->byGuest.end()) continue;
+        for (const auto& k : guest->second) {
+            out.push_back(shard->items[shard->byId.at(k.bookingId)]);
+        }
+    }
+    if (shards_.size() > 1) std::sort(out.begin(), out.end(), newestFirst);
+    return out;
+}
+
 }
@@ -1,39 +1,270 @@
 #pragma once
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <optional>
+#include <atomic>
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
 #include "../models/Booking.h"
+#include "FileSink.h"
 
 namespace hms {
 
+    class BookingArchive;
+
+    // Keyset cursor for newest-first paging. Rows are ordered by createdAt
+    // descending, ties broken by bookingId descending, so the key is stable
+    // even when new bookings arrive between page fetches.
+    struct BookingCursor {
+        std::int64_t createdAt{0};
+        BookingId    bookingId;
+    };
+
+    // Strict weak ordering for BookingCursor keys: newest first.
+    struct NewestFirst {
+        bool operator()(const BookingCursor& a, const BookingCursor& b) const {
+            if (a.createdAt != b.createdAt) return a.createdAt > b.createdAt;
+            return a.bookingId > b.bookingId;
+        }
+    };
+
+    struct BookingPage {
+        std::vector<Booking>         items;
+        std::optional<BookingCursor> next; // set when more rows follow this page
+    };
+
+    // Safe to share between threads (server mode): queries take shared
+    // locks and return copies, writes and load() take them exclusively.
+    //
+    // Bookings are kept in shards, each with its own lock and indexes. By
+    // default there is one shard stored in resolvedPath(). In sharded mode
+    // (setSharded) every hotel gets its own shard and file, so writes for
+    // one hotel neither wait for nor rewrite another hotel's bookings.
+    // listByHotel reads one shard; cross-hotel queries fan out over all of
+    // them and merge.
     class BookingRepository {
     public:
         using path_t = std::filesystem::path;
 
+        // bookings.json layouts:
+        //   1: [ booking, ... ] with items as {"kind": "...", "value": {...}}
+        //   2: {"formatVersion": 2, "bookings": [ ... ]} with flat items
+        //      tagged by alternative index ({"t": 1, "lineId": ...})
+        // load() reads both; saveAll() writes kFormatVersion unless told otherwise.
+        static constexpr int kFormatVersion = 2;
+
+        // Attempts update() makes before giving up on a busy booking.
+        static constexpr int kUpdateAttempts = 8;
+
         explicit BookingRepository(path_t path = defaultPath());
 
         // Disk I/O
         bool load();          // read JSON -> memory (creates file if missing)
-        bool saveAll() const; // memory -> JSON (atomic via temp+rename)
+        bool saveAll() const; // memory -> JSON (atomic via temp+rename); see setJournaled
 
-        // CRUD (in-memory; caller decides when to saveAll)
-        std::optional<Booking> get(const std::string& bookingId) const;
+        // CRUD (in-memory; caller decides when to saveAll). upsert and
+        // remove are unconditional: the last writer wins.
+        std::optional<Booking> get(const BookingId& bookingId) const;
         bool upsert(const Booking& b);
-        bool remove(const std::string& bookingId);
+        bool remove(const BookingId& bookingId);
+
+        // Optimistic concurrency. Every stored booking carries a version
+        // (1 or more) that each write bumps. A session that read version N
+        // may write back only while the booking is still at N, so two
+        // sessions editing the same booking cannot silently overwrite each
+        // other, and nobody holds a lock while a user is typing.
+        //
+        // upsertIfUnchanged stores `b` only if the stored booking is at
+        // b.version (0: no booking with that id may exist yet) and then
+        // sets b.version to the new stored version. False on a conflict or
+        // an empty id; nothing is written then.
+        bool upsertIfUnchanged(Booking& b);
+        // Removes the booking only if it is still at b.version.
+        bool removeIfUnchanged(const Booking& b);
+
+        // Read-modify-write with retries: reads the current booking, lets
+        // `change(Booking&)` edit it and stores it with upsertIfUnchanged,
+        // starting again from a fresh read when another session wrote in
+        // between. `change` may therefore run more than once; it returns
+        // false to give up. The stored booking, or std::nullopt if the id
+        // is unknown, `change` gave up, or every attempt conflicted.
+        template <typename Change>
+        std::optional<Booking> update(const BookingId& bookingId, Change&& change,
+                                      int attempts = kUpdateAttempts);
 
         // Convenience queries
         std::vector<Booking> list() const;
         std::vector<Booking> listActive() const;
-        std::vector<Booking> listByHotel(const std::string& hotelId) const;
+        std::vector<Booking> listByHotel(const HotelId& hotelId) const;
+        std::size_t          count() const;
+        // "BKG-" + (highest numeric suffix + 1), zero-padded. Never returns
+        // the same id twice, so concurrent sessions creating bookings do
+        // not collide.
+        BookingId            nextBookingId() const;
+
+        // Ordered views (newest first), served from indexes kept up to date on
+        // every write. listPage: pass std::nullopt for the first page and the
+        // returned `next` cursor for the following ones.
+        BookingPage          listPage(const std::optional<BookingCursor>& after, std::size_t limit) const;
+        std::vector<Booking> listByGuest(const UserId& guestId) const; // newest first
+
+        // Hot/cold tiering: moves checked-out and cancelled bookings last
+        // updated before `closedBefore` (epoch seconds) into a new segment
+        // of `archive` and drops them here; the next saveAll() shrinks the
+        // files. Every shard is held exclusively while the segment is
+        // written, so nothing archived can change meanwhile. The booking
+        // with the highest id always stays, so nextBookingId keeps counting
+        // past archived ones. `moved` receives the number archived; false
+        // (and nothing dropped) when the archive cannot be written.
+        bool archiveClosed(BookingArchive& archive, std::int64_t closedBefore, std::size_t& moved);
 
         // Paths
         static path_t defaultPath();                 //../src/data/bookings.json (normalized)
         const path_t& resolvedPath() const { return path_; }
 
+        // Layout written by saveAll; Pretty unless set.
+        void      setJsonStyle(JsonStyle style) { style_ = style; }
+        JsonStyle jsonStyle() const { return style_; }
+
+        // Format written by saveAll; 1 keeps files readable by older builds.
+        // False (and unchanged) for versions this build cannot write.
+        bool setFormatVersion(int version);
+        int  formatVersion() const { return formatVersion_; }
+
+        // One file per hotel under shardDirectory() instead of a single
+        // file; set before load(). When the directory does not exist yet,
+        // load() reads resolvedPath() and the next saveAll() writes it out
+        // as shards (the single file is left as it is). In sharded mode
+        // saveAll() only rewrites shards changed since the last save.
+        void   setSharded(bool sharded);
+        bool   sharded() const { return sharded_; }
+        path_t shardDirectory() const; // "bookings/" next to resolvedPath()
+        std::size_t shardCount() const;
+
+        // Write-ahead journal; set before load(). Each write is appended to
+        // its shard's journal ("<file>.journal.<n>") as it happens, so
+        // saveAll() only has to write shards whose journal failed. load()
+        // reads each snapshot file and replays the journals written after
+        // it. Journaled snapshots are always written in format 2.
+        void setJournaled(bool journaled);
+        bool journaled() const { return journaled_; }
+
+        // Folds the journals into new snapshot files without stopping
+        // writers. Per shard: a copy of its bookings is taken and writes
+        // switch to a fresh journal under one shared lock (readers carry on,
+        // writers wait only for the copy); the snapshot is then encoded and
+        // written with no lock held, renamed over the old one, and the
+        // journals it covers are deleted. A crash at any point leaves a
+        // snapshot plus journals that load() replays to the same state.
+        // Safe to call from any thread; shards without journal entries or
+        // unsaved changes are skipped.
+        bool          compact();
+        std::uint64_t journalBytes() const; // appended since the last compaction
+
+        // What the last load() dropped to get past damaged journal records.
+        // Every journal line carries a checksum; the first line that is
+        // torn (a crash mid-append) or fails its checksum ends the replay
+        // of that file, which is cut back to the last good record.
+        struct Recovery {
+            std::size_t         droppedRecords{0};
+            std::uint64_t       droppedBytes{0};
+            std::vector<path_t> truncatedFiles;
+        };
+        const Recovery& lastRecovery() const { return recovery_; }
+
     private:
+        using OrderIndex = std::set<BookingCursor, NewestFirst>;
+
+        // One partition of the bookings with its own lock, file and indexes.
+        struct Shard {
+            explicit Shard(path_t file) : path(std::move(file)) {}
+
+            struct FileCloser {
+                void operator()(std::FILE* file) const { std::fclose(file); }
+            };
+
+            // Callers hold `mutex` exclusively.
+            void reindex();
+            void indexInsert(const Booking& b, std::size_t pos);
+            void indexErase(const Booking& b);
+            void store(const Booking& b, std::uint64_t version);
+            void eraseAt(std::size_t pos);
+            // Appends one line to the live journal; once an append has
+            // failed, marks the shard dirty instead until the next compaction.
+            void journal(std::string_view record);
+
+            mutable std::shared_mutex mutex;
+            mutable std::mutex        saveMutex; // one save (and temp file) at a time
+            path_t                    path;
+            std::vector<Booking>      items;     // file order
+
+            std::unordered_map<BookingId, std::size_t> byId;  // bookingId -> position in items
+            OrderIndex byCreated;                             // newest first
+            std::unordered_map<UserId, OrderIndex> byGuest;   // primaryGuestId -> newest first
+            int        highestIdSuffix{0};                    // largest "BKG-<n>" indexed since load
+            mutable std::atomic<bool> dirty{false};           // changes in neither the file nor a journal
+
+            bool journaled{false};
+            bool journalBroken{false};                        // an append failed; no more until compacted
+            std::unique_ptr<std::FILE, FileCloser> journalFile; // opened on the first append
+            std::uint64_t journalGeneration{0};               // <n> of the live journal
+            mutable std::atomic<std::uint64_t> journalBytes{0}; // in journals the snapshot does not cover
+        };
+
+        using ShardsLock = std::shared_lock<std::shared_mutex>;
+
+        // These expect shardsMutex_ held (shared is enough; addShard and
+        // the shard-creating path of shardFor need it exclusively).
+        std::string shardKey(const HotelId& hotelId) const;
+        Shard*      findShard(const HotelId& hotelId) const;
+        Shard&      shardFor(const HotelId& hotelId, ShardsLock& shards);
+        Shard*      shardHolding(const BookingId& bookingId, const Shard* skip) const;
+        Shard&      addShard(const std::string& key);
+        // Stores `b` in its hotel's shard, taking it out of the shard that
+        // held it before if the hotel changed. With `expectedVersion`, only
+        // if the stored version (0: not stored) matches. The new version,
+        // or 0 on a conflict.
+        std::uint64_t write(const Booking& b, std::optional<std::uint64_t> expectedVersion, ShardsLock& shards);
+        bool          erase(const BookingId& bookingId, std::optional<std::uint64_t> expectedVersion);
+        bool          saveShard(const Shard& shard, bool onlyIfDirty) const;
+        bool          compactShard(Shard& shard) const;
+        bool          writeSnapshot(const path_t& file, const std::vector<Booking>& items,
+                                    std::optional<std::uint64_t> journalGeneration, std::uint64_t& bytes) const;
+        // Applies one journal file. Deletions only apply to `own` (when
+        // set): a booking that moved hotels is deleted from its old shard's
+        // journal after being put in the new one's.
+        bool          replayJournal(const path_t& file, Shard* own);
+
+    private:
+        mutable std::shared_mutex shardsMutex_;     // the shard map; exclusive to add shards or load
+        mutable std::mutex        idMutex_;
+        mutable int               lastIssuedId_{0}; // highest suffix nextBookingId returned
         path_t path_;
-        std::vector<Booking> items_;
+        JsonStyle style_{JsonStyle::Pretty};
+        int formatVersion_{kFormatVersion};
+        bool sharded_{false};
+        bool journaled_{false};
+        bool loading_{false};    // shards added while replaying journals do not journal yet
+        Recovery recovery_;
+        std::map<std::string, std::unique_ptr<Shard>> shards_; // by shardKey, so fan-outs run in hotel order
     };
 
+    template <typename Change>
+    std::optional<Booking> BookingRepository::update(const BookingId& bookingId, Change&& change, int attempts) {
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            auto current = get(bookingId);
+            if (!current || !change(*current)) return std::nullopt;
+            if (upsertIfUnchanged(*current)) return current;
+            std::this_thread::yield(); // let the competing writer finish
+        }
+        return std::nullopt;
+    }
+
 }
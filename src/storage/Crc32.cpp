@@ -0,0 +1,29 @@
+#include "Crc32.h"
+
+#include <array>
+
+namespace hms {
+
+namespace {
+
+constexpr std::array<std::uint32_t, 256> makeTable() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int bit = 0; bit < 8; ++bit) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+constexpr auto kTable = makeTable();
+
+}
+
+std::uint32_t crc32(std::string_view data, std::uint32_t crc) {
+    crc = ~crc;
+    for (const char ch : data) crc = kTable[(crc ^ static_cast<unsigned char>(ch)) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+namespace hms {
+
+    // CRC-32 (IEEE 802.3, as in zip and PNG) of `data`. Pass the previous
+    // result as `crc` to continue over data that arrives in pieces.
+    // Detects every torn tail and burst error up to 32 bits; used to check
+    // persisted records before trusting them.
+    std::uint32_t crc32(std::string_view data, std::uint32_t crc = 0);
+
+}
@@ -0,0 +1,63 @@
+#include "FileSink.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace hms {
+
+FileSink::FileSink(const std::filesystem::path& path, std::size_t bufferBytes)
+    : file_(std::fopen(path.string().c_str(), "wb")),
+      buffer_(new char[std::max<std::size_t>(bufferBytes, 64)]),
+      capacity_(std::max<std::size_t>(bufferBytes, 64)) {
+    if (file_ != nullptr) std::setvbuf(file_, nullptr, _IONBF, 0); // we buffer ourselves
+}
+
+FileSink::~FileSink() {
+    if (file_ != nullptr) std::fclose(file_);
+}
+
+void FileSink::direct(const char* data, std::size_t size) {
+    if (file_ == nullptr || failed_) return;
+    if (std::fwrite(data, 1, size, file_) != size) failed_ = true;
+    flushed_ += size;
+}
+
+void FileSink::drain() {
+    direct(buffer_.get(), used_);
+    used_ = 0;
+}
+
+bool FileSink::finish() {
+    if (file_ == nullptr) return false;
+    drain();
+    if (std::fflush(file_) != 0) failed_ = true;
+#if defined(_WIN32)
+    if (!failed_ && _commit(_fileno(file_)) != 0) failed_ = true;
+#else
+    if (!failed_ && ::fsync(::fileno(file_)) != 0) failed_ = true;
+#endif
+    if (std::fclose(file_) != 0) failed_ = true;
+    file_ = nullptr;
+    return !failed_;
+}
+
+bool syncDirectory(const std::filesystem::path& directory) {
+#if defined(_WIN32)
+    (void)directory; // no directory handles to flush here
+    return false;
+#else
+    const int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+namespace hms {
+
+    // Layout of JSON files written by the repositories. Pretty matches the
+    // historical dump(2) layout; Compact drops all optional whitespace.
+    enum class JsonStyle { Pretty, Compact };
+
+    inline int indentFor(JsonStyle style) { return style == JsonStyle::Pretty ? 2 : -1; }
+
+    // Write-only file with one fixed, large buffer: put/write are a memcpy
+    // into the buffer and the OS sees a handful of big writes. Memory use
+    // does not depend on how much is written. Errors are sticky; check
+    // finish().
+    class FileSink {
+    public:
+        static constexpr std::size_t kDefaultBufferBytes = std::size_t{1} << 20;
+
+        explicit FileSink(const std::filesystem::path& path, std::size_t bufferBytes = kDefaultBufferBytes);
+        ~FileSink();
+        FileSink(const FileSink&) = delete;
+        FileSink& operator=(const FileSink&) = delete;
+
+        void put(char c) {
+            if (used_ == capacity_) drain();
+            buffer_[used_++] = c;
+        }
+
+        void write(const char* data, std::size_t size) {
+            if (size > capacity_ - used_) {
+                drain();
+                if (size > capacity_) { direct(data, size); return; }
+            }
+            std::memcpy(buffer_.get() + used_, data, size);
+            used_ += size;
+        }
+
+        // Marks the output as unusable (e.g. the data turned out to be
+        // invalid halfway through); finish() then fails.
+        void fail() { failed_ = true; }
+
+        bool good() const { return file_ != nullptr && !failed_; }
+        std::uint64_t bytesWritten() const { return flushed_ + used_; }
+
+        // Flushes, forces the data to disk (so a rename that follows never
+        // exposes a half-written file after a power loss) and closes; false
+        // if anything failed along the way.
+        bool finish();
+
+    private:
+        void drain();
+        void direct(const char* data, std::size_t size);
+
+        std::FILE*              file_{nullptr};
+        std::unique_ptr<char[]> buffer_;
+        std::size_t             capacity_;
+        std::size_t             used_{0};
+        std::uint64_t           flushed_{0};
+        bool                    failed_{false};
+    };
+
+    // Makes a rename or removal in `directory` durable. Best effort: false
+    // where the platform cannot do it for directories.
+    bool syncDirectory(const std::filesystem::path& directory);
+
+    // Replaces `path` with whatever `body(FileSink&)` writes, plus a
+    // trailing newline: the data goes to "<path>.tmp" and is renamed over
+    // `path` only when every write succeeded. `bytesWritten` receives the
+    // file size.
+    template <typename Body>
+    bool writeFileAtomically(const std::filesystem::path& path, Body&& body, std::uint64_t& bytesWritten) {
+        const std::filesystem::path tmp = path.string() + ".tmp";
+        {
+            FileSink sink(tmp);
+            if (!sink.good()) return false;
+            std::forward<Body>(body)(sink);
+            sink.put('\n');
+            bytesWritten = sink.bytesWritten();
+            if (!sink.finish()) {
+                std::error_code ec;
+                std::filesystem::remove(tmp, ec);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        syncDirectory(path.parent_path());
+        return true;
+    }
+
+}
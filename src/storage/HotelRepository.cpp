@@ -1,8 +1,14 @@
 #include "HotelRepository.h"
+#include "Arena.h"
+#include "FileSink.h"
+#include "../models/Codec.h"
+#include "../diagnostics/Metrics.h"
 
 #include <algorithm>
 #include <fstream>
 #include <filesystem>
+#include <mutex>
+#include <shared_mutex>
 #include <system_error>
 
 #include <nlohmann/json.hpp>
@@ -20,6 +26,12 @@ fs::path baseDataDir() {
 #endif
 }
 
+std::uintmax_t fileSize(const fs::path& p) {
+    std::error_code ec;
+    const auto size = fs::file_size(p, ec);
+    return ec ? 0 : size;
+}
+
 bool ensureParentDir(const fs::path& p) {
     try {
         auto dir = p.parent_path();
@@ -33,21 +45,18 @@ bool ensureParentDir(const fs::path& p) {
     }
 }
 
-json toJson(const hms::Hotel& h) {
-    return json{
-        {"id", h.id},
-        {"name", h.name},
-        {"stars", h.stars},
-        {"address", h.address}
-    };
 }
 
-bool fromJson(const json& j, hms::Hotel& h) {
+namespace hms {
+
+json HotelRepository::toJson(const Hotel& h) {
+    return h; // Schema<Hotel>
+}
+
+template <typename Json>
+bool HotelRepository::fromJson(const Json& j, Hotel& h) {
     try {
-        h.id      = j.value("id", "");
-        h.name    = j.value("name", "");
-        h.stars   = static_cast<std::uint8_t>(j.value("stars", 0));
-        h.address = j.value("address", "");
+        j.get_to(h);
         return true;
     }
     catch (...) {
@@ -55,9 +64,8 @@ bool fromJson(const json& j, hms::Hotel& h) {
     }
 }
 
-}
-
-namespace hms {
+template bool HotelRepository::fromJson(const json&, Hotel&);
+template bool HotelRepository::fromJson(const ArenaJson&, Hotel&);
 
 HotelRepository::path_t HotelRepository::defaultPath() {
     return (baseDataDir() / "hotels.json").lexically_normal();
@@ -67,7 +75,10 @@ HotelRepository::HotelRepository(path_t path)
     : path_(std::move(path)) {}
 
 bool HotelRepository::load() {
+    HMS_SCOPED_LATENCY("hotels.load");
+    const std::unique_lock lock(mutex_);
     items_.clear();
+    reindex();
     if (!ensureParentDir(path_)) return false;
 
     if (!fs::exists(path_)) {
@@ -77,74 +88,137 @@ bool HotelRepository::load() {
         return true;
     }
 
-    std::ifstream in(path_);
-    if (!in.good()) return false;
+    HMS_COUNTER_ADD("hotels.bytesRead", fileSize(path_));
+    // The file text and the parsed DOM share one arena that is dropped as a
+    // whole once the records have been converted.
+    MonotonicArena arena;
+    const ArenaScope scope{arena};
+    const ArenaJson* doc = parseJsonFile(path_, arena);
+    if (doc == nullptr) return false;
 
-    json doc;
-    try { in >> doc; }
-    catch (...) { return false; }
+    if (doc->is_null()) return true;
+    if (!doc->is_array()) return false;
 
-    if (doc.is_null()) return true;
-    if (!doc.is_array()) return false;
-
-    for (const auto& j : doc) {
+    items_.reserve(doc->size());
+    for (const auto& j : *doc) {
         Hotel h{};
         if (fromJson(j, h)) {
             items_.push_back(std::move(h));
         }
     }
+    reindex();
     return true;
 }
 
 bool HotelRepository::saveAll() const {
+    HMS_SCOPED_LATENCY("hotels.saveAll");
+    const std::lock_guard saving(saveMutex_); // one writer of the temp file at a time
+    const std::shared_lock lock(mutex_);
     if (!ensureParentDir(path_)) return false;
 
-    const fs::path tmp = path_.string() + ".tmp";
-    json arr = json::array();
-    for (const auto& h : items_) arr.push_back(toJson(h));
+    // Streamed straight from the models: no DOM and no whole-file string.
+    std::uint64_t bytes = 0;
+    const bool ok = writeFileAtomically(path_, [&](FileSink& sink) {
+        JsonWriter<FileSink> writer(sink, indentFor(style_));
+        writeJson(writer, items_);
+    }, bytes);
+    if (ok) HMS_COUNTER_ADD("hotels.bytesWritten", bytes);
+    return ok;
+}
 
-    {
-        std::ofstream out(tmp, std::ios::trunc);
-        if (!out.good()) return false;
-        out << arr.dump(2) << '\n';
-        out.flush();
-        if (!out.good()) return false;
+void HotelRepository::reindex() {
+    byId_.clear();
+    byName_.clear();
+
+    // Keep the last occurrence of a duplicated id, like repeated upserts would.
+    std::vector<Hotel> unique;
+    unique.reserve(items_.size());
+    for (auto& h : items_) {
+        auto found = byId_.find(h.id);
+        if (found != byId_.end()) {
+            indexErase(unique[found->second]);
+            unique[found->second] = std::move(h);
+            indexInsert(unique[found->second], found->second);
+            continue;
+        }
+        unique.push_back(std::move(h));
+        indexInsert(unique.back(), unique.size() - 1);
     }
+    items_ = std::move(unique);
+}
 
-    std::error_code ec;
-    fs::rename(tmp, path_, ec);
-    if (ec) {
-        fs::remove(tmp);
-        return false;
-    }
-    return true;
+void HotelRepository::indexInsert(const Hotel& h, std::size_t pos) {
+    byId_[h.id] = pos;
+    byName_.emplace(h.name, h.id);
+}
+
+void HotelRepository::indexErase(const Hotel& h) {
+    byId_.erase(h.id);
+    byName_.erase({h.name, h.id});
 }
 
-std::optional<Hotel> HotelRepository::get(const std::string& id) const {
-    auto it = std::find_if(items_.begin(), items_.end(),
-                           [&](const Hotel& h){ return h.id == id; });
-    if (it == items_.end()) return std::nullopt;
-    return *it;
+std::optional<Hotel> HotelRepository::get(const HotelId& id) const {
+    HMS_SCOPED_LATENCY("hotels.get");
+    const std::shared_lock lock(mutex_);
+    auto it = byId_.find(id);
+    if (it == byId_.end()) return std::nullopt;
+    return items_[it->second];
 }
 
 bool HotelRepository::upsert(const Hotel& h) {
-    auto it = std::find_if(items_.begin(), items_.end(),
-                           [&](const Hotel& x){ return x.id == h.id; });
-    if (it == items_.end()) items_.push_back(h);
-    else                    *it = h;
+    HMS_SCOPED_LATENCY("hotels.upsert");
+    const std::unique_lock lock(mutex_);
+    auto it = byId_.find(h.id);
+    if (it == byId_.end()) {
+        items_.push_back(h);
+        indexInsert(items_.back(), items_.size() - 1);
+        return true;
+    }
+
+    const std::size_t pos = it->second;
+    indexErase(items_[pos]);
+    items_[pos] = h;
+    indexInsert(items_[pos], pos);
     return true;
 }
 
-bool HotelRepository::remove(const std::string& id) {
-    auto it = std::remove_if(items_.begin(), items_.end(),
-                             [&](const Hotel& x){ return x.id == id; });
-    if (it == items_.end()) return false;
-    items_.erase(it, items_.end());
+bool HotelRepository::remove(const HotelId& id) {
+    HMS_SCOPED_LATENCY("hotels.remove");
+    const std::unique_lock lock(mutex_);
+    auto it = byId_.find(id);
+    if (it == byId_.end()) return false;
+
+    const std::size_t pos = it->second;
+    indexErase(items_[pos]);
+    items_.erase(items_.begin() + static_cast<std::ptrdiff_t>(pos));
+    for (auto& entry : byId_) {
+        if (entry.second > pos) --entry.second;
+    }
     return true;
 }
 
 std::vector<Hotel> HotelRepository::list() const {
+    HMS_SCOPED_LATENCY("hotels.list");
+    const std::shared_lock lock(mutex_);
     return items_;
 }
 
+std::vector<Hotel> HotelRepository::listOrderedById() const {
+    HMS_SCOPED_LATENCY("hotels.listOrderedById");
+    const std::shared_lock lock(mutex_);
+    std::vector<Hotel> out;
+    out.reserve(items_.size());
+    for (const auto& entry : byId_) out.push_back(items_[entry.second]);
+    return out;
+}
+
+std::vector<Hotel> HotelRepository::listOrderedByName() const {
+    HMS_SCOPED_LATENCY("hotels.listOrderedByName");
+    const std::shared_lock lock(mutex_);
+    std::vector<Hotel> out;
+    out.reserve(items_.size());
+    for (const auto& key : byName_) out.push_back(items_[byId_.at(key.second)]);
+    return out;
+}
+
 }
@@ -1,11 +1,20 @@
 #pragma once
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 #include <optional>
 #include <filesystem>
+#include <map>
+#include <set>
+#include <utility>
+#include <nlohmann/json.hpp>
 #include "../models/Hotel.h"
+#include "FileSink.h"
 
 namespace hms {
+    // Safe to share between threads (server mode): queries take a shared
+    // lock and return copies, writes and load() take it exclusively.
     class HotelRepository {
     public:
         using path_t = std::filesystem::path;
@@ -14,16 +23,39 @@ namespace hms {
         bool load();
         bool saveAll() const;
 
-        std::optional<Hotel> get(const std::string& id) const;
+        std::optional<Hotel> get(const HotelId& id) const;
         bool upsert(const Hotel& h);
-        bool remove(const std::string& id);
+        bool remove(const HotelId& id);
         std::vector<Hotel> list() const;
 
+        // Ordered views served from indexes kept up to date on every write.
+        std::vector<Hotel> listOrderedById() const;
+        std::vector<Hotel> listOrderedByName() const; // ties broken by id
+
+        // Record codec (Schema-generated) used by load and by tools that write hotels.json
+        static nlohmann::json toJson(const Hotel& h);
+        template <typename Json> // nlohmann::json or ArenaJson
+        static bool           fromJson(const Json& j, Hotel& h);
+
         static path_t defaultPath();     // /src/data/hotels.json (normalized)
         const path_t& resolvedPath() const { return path_; }
 
+        // Layout written by saveAll; Pretty unless set.
+        void      setJsonStyle(JsonStyle style) { style_ = style; }
+        JsonStyle jsonStyle() const { return style_; }
+
+    private:
+        void reindex();
+        void indexInsert(const Hotel& h, std::size_t pos);
+        void indexErase(const Hotel& h);
+
     private:
+        mutable std::shared_mutex mutex_;
+        mutable std::mutex        saveMutex_; // one saveAll (and temp file) at a time
         path_t path_;
-        std::vector<Hotel> items_;
+        JsonStyle style_{JsonStyle::Pretty};
+        std::vector<Hotel> items_;                                // file order
+        std::map<HotelId, std::size_t> byId_;                     // id -> position in items_
+        std::set<std::pair<std::string, HotelId>> byName_;        // (name, id)
     };
 }
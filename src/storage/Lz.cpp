@@ -0,0 +1,130 @@
+#include "Lz.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace hms::lz {
+
+namespace {
+
+constexpr std::size_t kMinMatch   = 4;
+constexpr std::size_t kMaxOffset  = 65535;
+constexpr int         kHashBits   = 12;
+// Format rules that let decoders copy in wide steps: the last 5 bytes are
+// always literals and no match starts in the last 12.
+constexpr std::size_t kLastLiterals = 5;
+constexpr std::size_t kMatchLimit   = 12;
+
+std::uint32_t read32(const char* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+std::uint32_t hashOf(std::uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+// Lengths of 15 and more continue in extra bytes: 255 while more follows.
+void putLength(std::string& out, std::size_t length) {
+    for (; length >= 255; length -= 255) out.push_back(static_cast<char>(255));
+    out.push_back(static_cast<char>(length));
+}
+
+void putLiterals(std::string& out, const char* literals, std::size_t count, std::size_t tokenLow) {
+    const std::size_t high = count < 15 ? count : 15;
+    out.push_back(static_cast<char>((high << 4) | tokenLow));
+    if (count >= 15) putLength(out, count - 15);
+    out.append(literals, count);
+}
+
+bool getLength(const unsigned char*& ip, const unsigned char* end, std::size_t& length) {
+    for (;;) {
+        if (ip == end) return false;
+        const unsigned char more = *ip++;
+        length += more;
+        if (more != 255) return true;
+    }
+}
+
+}
+
+std::size_t compressBound(std::size_t rawSize) {
+    return rawSize + rawSize / 255 + 16;
+}
+
+void compress(std::string_view in, std::string& out) {
+    out.clear();
+    out.reserve(compressBound(in.size()));
+    const char*       base = in.data();
+    const std::size_t size = in.size();
+
+    // Most recent position (+1; 0 = none) of each hashed 4-byte sequence.
+    std::vector<std::uint32_t> recent(std::size_t{1} << kHashBits, 0);
+    std::size_t anchor = 0; // first byte not yet emitted
+    std::size_t pos    = 0;
+    const std::size_t matchEnd = size > kMatchLimit ? size - kMatchLimit : 0;
+
+    while (pos < matchEnd) {
+        const std::uint32_t sequence = read32(base + pos);
+        auto& slot = recent[hashOf(sequence)];
+        const std::size_t candidate = slot;
+        slot = static_cast<std::uint32_t>(pos + 1);
+        if (candidate == 0 || pos + 1 - candidate > kMaxOffset || read32(base + candidate - 1) != sequence) {
+            ++pos;
+            continue;
+        }
+
+        const std::size_t from = candidate - 1;
+        std::size_t length = kMinMatch;
+        const std::size_t longest = size - kLastLiterals - pos;
+        while (length < longest && base[from + length] == base[pos + length]) ++length;
+
+        const std::size_t extra = length - kMinMatch;
+        putLiterals(out, base + anchor, pos - anchor, extra < 15 ? extra : 15);
+        const std::size_t offset = pos - from;
+        out.push_back(static_cast<char>(offset & 0xff));
+        out.push_back(static_cast<char>(offset >> 8));
+        if (extra >= 15) putLength(out, extra - 15);
+
+        pos += length;
+        anchor = pos;
+    }
+    putLiterals(out, base + anchor, size - anchor, 0);
+}
+
+bool decompress(std::string_view in, std::size_t rawSize, std::string& out) {
+    out.assign(rawSize, '\0');
+    auto*       ip   = reinterpret_cast<const unsigned char*>(in.data());
+    const auto* end  = ip + in.size();
+    char*       op   = out.data();
+    std::size_t done = 0;
+
+    while (ip != end) {
+        const unsigned char token = *ip++;
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !getLength(ip, end, literals)) return false;
+        if (literals > static_cast<std::size_t>(end - ip) || literals > rawSize - done) return false;
+        std::memcpy(op + done, ip, literals);
+        ip += literals;
+        done += literals;
+        if (ip == end) break; // the last sequence has no match
+
+        if (end - ip < 2) return false;
+        const std::size_t offset = ip[0] | (std::size_t{ip[1]} << 8);
+        ip += 2;
+        std::size_t length = token & 0x0f;
+        if (length == 15 && !getLength(ip, end, length)) return false;
+        length += kMinMatch;
+        if (offset == 0 || offset > done || length > rawSize - done) return false;
+
+        // Byte by byte: a match may overlap the bytes it produces.
+        const char* from = op + done - offset;
+        for (std::size_t i = 0; i < length; ++i) op[done + i] = from[i];
+        done += length;
+    }
+    return done == rawSize;
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace hms::lz {
+
+    // Byte-oriented LZ77 in the LZ4 block format: a run of sequences, each a
+    // token (literal length, match length), the literals, a 2-byte
+    // little-endian back-reference offset and the match. No entropy stage,
+    // so decoding is a loop of copies. The compressed text does not record
+    // its own size; callers store the raw size next to it.
+
+    // Largest compressed size for `rawSize` input bytes.
+    std::size_t compressBound(std::size_t rawSize);
+
+    // Replaces `out` with the compressed form of `in`.
+    void compress(std::string_view in, std::string& out);
+
+    // Replaces `out` with the `rawSize` bytes encoded in `in`. False when
+    // `in` is not a complete block of exactly that size (truncated or
+    // corrupt input never reads or writes out of bounds).
+    bool decompress(std::string_view in, std::size_t rawSize, std::string& out);
+
+}
@@ -0,0 +1,191 @@
+#include "RestaurantRepository.h"
+#include "../diagnostics/Metrics.h"
+
+#include <fstream>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <system_error>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path baseDataDir() {
+#ifdef HMS_DATA_DIR
+    return fs::path{HMS_DATA_DIR};
+#else
+    return (fs::current_path() / "data").lexically_normal();
+#endif
+}
+
+std::uintmax_t fileSize(const fs::path& p) {
+    std::error_code ec;
+    const auto size = fs::file_size(p, ec);
+    return ec ? 0 : size;
+}
+
+bool ensureParentDir(const fs::path& p) {
+    try {
+        auto dir = p.parent_path();
+        if (!dir.empty() && !fs::exists(dir)) {
+            return fs::create_directories(dir);
+        }
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+}
+
+namespace hms {
+
+RestaurantRepository::path_t RestaurantRepository::defaultPath() {
+    return (baseDataDir() / "catalogue.json").lexically_normal();
+}
+
+RestaurantRepository::RestaurantRepository(path_t path)
+    : path_(std::move(path)) {}
+
+void RestaurantRepository::clear() {
+    restaurants_.clear();
+    menu_.clear();
+    byId_.clear();
+    byHotel_.clear();
+    byCategory_.clear();
+    itemById_.clear();
+}
+
+void RestaurantRepository::addRestaurant(Restaurant r, std::vector<MenuItem> menu) {
+    auto [it, inserted] = byId_.try_emplace(r.id, restaurants_.size());
+    if (!inserted) return; // first definition wins; the catalogue is hand-edited
+
+    byHotel_[r.hotelId].push_back(restaurants_.size());
+    for (auto& item : menu) {
+        item.restaurantId = r.id;
+        const std::size_t pos = menu_.size();
+        if (!itemById_.try_emplace(ScopedKey{r.id, item.id}, pos).second) continue;
+        byCategory_[ScopedKey{r.id, item.category}].push_back(pos);
+        menu_.push_back(std::move(item));
+    }
+    restaurants_.push_back(std::move(r));
+}
+
+bool RestaurantRepository::load() {
+    HMS_SCOPED_LATENCY("restaurants.load");
+    const std::unique_lock lock(mutex_);
+    clear();
+    if (!ensureParentDir(path_)) return false;
+
+    if (!fs::exists(path_)) {
+        std::ofstream out(path_, std::ios::trunc);
+        if (!out.good()) return false;
+        out << "{\n  \"restaurants\": []\n}\n";
+        return true;
+    }
+
+    HMS_COUNTER_ADD("restaurants.bytesRead", fileSize(path_));
+    std::ifstream in(path_);
+    if (!in.good()) return false;
+
+    json doc;
+    try { in >> doc; }
+    catch (...) { return false; }
+
+    if (doc.is_null()) return true;
+    if (!doc.is_object()) return false;
+    if (!doc.contains("restaurants")) return true;
+
+    const auto& restaurants = doc.at("restaurants");
+    if (!restaurants.is_array()) return false;
+
+    try {
+        for (const auto& j : restaurants) {
+            auto r = j.get<Restaurant>();
+            std::vector<MenuItem> menu;
+            if (j.contains("menu")) j.at("menu").get_to(menu);
+            addRestaurant(std::move(r), std::move(menu));
+        }
+    }
+    catch (...) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+std::optional<Restaurant> RestaurantRepository::get(const std::string& restaurantId) const {
+    HMS_SCOPED_LATENCY("restaurants.get");
+    const std::shared_lock lock(mutex_);
+    auto it = byId_.find(restaurantId);
+    if (it == byId_.end()) return std::nullopt;
+    return restaurants_[it->second];
+}
+
+std::vector<Restaurant> RestaurantRepository::list() const {
+    HMS_SCOPED_LATENCY("restaurants.list");
+    const std::shared_lock lock(mutex_);
+    return restaurants_;
+}
+
+std::vector<Restaurant> RestaurantRepository::listByHotel(const HotelId& hotelId) const {
+    HMS_SCOPED_LATENCY("restaurants.listByHotel");
+    const std::shared_lock lock(mutex_);
+    std::vector<Restaurant> out;
+    auto it = byHotel_.find(hotelId);
+    if (it == byHotel_.end()) return out;
+    out.reserve(it->second.size());
+    for (auto pos : it->second) out.push_back(restaurants_[pos]);
+    return out;
+}
+
+std::vector<MenuItem> RestaurantRepository::menuFor(const std::string& restaurantId) const {
+    HMS_SCOPED_LATENCY("restaurants.menuFor");
+    const std::shared_lock lock(mutex_);
+    std::vector<MenuItem> out;
+    for (auto it = byCategory_.lower_bound(ScopedKey{restaurantId, std::string{}});
+         it != byCategory_.end() && it->first.first == restaurantId; ++it) {
+        for (auto pos : it->second) out.push_back(menu_[pos]);
+    }
+    return out;
+}
+
+std::vector<MenuItem> RestaurantRepository::menuFor(const std::string& restaurantId,
+                                                    const std::string& category) const {
+    HMS_SCOPED_LATENCY("restaurants.menuForCategory");
+    const std::shared_lock lock(mutex_);
+    std::vector<MenuItem> out;
+    auto it = byCategory_.find(ScopedKey{restaurantId, category});
+    if (it == byCategory_.end()) return out;
+    out.reserve(it->second.size());
+    for (auto pos : it->second) out.push_back(menu_[pos]);
+    return out;
+}
+
+std::vector<std::string> RestaurantRepository::categoriesFor(const std::string& restaurantId) const {
+    HMS_SCOPED_LATENCY("restaurants.categoriesFor");
+    const std::shared_lock lock(mutex_);
+    std::vector<std::string> out;
+    for (auto it = byCategory_.lower_bound(ScopedKey{restaurantId, std::string{}});
+         it != byCategory_.end() && it->first.first == restaurantId; ++it) {
+        out.push_back(it->first.second);
+    }
+    return out;
+}
+
+std::optional<MenuItem> RestaurantRepository::menuItem(const std::string& restaurantId,
+                                                       const std::string& itemId) const {
+    HMS_SCOPED_LATENCY("restaurants.menuItem");
+    const std::shared_lock lock(mutex_);
+    auto it = itemById_.find(ScopedKey{restaurantId, itemId});
+    if (it == itemById_.end()) return std::nullopt;
+    return menu_[it->second];
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include <optional>
+#include <filesystem>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include "../models/Restaurant.h"
+#include "../models/MenuItem.h"
+
+namespace hms {
+    // Read-only view of the restaurants and menus described in catalogue.json.
+    // Menus are indexed by restaurant, hotel and category so browsing a large
+    // menu is a lookup rather than a scan.
+    // Read-only after load(). Safe to share between threads (server mode):
+    // queries take a shared lock and return copies.
+    class RestaurantRepository {
+    public:
+        using path_t = std::filesystem::path;
+        explicit RestaurantRepository(path_t path = defaultPath());
+
+        bool load(); // reads the "restaurants" section (creates an empty catalogue if missing)
+
+        std::optional<Restaurant> get(const std::string& restaurantId) const;
+        std::vector<Restaurant>   list() const;
+        std::vector<Restaurant>   listByHotel(const HotelId& hotelId) const;
+
+        std::vector<MenuItem>     menuFor(const std::string& restaurantId) const; // grouped by category
+        std::vector<MenuItem>     menuFor(const std::string& restaurantId, const std::string& category) const;
+        std::vector<std::string>  categoriesFor(const std::string& restaurantId) const;
+        std::optional<MenuItem>   menuItem(const std::string& restaurantId, const std::string& itemId) const;
+
+        static path_t defaultPath();   // /src/data/catalogue.json (normalized)
+        const path_t& resolvedPath() const { return path_; }
+
+    private:
+        using ScopedKey = std::pair<std::string, std::string>; // (restaurantId, category or item id)
+
+        void clear();
+        void addRestaurant(Restaurant r, std::vector<MenuItem> menu);
+
+    private:
+        mutable std::shared_mutex mutex_;
+        path_t path_;
+        std::vector<Restaurant> restaurants_;  // catalogue order
+        std::vector<MenuItem>   menu_;         // catalogue order
+
+        std::unordered_map<std::string, std::size_t>              byId_;       // restaurantId -> position
+        std::unordered_map<HotelId, std::vector<std::size_t>>     byHotel_;    // hotelId -> restaurants
+        std::map<ScopedKey, std::vector<std::size_t>>           byCategory_; // -> menu items
+        std::map<ScopedKey, std::size_t>                        itemById_;   // (restaurantId, itemId) -> menu item
+    };
+}
@@ -1,8 +1,15 @@
 #include "RoomsRepository.h"
+#include "Arena.h"
+#include "FileSink.h"
+#include "../models/Codec.h"
+#include "../diagnostics/Metrics.h"
 
 #include <algorithm>
 #include <fstream>
 #include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <limits>
 #include <system_error>
 
 #include <nlohmann/json.hpp>
@@ -20,6 +27,12 @@ fs::path baseDataDir() {
 #endif
 }
 
+std::uintmax_t fileSize(const fs::path& p) {
+    std::error_code ec;
+    const auto size = fs::file_size(p, ec);
+    return ec ? 0 : size;
+}
+
 bool ensureParentDir(const fs::path& p) {
     try {
         auto dir = p.parent_path();
@@ -45,7 +58,10 @@ RoomsRepository::RoomsRepository(path_t path)
     : path_(std::move(path)) {}
 
 bool RoomsRepository::load() {
+    HMS_SCOPED_LATENCY("rooms.load");
+    const std::unique_lock lock(mutex_);
     items_.clear();
+    reindex();
     if (!ensureParentDir(path_)) return false;
 
     if (!fs::exists(path_)) {
@@ -55,91 +71,143 @@ bool RoomsRepository::load() {
         return true;
     }
 
-    std::ifstream in(path_);
-    if (!in.good()) return false;
+    HMS_COUNTER_ADD("rooms.bytesRead", fileSize(path_));
+    // The file text and the parsed DOM share one arena that is dropped as a
+    // whole once the records have been converted.
+    MonotonicArena arena;
+    const ArenaScope scope{arena};
+    const ArenaJson* doc = parseJsonFile(path_, arena);
+    if (doc == nullptr) return false;
 
-    json doc;
-    try { in >> doc; }
-    catch (...) { return false; }
-
-    if (doc.is_null()) return true;
-    if (!doc.is_array()) return false;
+    if (doc->is_null()) return true;
+    if (!doc->is_array()) return false;
 
     try {
-        items_ = doc.get<std::vector<Room>>();
+        items_ = doc->get<std::vector<Room>>();
     }
     catch (...) {
+        items_.clear();
         return false;
     }
+    reindex();
     return true;
 }
 
 bool RoomsRepository::saveAll() const {
+    HMS_SCOPED_LATENCY("rooms.saveAll");
+    const std::lock_guard saving(saveMutex_); // one writer of the temp file at a time
+    const std::shared_lock lock(mutex_);
     if (!ensureParentDir(path_)) return false;
 
-    const fs::path tmp = path_.string() + ".tmp";
-    json arr = json::array();
-    for (const auto& r : items_) arr.push_back(r);
+    // Streamed straight from the models: no DOM and no whole-file string.
+    std::uint64_t bytes = 0;
+    const bool ok = writeFileAtomically(path_, [&](FileSink& sink) {
+        JsonWriter<FileSink> writer(sink, indentFor(style_));
+        writeJson(writer, items_);
+    }, bytes);
+    if (ok) HMS_COUNTER_ADD("rooms.bytesWritten", bytes);
+    return ok;
+}
 
-    {
-        std::ofstream out(tmp, std::ios::trunc);
-        if (!out.good()) return false;
-        out << arr.dump(2) << '\n';
-        out.flush();
-        if (!out.good()) return false;
+void RoomsRepository::reindex() {
+    byKey_.clear();
+
+    // Keep the last occurrence of a duplicated (hotelId, number), like repeated upserts would.
+    std::vector<Room> unique;
+    unique.reserve(items_.size());
+    for (auto& r : items_) {
+        auto [it, inserted] = byKey_.try_emplace(RoomKey{r.hotelId, r.number}, unique.size());
+        if (!inserted) {
+            unique[it->second] = std::move(r);
+            continue;
+        }
+        unique.push_back(std::move(r));
     }
+    items_ = std::move(unique);
+}
 
-    std::error_code ec;
-    fs::rename(tmp, path_, ec);
-    if (ec) {
-        fs::remove(tmp);
-        return false;
-    }
-    return true;
+std::map<RoomsRepository::RoomKey, std::size_t>::const_iterator
+RoomsRepository::hotelBegin(const HotelId& hotelId) const {
+    return byKey_.lower_bound(RoomKey{hotelId, std::numeric_limits<int>::min()});
 }
 
-std::optional<Room> RoomsRepository::get(const std::string& hotelId, int number) const {
-    auto it = std::find_if(items_.begin(), items_.end(),
-                           [&](const Room& r){ return r.hotelId == hotelId && r.number == number; });
-    if (it == items_.end()) return std::nullopt;
-    return *it;
+std::optional<Room> RoomsRepository::get(const HotelId& hotelId, int number) const {
+    HMS_SCOPED_LATENCY("rooms.get");
+    const std::shared_lock lock(mutex_);
+    auto it = byKey_.find(RoomKey{hotelId, number});
+    if (it == byKey_.end()) return std::nullopt;
+    return items_[it->second];
 }
 
 bool RoomsRepository::upsert(const Room& r) {
+    HMS_SCOPED_LATENCY("rooms.upsert");
+    const std::unique_lock lock(mutex_);
     Room normalized = r;
     if (normalized.id.empty() && !normalized.hotelId.empty() && normalized.number > 0) {
         normalized.id = normalized.hotelId + "-" + std::to_string(normalized.number);
     }
 
-    auto it = std::find_if(items_.begin(), items_.end(),
-                           [&](const Room& x){ return x.hotelId == normalized.hotelId && x.number == normalized.number; });
-    if (it == items_.end()) items_.push_back(std::move(normalized));
-    else                    *it = std::move(normalized);
+    auto [it, inserted] = byKey_.try_emplace(RoomKey{normalized.hotelId, normalized.number}, items_.size());
+    if (inserted) items_.push_back(std::move(normalized));
+    else          items_[it->second] = std::move(normalized);
     return true;
 }
 
-bool RoomsRepository::remove(const std::string& hotelId, int number) {
-    auto it = std::remove_if(items_.begin(), items_.end(),
-                             [&](const Room& x){ return x.hotelId == hotelId && x.number == number; });
-    if (it == items_.end()) return false;
-    items_.erase(it, items_.end());
+bool RoomsRepository::remove(const HotelId& hotelId, int number) {
+    HMS_SCOPED_LATENCY("rooms.remove");
+    const std::unique_lock lock(mutex_);
+    auto it = byKey_.find(RoomKey{hotelId, number});
+    if (it == byKey_.end()) return false;
+
+    const std::size_t pos = it->second;
+    byKey_.erase(it);
+    items_.erase(items_.begin() + static_cast<std::ptrdiff_t>(pos));
+    for (auto& entry : byKey_) {
+        if (entry.second > pos) --entry.second;
+    }
     return true;
 }
 
 std::vector<Room> RoomsRepository::list() const {
+    HMS_SCOPED_LATENCY("rooms.list");
+    const std::shared_lock lock(mutex_);
     return items_;
 }
 
-std::vector<Room> RoomsRepository::listByHotel(const std::string& hotelId) const {
+std::vector<Room> RoomsRepository::listByHotel(const HotelId& hotelId) const {
+    HMS_SCOPED_LATENCY("rooms.listByHotel");
+    const std::shared_lock lock(mutex_);
     std::vector<Room> out;
-    for (const auto& r : items_) if (r.hotelId == hotelId) out.push_back(r);
+    for (auto it = hotelBegin(hotelId); it != byKey_.end() && it->first.first == hotelId; ++it) {
+        out.push_back(items_[it->second]);
+    }
     return out;
 }
 
-int RoomsRepository::countActiveByHotel(const std::string& hotelId) const {
+int RoomsRepository::countActiveByHotel(const HotelId& hotelId) const {
+    HMS_SCOPED_LATENCY("rooms.countActiveByHotel");
+    const std::shared_lock lock(mutex_);
     int n = 0;
-    for (const auto& r : items_) if (r.hotelId == hotelId && r.active) ++n;
+    for (auto it = hotelBegin(hotelId); it != byKey_.end() && it->first.first == hotelId; ++it) {
+        if (items_[it->second].active) ++n;
+    }
     return n;
 }
 
+RoomPage RoomsRepository::listByHotelPage(const HotelId& hotelId,
+                                          std::optional<int> afterNumber,
+                                          std::size_t limit) const {
+    HMS_SCOPED_LATENCY("rooms.listByHotelPage");
+    const std::shared_lock lock(mutex_);
+    RoomPage page;
+    if (limit == 0) return page;
+
+    auto it = afterNumber ? byKey_.upper_bound(RoomKey{hotelId, *afterNumber}) : hotelBegin(hotelId);
+    for (; it != byKey_.end() && it->first.first == hotelId && page.items.size() < limit; ++it) {
+        page.items.push_back(items_[it->second]);
+    }
+    if (it != byKey_.end() && it->first.first == hotelId) page.next = page.items.back().number;
+    return page;
+}
+
 }
@@ -1,11 +1,25 @@
 #pragma once
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 #include <optional>
 #include <filesystem>
+#include <map>
+#include <utility>
 #include "../models/Room.h"
+#include "FileSink.h"
 
 namespace hms {
+    // One page of a hotel's rooms ordered by room number. `next` holds the last
+    // room number on the page when more rooms follow.
+    struct RoomPage {
+        std::vector<Room>  items;
+        std::optional<int> next;
+    };
+
+    // Safe to share between threads (server mode): queries take a shared
+    // lock and return copies, writes and load() take it exclusively.
     class RoomsRepository {
     public:
         using path_t = std::filesystem::path;
@@ -15,19 +29,39 @@ namespace hms {
         bool saveAll() const;
 
 
-        std::optional<Room> get(const std::string& hotelId, int number) const;
+        std::optional<Room> get(const HotelId& hotelId, int number) const;
         bool upsert(const Room& r);
-        bool remove(const std::string& hotelId, int number);
+        bool remove(const HotelId& hotelId, int number);
 
         std::vector<Room> list() const;
-        std::vector<Room> listByHotel(const std::string& hotelId) const;
-        int countActiveByHotel(const std::string& hotelId) const;
+        std::vector<Room> listByHotel(const HotelId& hotelId) const; // ordered by number
+        int countActiveByHotel(const HotelId& hotelId) const;
+
+        // Paging by room number. Pass std::nullopt for the first page and the
+        // returned `next` for the following ones.
+        RoomPage listByHotelPage(const HotelId& hotelId,
+                                 std::optional<int> afterNumber,
+                                 std::size_t limit) const;
 
         static path_t defaultPath();   // e.g., CWD/../src/data/rooms.json
         const path_t& resolvedPath() const { return path_; }
 
+        // Layout written by saveAll; Pretty unless set.
+        void      setJsonStyle(JsonStyle style) { style_ = style; }
+        JsonStyle jsonStyle() const { return style_; }
+
+    private:
+        using RoomKey = std::pair<HotelId, int>; // (hotelId, number)
+
+        void reindex();
+        std::map<RoomKey, std::size_t>::const_iterator hotelBegin(const HotelId& hotelId) const;
+
     private:
+        mutable std::shared_mutex mutex_;
+        mutable std::mutex        saveMutex_; // one saveAll (and temp file) at a time
         path_t path_;
-        std::vector<Room> items_;
+        JsonStyle style_{JsonStyle::Pretty};
+        std::vector<Room> items_;                  // file order
+        std::map<RoomKey, std::size_t> byKey_;     // (hotelId, number) -> position in items_
     };
 }
\ No newline at end of file
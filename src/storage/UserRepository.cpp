@@ -1,8 +1,14 @@
 #include "UserRepository.h"
+#include "Arena.h"
+#include "FileSink.h"
+#include "../models/Codec.h"
+#include "../diagnostics/Metrics.h"
 
 #include <algorithm>
 #include <fstream>
 #include <filesystem>
+#include <mutex>
+#include <shared_mutex>
 #include <system_error>
 #include <utility>
 
@@ -23,6 +29,12 @@ fs::path baseDataDir() {
 #endif
 }
 
+std::uintmax_t fileSize(const fs::path& p) {
+    std::error_code ec;
+    const auto size = fs::file_size(p, ec);
+    return ec ? 0 : size;
+}
+
 bool ensureParentDir(const fs::path& p) {
     try {
         auto dir = p.parent_path();
@@ -36,52 +48,21 @@ bool ensureParentDir(const fs::path& p) {
     }
 }
 
-std::string roleToString(hms::Role r) {
-    switch (r) {
-        case hms::Role::ADMIN: return "ADMIN";
-        case hms::Role::MANAGER: return "MANAGER";
-        case hms::Role::GUEST: return "GUEST";
-    }
-    return "GUEST";
-}
+} // namespace
 
-hms::Role roleFromString(const std::string& s) {
-    if (s == "ADMIN") return hms::Role::ADMIN;
-    if (s == "MANAGER") return hms::Role::MANAGER;
-    return hms::Role::GUEST;
-}
+namespace hms {
 
-json toJson(const hms::User& u) {
-    return json{
-        {"userId",       u.userId},
-        {"firstName",    u.firstName},
-        {"lastName",     u.lastName},
-        {"address",      u.address},
-        {"phone",        u.phone},
-        {"login",        u.login},
-        {"passwordHash", u.passwordHash},
-        {"role",         roleToString(u.role)},
-        {"active",       u.active}
-    };
+json UserRepository::toJson(const User& u) {
+    return u; // Schema<User>; the raw password is never written
 }
 
-bool fromJson(const json& j, hms::User& u) {
+template <typename Json>
+bool UserRepository::fromJson(const Json& j, User& u) {
     try {
-        u.userId       = j.value("userId", "");
-        u.firstName    = j.value("firstName", "");
-        u.lastName     = j.value("lastName",  "");
-        u.address      = j.value("address",   "");
-        u.phone        = j.value("phone",     "");
-        u.login        = j.value("login",     "");
-        u.passwordHash = j.value("passwordHash", "");
-        if (u.passwordHash.empty()) {
-            const auto legacy = j.value("password", std::string{});
-            if (!legacy.empty()) {
-                u.passwordHash = hms::HashPasswordDemo(legacy);
-            }
+        j.get_to(u);
+        if (u.passwordHash.empty() && !u.password.empty()) {
+            u.passwordHash = hms::HashPassword(u.password);
         }
-        u.role   = roleFromString(j.value("role", "GUEST"));
-        u.active = j.value("active", true);
         u.password.clear();
         return true;
     }
@@ -90,9 +71,8 @@ bool fromJson(const json& j, hms::User& u) {
     }
 }
 
-} // namespace
-
-namespace hms {
+template bool UserRepository::fromJson(const json&, User&);
+template bool UserRepository::fromJson(const ArenaJson&, User&);
 
 UserRepository::path_t UserRepository::defaultUsersPath() {
     return (baseDataDir() / "users.json").lexically_normal();
@@ -102,6 +82,8 @@ UserRepository::UserRepository(path_t path)
     : path_(std::move(path)) {}
 
 bool UserRepository::load() {
+    HMS_SCOPED_LATENCY("users.load");
+    const std::unique_lock lock(mutex_);
     items_.clear();
     if (!ensureParentDir(path_)) return false;
 
@@ -112,17 +94,19 @@ bool UserRepository::load() {
         return true;
     }
 
-    std::ifstream in(path_);
-    if (!in.good()) return false;
+    HMS_COUNTER_ADD("users.bytesRead", fileSize(path_));
+    // The file text and the parsed DOM share one arena that is dropped as a
+    // whole once the records have been converted.
+    MonotonicArena arena;
+    const ArenaScope scope{arena};
+    const ArenaJson* doc = parseJsonFile(path_, arena);
+    if (doc == nullptr) return false;
 
-    json doc;
-    try { in >> doc; }
-    catch (...) { return false; }
+    if (doc->is_null()) return true;
+    if (!doc->is_array()) return false;
 
-    if (doc.is_null()) return true;
-    if (!doc.is_array()) return false;
-
-    for (const auto& j : doc) {
+    items_.reserve(doc->size());
+    for (const auto& j : *doc) {
         User u{};
         if (fromJson(j, u)) {
             items_.push_back(std::move(u));
@@ -132,30 +116,24 @@ bool UserRepository::load() {
 }
 
 bool UserRepository::saveAll() const {
+    HMS_SCOPED_LATENCY("users.saveAll");
+    const std::lock_guard saving(saveMutex_); // one writer of the temp file at a time
+    const std::shared_lock lock(mutex_);
     if (!ensureParentDir(path_)) return false;
 
-    const fs::path tmp = path_.string() + ".tmp";
-    json arr = json::array();
-    for (const auto& u : items_) arr.push_back(toJson(u));
-
-    {
-        std::ofstream out(tmp, std::ios::trunc);
-        if (!out.good()) return false;
-        out << arr.dump(2) << '\n';
-        out.flush();
-        if (!out.good()) return false;
-    }
-
-    std::error_code ec;
-    fs::rename(tmp, path_, ec);
-    if (ec) {
-        fs::remove(tmp);
-        return false;
-    }
-    return true;
+    // Streamed straight from the models: no DOM and no whole-file string.
+    std::uint64_t bytes = 0;
+    const bool ok = writeFileAtomically(path_, [&](FileSink& sink) {
+        JsonWriter<FileSink> writer(sink, indentFor(style_));
+        writeJson(writer, items_);
+    }, bytes);
+    if (ok) HMS_COUNTER_ADD("users.bytesWritten", bytes);
+    return ok;
 }
 
-std::optional<User> UserRepository::getById(const std::string& userId) const {
+std::optional<User> UserRepository::getById(const UserId& userId) const {
+    HMS_SCOPED_LATENCY("users.getById");
+    const std::shared_lock lock(mutex_);
     auto it = std::find_if(items_.begin(), items_.end(),
                            [&](const User& u){ return u.userId == userId; });
     if (it == items_.end()) return std::nullopt;
@@ -163,6 +141,8 @@ std::optional<User> UserRepository::getById(const std::string& userId) const {
 }
 
 std::optional<User> UserRepository::getByLogin(const std::string& login) const {
+    HMS_SCOPED_LATENCY("users.getByLogin");
+    const std::shared_lock lock(mutex_);
     auto it = std::find_if(items_.begin(), items_.end(),
                            [&](const User& u){ return u.login == login; });
     if (it == items_.end()) return std::nullopt;
@@ -170,10 +150,12 @@ std::optional<User> UserRepository::getByLogin(const std::string& login) const {
 }
 
 std::vector<User> UserRepository::list() const {
+    HMS_SCOPED_LATENCY("users.list");
+    const std::shared_lock lock(mutex_);
     return items_;
 }
 
-bool UserRepository::loginTakenByOther(const std::string& login, const std::string& thisUserId) const {
+bool UserRepository::loginTakenByOther(const std::string& login, const UserId& thisUserId) const {
     if (login.empty()) return false;
     for (const auto& u : items_) {
         if (u.login == login && u.userId != thisUserId) return true;
@@ -182,6 +164,8 @@ bool UserRepository::loginTakenByOther(const std::string& login, const std::stri
 }
 
 bool UserRepository::upsert(const User& u) {
+    HMS_SCOPED_LATENCY("users.upsert");
+    const std::unique_lock lock(mutex_);
     if (u.userId.empty()) return false;
     if (loginTakenByOther(u.login, u.userId)) return false;
 
@@ -192,7 +176,9 @@ bool UserRepository::upsert(const User& u) {
     return true;
 }
 
-bool UserRepository::removeById(const std::string& userId) {
+bool UserRepository::removeById(const UserId& userId) {
+    HMS_SCOPED_LATENCY("users.removeById");
+    const std::unique_lock lock(mutex_);
     auto it = std::remove_if(items_.begin(), items_.end(),
                              [&](const User& x){ return x.userId == userId; });
     if (it == items_.end()) return false;
@@ -201,6 +187,8 @@ bool UserRepository::removeById(const std::string& userId) {
 }
 
 bool UserRepository::removeByLogin(const std::string& login) {
+    HMS_SCOPED_LATENCY("users.removeByLogin");
+    const std::unique_lock lock(mutex_);
     auto it = std::remove_if(items_.begin(), items_.end(),
                              [&](const User& x){ return x.login == login; });
     if (it == items_.end()) return false;
@@ -1,12 +1,18 @@
 #pragma once
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 #include <optional>
 #include <filesystem>
+#include <nlohmann/json.hpp>
 #include "../models/User.h"
+#include "FileSink.h"
 
 namespace hms {
 
+    // Safe to share between threads (server mode): queries take a shared
+    // lock and return copies, writes and load() take it exclusively.
     class UserRepository {
     public:
         using path_t = std::filesystem::path;
@@ -19,23 +25,35 @@ namespace hms {
         bool saveAll() const; // memory -> JSON (atomic via temp+rename)
 
         // Queries
-        std::optional<User> getById(const std::string& userId) const;
+        std::optional<User> getById(const UserId& userId) const;
         std::optional<User> getByLogin(const std::string& login) const;
         std::vector<User>   list() const;
 
         bool upsert(const User& u);
-        bool removeById(const std::string& userId);
+        bool removeById(const UserId& userId);
         bool removeByLogin(const std::string& login);
 
+        // Record codec (Schema-generated) used by load and by tools that write users.json
+        static nlohmann::json toJson(const User& u);
+        template <typename Json> // nlohmann::json or ArenaJson
+        static bool           fromJson(const Json& j, User& u);
+
         // Utils
         static path_t defaultUsersPath();
         const path_t& resolvedPath() const { return path_; }
 
+        // Layout written by saveAll; Pretty unless set.
+        void      setJsonStyle(JsonStyle style) { style_ = style; }
+        JsonStyle jsonStyle() const { return style_; }
+
     private:
-        bool loginTakenByOther(const std::string& login, const std::string& thisUserId) const;
+        bool loginTakenByOther(const std::string& login, const UserId& thisUserId) const;
 
     private:
+        mutable std::shared_mutex mutex_;
+        mutable std::mutex        saveMutex_; // one saveAll (and temp file) at a time
         path_t path_;
+        JsonStyle style_{JsonStyle::Pretty};
         std::vector<User> items_;
     };
 
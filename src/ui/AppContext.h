@@ -5,14 +5,20 @@
 #include "../storage/RoomsRepository.h"
 #include "../storage/HotelRepository.h"
 #include "../storage/BookingRepository.h"
+#include "../storage/BookingArchive.h"
+#include "../storage/RestaurantRepository.h"
+#include "../pricing/PricingEngine.h"
 
 namespace hms {
 
     struct Services {
-        UserRepository*    users{};
-        RoomsRepository*   rooms{};
-        HotelRepository*   hotels{};
-        BookingRepository* bookings{};
+        UserRepository*       users{};
+        RoomsRepository*      rooms{};
+        HotelRepository*      hotels{};
+        BookingRepository*    bookings{};
+        RestaurantRepository* restaurants{};
+        PricingEngine*        pricing{};
+        BookingArchive*       archive{};     // closed bookings moved out of `bookings`
     };
 
     struct AppContext {
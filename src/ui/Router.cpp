@@ -5,12 +5,21 @@
 #include "screens/DashboardGuest.h"
 #include "screens/DashboardAdmin.h"
 #include "core/ConsoleIO.h"
+#include "../diagnostics/Trace.h"
+#include <cstdint>
+#include <ctime>
 #include <stdexcept>
+#include <string>
 
 namespace hms::ui {
 
-    // Helpers to persist data once at exit (or after major ops if you prefer)
-    static void SaveAll(AppContext& ctx) {
+    static void waitAfterError(AppContext& ctx) {
+        try { ConsoleIO::waitKey(); }
+        catch (const InputClosed&) { ctx.running = false; }
+    }
+
+    void SaveAll(AppContext& ctx) {
+        HMS_TRACE_SPAN("router.saveAll", "router");
         try {
             ctx.svc.users->saveAll();
             ctx.svc.rooms->saveAll();
@@ -22,34 +31,87 @@ namespace hms::ui {
         }
     }
 
-    void Run(AppContext& ctx) {
-        // Load data once, with basic error handling
+    // Moves long-closed bookings to the archive and rewrites the (now
+    // smaller) booking files. Off unless the archive has a minimum age.
+    static void ArchiveClosed(AppContext& ctx) {
+        if (!ctx.svc.archive || ctx.svc.archive->minimumAge() <= 0) return;
+        HMS_TRACE_SPAN("router.archive", "router");
+        const std::int64_t cutoff = static_cast<std::int64_t>(std::time(nullptr)) - ctx.svc.archive->minimumAge();
+        std::size_t moved = 0;
+        if (!ctx.svc.bookings->archiveClosed(*ctx.svc.archive, cutoff, moved)) {
+            ConsoleIO::println("[WARN] Failed to archive closed bookings; they stay in bookings.json.");
+            return;
+        }
+        if (moved > 0 && !ctx.svc.bookings->saveAll()) {
+            ConsoleIO::println("[WARN] Failed to save bookings after archiving.");
+        }
+    }
+
+    // Journal records torn by a crash or power loss were dropped by load();
+    // say so rather than start silently without them.
+    static void ReportRecovery(const AppContext& ctx) {
+        const auto& recovery = ctx.svc.bookings->lastRecovery();
+        if (recovery.droppedRecords == 0) return;
+        ConsoleIO::println("[WARN] Dropped " + std::to_string(recovery.droppedRecords) +
+                           " damaged booking journal record(s) (" + std::to_string(recovery.droppedBytes) +
+                           " bytes), left by an unclean shutdown:");
+        for (const auto& file : recovery.truncatedFiles) ConsoleIO::println("       " + file.string());
+    }
+
+    bool LoadAll(AppContext& ctx) {
         try {
+            HMS_TRACE_SPAN("router.load", "router");
             if (!ctx.svc.users->load()  ||
                 !ctx.svc.rooms->load()  ||
                 !ctx.svc.hotels->load() ||
-                !ctx.svc.bookings->load()) {
+                !ctx.svc.bookings->load() ||
+                !ctx.svc.restaurants->load() ||
+                !ctx.svc.pricing->load()) {
                 throw std::runtime_error("Repository load failed");
             }
+            ReportRecovery(ctx);
+            ctx.svc.pricing->precompute(ctx.svc.rooms->list());
+            ArchiveClosed(ctx);
         }
         catch (const std::exception& ex) {
             ConsoleIO::println(std::string("[ERROR] Failed to load data: ") + ex.what());
+            return false;
+        }
+        return true;
+    }
+
+    void Run(AppContext& ctx) {
+        // Load data once, with basic error handling
+        if (!LoadAll(ctx)) {
             ConsoleIO::println("Press Enter to exit...");
-            ConsoleIO::waitKey();
+            try { ConsoleIO::waitKey(); }
+            catch (const InputClosed&) {}
             return;
         }
 
+        RunSession(ctx);
+
+        // Persist on final exit
+        SaveAll(ctx);
+    }
+
+    void RunSession(AppContext& ctx) {
         while (ctx.running) {
             try {
                 if (!ctx.currentUser) {
                     // ------- Welcome flow -------
-                    const int choice = WelcomeScreen(); // 1=Login, 2=Register, other=Exit
+                    const int choice = [] {
+                        HMS_TRACE_SPAN("router.welcome", "router");
+                        return WelcomeScreen(); // 1=Login, 2=Register, other=Exit
+                    }();
                     if (choice == 1) {
+                        HMS_TRACE_SPAN("router.login", "router");
                         if (auto u = LoginScreen(*ctx.svc.users)) {
                             ctx.currentUser = *u;
                         }
                     }
                     else if (choice == 2) {
+                        HMS_TRACE_SPAN("router.register", "router");
                         // Allow admin bootstrap if no admins exist yet
                         if (auto u = RegisterScreen(*ctx.svc.users, /*allowAdminBootstrap=*/true)) {
                             ctx.currentUser = *u;
@@ -71,6 +133,7 @@ namespace hms::ui {
                 bool shouldContinue = true;
                 while (ctx.running && ctx.currentUser && shouldContinue) {
                     bool logoutRequested = false;
+                    HMS_TRACE_SPAN("router.dashboard", "router");
                     if (role == hms::Role::ADMIN) {
                         logoutRequested = DashboardAdmin(ctx);
                     }
@@ -92,21 +155,21 @@ namespace hms::ui {
                 }
 
             }
+            catch (const InputClosed&) {
+                ctx.running = false; // nobody left to talk to
+            }
             catch (const std::exception& ex) {
                 ConsoleIO::println(std::string("[ERROR] ") + ex.what());
                 ConsoleIO::println("Returning to Welcome...");
                 ctx.currentUser.reset(); // drop to Welcome on any unexpected error
-                ConsoleIO::waitKey();
+                waitAfterError(ctx);
             }
             catch (...) {
                 ConsoleIO::println("[ERROR] Unknown error");
                 ConsoleIO::println("Returning to Welcome...");
                 ctx.currentUser.reset();
-                ConsoleIO::waitKey();
+                waitAfterError(ctx);
             }
         }
-
-        // Persist on final exit
-        SaveAll(ctx);
     }
 }
@@ -1,4 +1,19 @@
 #pragma once
 #include "AppContext.h"
 
-namespace hms::ui { void Run(AppContext& ctx); }
+namespace hms::ui {
+    // Loads every repository, precomputes prices and, when the archive has
+    // a minimum age, moves long-closed bookings into it; false (after
+    // printing why) if loading failed.
+    bool LoadAll(AppContext& ctx);
+    // Persists every writable repository; failures are reported, not thrown.
+    void SaveAll(AppContext& ctx);
+
+    // Welcome/login/dashboard loop on the current thread's in()/out(), until
+    // the user exits or the input closes. Saves on logout; expects loaded
+    // repositories.
+    void RunSession(AppContext& ctx);
+
+    // LoadAll, RunSession, SaveAll: the single-user console app.
+    void Run(AppContext& ctx);
+}
@@ -1,4 +1,6 @@
 #include "ConsoleIO.h"
+#include "Frame.h"
+#include "../../diagnostics/Trace.h"
 
 #include <algorithm>
 #include <cctype>
@@ -13,6 +15,40 @@
 
 namespace hms::ui {
 
+namespace {
+thread_local std::istream* currentIn  = &std::cin;
+thread_local std::ostream* currentOut = &std::cout;
+
+// getline that reports a closed input instead of leaving the caller to spin
+// on a stream that will never deliver another line.
+void getLine(std::string& s) {
+    std::getline(in(), s);
+    if (in().eof() && s.empty()) throw InputClosed();
+}
+}
+
+std::istream& in()  { return *currentIn; }
+std::ostream& out() { return *currentOut; }
+
+StreamBinding exchangeStreams(StreamBinding next) {
+    const StreamBinding previous{currentIn, currentOut};
+    currentIn  = next.in;
+    currentOut = next.out;
+    return previous;
+}
+
+SessionStreams::SessionStreams(std::istream& input, std::ostream& output)
+    : prevIn_(currentIn), prevOut_(currentOut), prevTie_(input.tie(&output)) {
+    currentIn  = &input;
+    currentOut = &output;
+}
+
+SessionStreams::~SessionStreams() {
+    currentIn->tie(prevTie_);
+    currentIn  = prevIn_;
+    currentOut = prevOut_;
+}
+
 std::string trim(std::string s) {
     const auto notSpace = [](int ch) { return !std::isspace(ch); };
     s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
@@ -21,27 +57,37 @@ std::string trim(std::string s) {
 }
 
 std::string readLine(const std::string& prompt, bool allowEmpty) {
+    HMS_TRACE_SPAN("input.readLine", "input");
     for (;;) {
-        std::cout << prompt;
+        out() << prompt;
         std::string s;
-        std::getline(std::cin, s);
-        if (std::cin.fail()) {
-            std::cin.clear();
+        getLine(s);
+        if (in().fail()) {
+            in().clear();
             continue;
         }
         s = trim(s);
         if (!allowEmpty && s.empty()) {
-            std::cout << "Please enter a value.\n";
+            out() << "Please enter a value.\n";
             continue;
         }
         return s;
     }
 }
 
+std::string readRawLine() {
+    std::string s;
+    getLine(s);
+    if (in().fail()) in().clear();
+    return s;
+}
+
 std::string readPassword(const std::string& prompt) {
-    std::cout << prompt;
+    HMS_TRACE_SPAN("input.readPassword", "input");
+    out() << prompt;
     std::string pw;
 #if defined(_WIN32)
+    std::cout.flush(); // _getch bypasses std::cin, so the tie does not flush for us
     for (;;) {
         int ch = _getch();
         if (ch == '\r' || ch == '\n') { std::cout << "\n"; break; }
@@ -53,6 +99,13 @@ std::string readPassword(const std::string& prompt) {
         if (ch >= 32 && ch <= 126) pw.push_back(static_cast<char>(ch));
     }
 #else
+    if (&in() != &std::cin) {
+        out() << kEchoOffMarker << std::flush;
+        try { getLine(pw); }
+        catch (...) { out() << kEchoOnMarker << std::flush; throw; }
+        out() << kEchoOnMarker << "\n";
+        return pw;
+    }
     termios oldt{};
     tcgetattr(STDIN_FILENO, &oldt);
     termios newt = oldt;
@@ -60,47 +113,53 @@ std::string readPassword(const std::string& prompt) {
     tcsetattr(STDIN_FILENO, TCSANOW, &newt);
     std::getline(std::cin, pw);
     tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+    if (std::cin.eof() && pw.empty()) throw InputClosed();
     std::cout << "\n";
 #endif
     return pw;
 }
 
+void banner(std::ostream& out, const std::string& title) {
+    out << "\n==============================\n"
+        << "  " << title << "\n"
+        << "==============================\n";
+}
+
 void banner(const std::string& title) {
-    std::cout << "\n==============================\n";
-    std::cout << "  " << title << "\n";
-    std::cout << "==============================\n";
+    banner(out(), title);
 }
 
 void pause() {
-    std::cout << "Press Enter to continue...";
+    HMS_TRACE_SPAN("input.pause", "input");
+    out() << "Press Enter to continue...";
     std::string _;
-    std::getline(std::cin, _);
+    getLine(_);
 }
 
 }
 
 void ConsoleIO::println(const std::string& s) {
-    std::cout << s << '\n';
+    hms::ui::out() << s << '\n';
 }
 
 void ConsoleIO::print(const std::string& s) {
-    std::cout << s;
-    std::cout.flush();
+    // No explicit flush: in() is tied to out(), so pending output is
+    // flushed right before the next read anyway.
+    hms::ui::out() << s;
 }
 
 void ConsoleIO::waitKey() {
-    std::cout << "(Press Enter)";
-    std::cout.flush();
+    HMS_TRACE_SPAN("input.waitKey", "input");
+    hms::ui::out() << "(Press Enter)";
+    hms::ui::out().flush();
     std::string _;
-    std::getline(std::cin, _);
+    std::getline(hms::ui::in(), _);
+    if (hms::ui::in().eof() && _.empty()) throw hms::ui::InputClosed();
 }
 
 void ConsoleIO::clear() {
-#ifdef _WIN32
-    std::system("cls");
-#else
-    std::system("clear");
-#endif
+    hms::ui::enableAnsi();
+    hms::ui::writeFrame(hms::ui::kClearScreen);
 }
 
 int ConsoleIO::readInt() {
@@ -113,7 +172,7 @@ int ConsoleIO::readInt() {
         }
         catch (...) {
         }
-        std::cout << "Please enter a valid integer: ";
+        hms::ui::out() << "Please enter a valid integer: ";
     }
 }
 
@@ -127,7 +186,7 @@ long long ConsoleIO::readInt64() {
         }
         catch (...) {
         }
-        std::cout << "Please enter a valid 64-bit integer: ";
+        hms::ui::out() << "Please enter a valid 64-bit integer: ";
     }
 }
 
@@ -148,7 +207,7 @@ int ConsoleIO::readIntInRange(const std::string& prompt,
         catch (...) {
         }
 
-        std::cout << "Please enter a number between "
+        hms::ui::out() << "Please enter a number between "
                   << minInclusive << " and " << maxInclusive << ".\n";
     }
 }
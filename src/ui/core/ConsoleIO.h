@@ -1,11 +1,57 @@
 #pragma once
+#include <iosfwd>
+#include <stdexcept>
 #include <string>
 
 namespace hms::ui {
+    // Streams the screens read from and write to. They are std::cin and
+    // std::cout unless a SessionStreams on the calling thread says otherwise
+    // (server mode runs one session per thread, each on its own socket).
+    std::istream& in();
+    std::ostream& out();
+
+    // Points in()/out() of the current thread at `input`/`output` until
+    // destroyed; `input` is tied to `output` like std::cin to std::cout.
+    class SessionStreams {
+    public:
+        SessionStreams(std::istream& input, std::ostream& output);
+        ~SessionStreams();
+        SessionStreams(const SessionStreams&) = delete;
+        SessionStreams& operator=(const SessionStreams&) = delete;
+
+    private:
+        std::istream* prevIn_;
+        std::ostream* prevOut_;
+        std::ostream* prevTie_;
+    };
+
+    // The raw form of SessionStreams, for code that runs several sessions
+    // on one thread and switches between them: installs `next` as the
+    // current thread's in()/out() and returns what was installed before.
+    struct StreamBinding {
+        std::istream* in;
+        std::ostream* out;
+    };
+    StreamBinding exchangeStreams(StreamBinding next);
+
+    // Thrown by the read helpers when in() has no more input (end of file,
+    // or a server session whose client went away).
+    struct InputClosed : std::runtime_error {
+        InputClosed() : std::runtime_error("input closed") {}
+    };
+
+    // Sent instead of switching terminal echo when in() is not the local
+    // console; `hms --connect` turns local echo off and back on.
+    inline constexpr const char* kEchoOffMarker = "\x1b]hms;echo-off\x07";
+    inline constexpr const char* kEchoOnMarker  = "\x1b]hms;echo-on\x07";
+
     std::string trim(std::string s);
     std::string readLine(const std::string& prompt, bool allowEmpty=false);
     std::string readPassword(const std::string& prompt);
+    // One line from in() as typed: no prompt, not trimmed, may be empty.
+    std::string readRawLine();
     void        banner(const std::string& title);
+    void        banner(std::ostream& out, const std::string& title);
     void        pause();
 }
 
@@ -0,0 +1,74 @@
+#include "Flow.h"
+#include "../../diagnostics/Trace.h"
+
+#include <algorithm>
+
+namespace hms::ui {
+
+Task<std::string> FlowInput::readLine(std::string prompt, bool allowEmpty) {
+    HMS_TRACE_SPAN("input.readLine", "input");
+    for (;;) {
+        out() << prompt;
+        std::string s = trim(co_await line());
+        if (!allowEmpty && s.empty()) {
+            out() << "Please enter a value.\n";
+            continue;
+        }
+        co_return s;
+    }
+}
+
+Task<std::string> FlowInput::readPassword(std::string prompt) {
+    HMS_TRACE_SPAN("input.readPassword", "input");
+    out() << prompt;
+    co_return co_await secret();
+}
+
+Task<int> FlowInput::readIntInRange(std::string prompt, int minInclusive, int maxInclusive) {
+    if (minInclusive > maxInclusive) std::swap(minInclusive, maxInclusive);
+
+    for (;;) {
+        const std::string input = co_await readLine(prompt, /*allowEmpty=*/false);
+        try {
+            size_t idx = 0;
+            const int value = std::stoi(input, &idx, 10);
+            if (idx == input.size() && value >= minInclusive && value <= maxInclusive) {
+                co_return value;
+            }
+        }
+        catch (...) {
+        }
+
+        out() << "Please enter a number between "
+              << minInclusive << " and " << maxInclusive << ".\n";
+    }
+}
+
+Task<> FlowInput::pause() {
+    HMS_TRACE_SPAN("input.pause", "input");
+    out() << "Press Enter to continue...";
+    co_await line();
+}
+
+void FlowInput::supply(std::string line) {
+    queued_.push_back(std::move(line));
+    wake();
+}
+
+void FlowInput::close() {
+    closed_ = true;
+    wake();
+}
+
+std::string FlowInput::take() {
+    if (queued_.empty()) throw InputClosed();
+    std::string line = std::move(queued_.front());
+    queued_.pop_front();
+    return line;
+}
+
+void FlowInput::wake() {
+    if (auto waiter = std::exchange(waiter_, {})) waiter.resume();
+}
+
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include "ConsoleIO.h"
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hms::ui {
+
+    template <typename T = void>
+    class Task;
+
+    namespace detail {
+
+        struct TaskPromiseBase {
+            // On completion control goes back to whoever co_awaited the
+            // task; a task started by a driver just returns to it.
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+                    return self.promise().continuation;
+                }
+                void await_resume() const noexcept {}
+            };
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter        final_suspend() const noexcept { return {}; }
+            void                unhandled_exception() { error = std::current_exception(); }
+
+            std::coroutine_handle<> continuation{std::noop_coroutine()};
+            std::exception_ptr      error;
+        };
+
+        template <typename T>
+        struct TaskPromise : TaskPromiseBase {
+            Task<T> get_return_object();
+
+            template <typename U>
+            void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+            T take() {
+                if (error) std::rethrow_exception(error);
+                return std::move(*value);
+            }
+
+            std::optional<T> value;
+        };
+
+        template <>
+        struct TaskPromise<void> : TaskPromiseBase {
+            Task<void> get_return_object();
+
+            void return_void() {}
+
+            void take() {
+                if (error) std::rethrow_exception(error);
+            }
+        };
+
+    }
+
+    // A lazily started coroutine returning T. Inside a flow it is
+    // co_awaited like a function call; control passes straight to the
+    // awaiting coroutine when it finishes, so nesting does not grow the
+    // stack. Exceptions travel to the awaiter (or to result()).
+    template <typename T>
+    class [[nodiscard]] Task {
+    public:
+        using promise_type = detail::TaskPromise<T>;
+
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+        Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (handle_) handle_.destroy();
+                handle_ = std::exchange(other.handle_, {});
+            }
+            return *this;
+        }
+        ~Task() {
+            if (handle_) handle_.destroy();
+        }
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle_.promise().continuation = awaiting;
+            return handle_;
+        }
+        T await_resume() { return handle_.promise().take(); }
+
+        // Driver side: runs the task until it first waits for input (or
+        // finishes), then result() once done() is true.
+        void start() { handle_.resume(); }
+        bool done() const { return handle_.done(); }
+        T    result() { return handle_.promise().take(); }
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    namespace detail {
+
+        template <typename T>
+        Task<T> TaskPromise<T>::get_return_object() {
+            return Task<T>{std::coroutine_handle<TaskPromise<T>>::from_promise(*this)};
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() {
+            return Task<void>{std::coroutine_handle<TaskPromise<void>>::from_promise(*this)};
+        }
+
+    }
+
+    // The input side of a flow. A flow co_awaits lines; whoever drives it
+    // supplies them — the console (runBlocking), a fixed script
+    // (runScripted), or an event loop calling supply() as bytes arrive.
+    // The flow's own code is the same in every case. Output still goes to
+    // out().
+    class FlowInput {
+    public:
+        // What the flow is waiting for; a Secret should not be echoed.
+        enum class Kind { Line, Secret };
+
+        class Awaiter {
+        public:
+            Awaiter(FlowInput& input, Kind kind) : input_(input), kind_(kind) {}
+
+            bool await_ready() const noexcept { return !input_.queued_.empty() || input_.closed_; }
+            void await_suspend(std::coroutine_handle<> waiter) noexcept {
+                input_.waiter_     = waiter;
+                input_.waitingFor_ = kind_;
+            }
+            std::string await_resume() { return input_.take(); }
+
+        private:
+            FlowInput& input_;
+            Kind       kind_;
+        };
+
+        // The next line exactly as supplied. Throws InputClosed once the
+        // input is closed and drained.
+        Awaiter line()   { return {*this, Kind::Line}; }
+        Awaiter secret() { return {*this, Kind::Secret}; }
+
+        // Same prompts, retries and messages as the ConsoleIO helpers.
+        Task<std::string> readLine(std::string prompt, bool allowEmpty = false);
+        Task<std::string> readPassword(std::string prompt);
+        Task<int>         readIntInRange(std::string prompt, int minInclusive, int maxInclusive);
+        Task<>            pause();
+
+        // Driver side.
+        bool waiting() const { return static_cast<bool>(waiter_); }
+        Kind waitingFor() const { return waitingFor_; }
+
+        // Queues `line` and, if a flow is waiting, resumes it until it
+        // waits again or finishes.
+        void supply(std::string line);
+
+        // No more input will come: a waiting flow (and every later read)
+        // gets InputClosed once the queued lines are used up.
+        void close();
+
+    private:
+        std::string take();
+        void        wake();
+
+        std::deque<std::string> queued_;
+        bool                    closed_{false};
+        std::coroutine_handle<> waiter_;
+        Kind                    waitingFor_{Kind::Line};
+    };
+
+    // Drives `task` from in(): each time the flow waits, one line (or an
+    // unechoed password) is read and supplied. Behaves like the blocking
+    // ConsoleIO helpers, including InputClosed at end of input.
+    template <typename T>
+    T runBlocking(Task<T> task, FlowInput& input) {
+        task.start();
+        while (!task.done()) {
+            std::optional<std::string> line;
+            try {
+                line = input.waitingFor() == FlowInput::Kind::Secret ? ui::readPassword("") : readRawLine();
+            }
+            catch (const InputClosed&) {
+            }
+            if (line) input.supply(std::move(*line));
+            else input.close();
+        }
+        return task.result();
+    }
+
+    // Runs `task` against a fixed list of input lines. Running out of
+    // lines closes the input, so the flow sees InputClosed.
+    template <typename T>
+    T runScripted(Task<T> task, FlowInput& input, const std::vector<std::string>& lines) {
+        for (const auto& line : lines) input.supply(line);
+        input.close();
+        task.start();
+        return task.result();
+    }
+
+}
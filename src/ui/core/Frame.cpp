@@ -0,0 +1,54 @@
+#include "Frame.h"
+#include "ConsoleIO.h"
+
+#include <iostream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace hms::ui {
+
+void enableAnsi() {
+#if defined(_WIN32)
+    static const bool enabled = [] {
+        HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        if (out == INVALID_HANDLE_VALUE || !GetConsoleMode(out, &mode)) return false;
+        return SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+    }();
+    (void)enabled;
+#endif
+}
+
+void writeFrame(std::string_view bytes) {
+    if (bytes.empty()) return;
+    out().write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    out().flush();
+}
+
+Frame::Frame(bool clearScreen)
+    : clearScreen_(clearScreen) {
+    if (clearScreen_) enableAnsi();
+}
+
+Frame::~Frame() {
+    try { present(); }
+    catch (...) {}
+}
+
+void Frame::present() {
+    std::string payload;
+    if (clearScreen_) {
+        payload.append(kClearScreen);
+        clearScreen_ = false;
+    }
+    payload += str();
+    str(std::string{});
+    writeFrame(payload);
+}
+
+}
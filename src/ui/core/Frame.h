@@ -0,0 +1,35 @@
+#pragma once
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace hms::ui {
+
+    // ANSI "erase display + cursor home". Used instead of spawning `clear`/`cls`.
+    inline constexpr std::string_view kClearScreen = "\x1b[2J\x1b[H";
+
+    // Buffers one screen worth of output in memory and hands it to the terminal
+    // in a single write. Tables and listings render into a Frame so a page is
+    // not streamed to the terminal row by row (thousands of tiny writes over SSH).
+    class Frame : public std::ostringstream {
+    public:
+        explicit Frame(bool clearScreen = false);
+        ~Frame() override;
+
+        Frame(const Frame&)            = delete;
+        Frame& operator=(const Frame&) = delete;
+
+        // Writes everything buffered so far and empties the buffer.
+        // Called automatically on destruction.
+        void present();
+
+    private:
+        bool clearScreen_;
+    };
+
+    // Writes `bytes` to the terminal as one chunk and flushes.
+    void writeFrame(std::string_view bytes);
+
+    // Makes sure the terminal interprets ANSI escape sequences (no-op on POSIX).
+    void enableAnsi();
+}
@@ -1,10 +1,18 @@
 #include "DashboardAdmin.h"
 #include "../core/ConsoleIO.h"
+#include "../core/Flow.h"
+#include "../core/Frame.h"
+#include "../../models/BookingMetrics.h"
+#include "../../storage/BookingExport.h"
+#include "../../diagnostics/Metrics.h"
+#include "../../diagnostics/Trace.h"
 #include <algorithm>
 #include <cctype>
 #include <cstdint>
 #include <cstdlib>
 #include <ctime>
+#include <filesystem>
+#include <system_error>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -23,9 +31,14 @@ using hms::Hotel;
 using hms::RestaurantOrderLine;
 using hms::Room;
 using hms::RoomStayItem;
+using hms::summarize;
+using hms::ui::FlowInput;
+using hms::ui::Frame;
+using hms::ui::Task;
 using hms::ui::banner;
-using hms::ui::pause;
-using hms::ui::readLine;
+using hms::ui::out;
+
+constexpr std::size_t kPageSize = 20;
 
 std::string trimCopy(std::string s) {
     const auto notSpace = [](int ch) { return !std::isspace(ch); };
@@ -88,9 +101,10 @@ std::string bookingStatusToString(BookingStatus status) {
 std::string nextHotelId(const hms::HotelRepository& repo) {
     int maxValue = 0;
     for (const auto& hotel : repo.list()) {
-        const auto pos = hotel.id.find_last_of('-');
-        if (pos == std::string::npos) continue;
-        const auto tail = hotel.id.substr(pos + 1);
+        const std::string_view id = hotel.id;
+        const auto pos = id.find_last_of('-');
+        if (pos == std::string_view::npos) continue;
+        const std::string tail{id.substr(pos + 1)};
         if (const auto number = parseInt(tail)) {
             maxValue = std::max(maxValue, *number);
         }
@@ -121,21 +135,49 @@ std::vector<std::string> splitAmenities(const std::string& text) {
     return out;
 }
 
-std::string hotelDisplayName(AppContext& ctx, const std::string& hotelId) {
+enum class PageCommand { Next, Previous, Back, Row, Invalid };
+
+// Reads the navigation choice shown under a paged listing: "n", "p", "0" or
+// (when rows are selectable) a row number.
+Task<PageCommand> readPageCommand(bool hasNext, bool hasPrevious, bool selectable, int& row, FlowInput& input) {
+    auto command = co_await input.readLine("Select: ");
+    std::transform(command.begin(), command.end(), command.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    if (command == "n" && hasNext) co_return PageCommand::Next;
+    if (command == "p" && hasPrevious) co_return PageCommand::Previous;
+    if (command == "0") co_return PageCommand::Back;
+    if (selectable) {
+        if (const auto parsed = parseInt(command)) {
+            row = *parsed;
+            co_return PageCommand::Row;
+        }
+    }
+    co_return PageCommand::Invalid;
+}
+
+void renderPageFooter(std::ostream& out, bool hasNext, bool hasPrevious, bool selectable) {
+    out << '\n';
+    if (selectable) out << "Enter a number from the list to select it.\n";
+    if (hasNext) out << "n) Next page\n";
+    if (hasPrevious) out << "p) Previous page\n";
+    out << "0) Back\n";
+}
+
+std::string hotelDisplayName(AppContext& ctx, const hms::HotelId& hotelId) {
     if (auto hotel = ctx.svc.hotels->get(hotelId)) {
         return hotel->name + " (" + hotel->id + ")";
     }
-    return hotelId;
+    return hotelId.str();
 }
 
-bool hasBlockingBookings(AppContext& ctx, const std::string& hotelId) {
+bool hasBlockingBookings(AppContext& ctx, const hms::HotelId& hotelId) {
     for (const auto& booking : ctx.svc.bookings->listByHotel(hotelId)) {
         if (booking.status != BookingStatus::CANCELLED) return true;
     }
     return false;
 }
 
-bool roomHasBlockingBookings(AppContext& ctx, const std::string& hotelId, int roomNumber) {
+bool roomHasBlockingBookings(AppContext& ctx, const hms::HotelId& hotelId, int roomNumber) {
     for (const auto& booking : ctx.svc.bookings->listByHotel(hotelId)) {
         if (booking.status == BookingStatus::CANCELLED) continue;
         for (const auto& item : booking.items) {
@@ -149,27 +191,26 @@ bool roomHasBlockingBookings(AppContext& ctx, const std::string& hotelId, int ro
     return false;
 }
 
-void listHotels(AppContext& ctx) {
-    banner("Hotels");
-    auto hotels = ctx.svc.hotels->list();
+Task<> listHotels(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.listHotels", "action");
+    Frame frame;
+    banner(frame, "Hotels");
+    const auto hotels = ctx.svc.hotels->listOrderedById();
     if (hotels.empty()) {
-        std::cout << "No hotels found.\n";
-        pause();
-        return;
+        frame << "No hotels found.\n";
+        frame.present();
+        co_await input.pause();
+        co_return;
     }
 
-    std::sort(hotels.begin(), hotels.end(), [](const Hotel& a, const Hotel& b) {
-        return a.id < b.id;
-    });
-
-    std::cout << std::left
-              << std::setw(6)  << "#"
-              << std::setw(12) << "ID"
-              << std::setw(30) << "Name"
-              << std::setw(8)  << "Stars"
-              << std::setw(12) << "Rooms"
-              << "Address" << '\n';
-    std::cout << std::string(90, '-') << '\n';
+    frame << std::left
+          << std::setw(6)  << "#"
+          << std::setw(12) << "ID"
+          << std::setw(30) << "Name"
+          << std::setw(8)  << "Stars"
+          << std::setw(12) << "Rooms"
+          << "Address" << '\n';
+    frame << std::string(90, '-') << '\n';
 
     for (std::size_t i = 0; i < hotels.size(); ++i) {
         const auto& hotel = hotels[i];
@@ -178,33 +219,35 @@ void listHotels(AppContext& ctx) {
         std::ostringstream roomsSummary;
         roomsSummary << activeRooms << "/" << roomsForHotel.size();
 
-        std::cout << std::left
-                  << std::setw(6)  << (i + 1)
-                  << std::setw(12) << hotel.id
-                  << std::setw(30) << hotel.name
-                  << std::setw(8)  << static_cast<int>(hotel.stars)
-                  << std::setw(12) << roomsSummary.str()
-                  << hotel.address << '\n';
+        frame << std::left
+              << std::setw(6)  << (i + 1)
+              << std::setw(12) << hotel.id
+              << std::setw(30) << hotel.name
+              << std::setw(8)  << static_cast<int>(hotel.stars)
+              << std::setw(12) << roomsSummary.str()
+              << hotel.address << '\n';
     }
 
-    pause();
+    frame.present();
+    co_await input.pause();
 }
 
-void createHotel(AppContext& ctx) {
+Task<> createHotel(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.createHotel", "action");
     banner("Create hotel");
-    const std::string name = readLine("Hotel name: ");
-    const std::string address = readLine("Address: ");
+    const std::string name = co_await input.readLine("Hotel name: ");
+    const std::string address = co_await input.readLine("Address: ");
 
     int stars = 0;
     for (;;) {
-        const auto value = readLine("Star rating (1-5): ");
+        const auto value = co_await input.readLine("Star rating (1-5): ");
         if (const auto parsed = parseInt(value)) {
             if (*parsed >= 1 && *parsed <= 5) {
                 stars = *parsed;
                 break;
             }
         }
-        std::cout << "Please enter a value between 1 and 5.\n";
+        out() << "Please enter a value between 1 and 5.\n";
     }
 
     Hotel hotel{};
@@ -216,186 +259,218 @@ void createHotel(AppContext& ctx) {
     ctx.svc.hotels->upsert(hotel);
     ctx.svc.hotels->saveAll();
 
-    std::cout << "Hotel created with ID " << hotel.id << "\n";
-    pause();
+    out() << "Hotel created with ID " << hotel.id << "\n";
+    co_await input.pause();
 }
 
-void editHotel(AppContext& ctx) {
+Task<> editHotel(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.editHotel", "action");
     banner("Edit hotel");
-    const std::string id = readLine("Hotel ID: ");
+    const std::string id = co_await input.readLine("Hotel ID: ");
     auto hotelOpt = ctx.svc.hotels->get(id);
     if (!hotelOpt) {
-        std::cout << "Hotel not found.\n";
-        pause();
-        return;
+        out() << "Hotel not found.\n";
+        co_await input.pause();
+        co_return;
     }
 
     auto hotel = *hotelOpt;
-    std::cout << "Editing " << hotel.name << " (" << hotel.id << ")\n";
+    out() << "Editing " << hotel.name << " (" << hotel.id << ")\n";
 
-    const std::string name = readLine("Name [" + hotel.name + "]: ", true);
+    const std::string name = co_await input.readLine("Name [" + hotel.name + "]: ", true);
     if (!name.empty()) hotel.name = name;
 
-    const std::string address = readLine("Address [" + hotel.address + "]: ", true);
+    const std::string address = co_await input.readLine("Address [" + hotel.address + "]: ", true);
     if (!address.empty()) hotel.address = address;
 
-    const std::string starsStr = readLine(
+    const std::string starsStr = co_await input.readLine(
         "Stars (1-5) [" + std::to_string(static_cast<int>(hotel.stars)) + "]: ", true);
     if (!starsStr.empty()) {
         if (const auto parsed = parseInt(starsStr); parsed && *parsed >= 1 && *parsed <= 5) {
             hotel.stars = static_cast<std::uint8_t>(*parsed);
         }
         else {
-            std::cout << "Invalid star value. Keeping previous setting.\n";
+            out() << "Invalid star value. Keeping previous setting.\n";
         }
     }
 
     ctx.svc.hotels->upsert(hotel);
     ctx.svc.hotels->saveAll();
 
-    std::cout << "Hotel updated.\n";
-    pause();
+    out() << "Hotel updated.\n";
+    co_await input.pause();
 }
 
-void removeHotel(AppContext& ctx) {
+Task<> removeHotel(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.removeHotel", "action");
     banner("Remove hotel");
-    const std::string id = readLine("Hotel ID: ");
+    const std::string id = co_await input.readLine("Hotel ID: ");
     auto hotelOpt = ctx.svc.hotels->get(id);
     if (!hotelOpt) {
-        std::cout << "Hotel not found.\n";
-        pause();
-        return;
+        out() << "Hotel not found.\n";
+        co_await input.pause();
+        co_return;
     }
 
     const auto& hotel = *hotelOpt;
     const auto roomCount = ctx.svc.rooms->listByHotel(hotel.id).size();
     if (roomCount > 0) {
-        std::cout << "This hotel still has " << roomCount << " rooms. Remove rooms first.\n";
-        pause();
-        return;
+        out() << "This hotel still has " << roomCount << " rooms. Remove rooms first.\n";
+        co_await input.pause();
+        co_return;
     }
 
     if (hasBlockingBookings(ctx, hotel.id)) {
-        std::cout << "Active or completed bookings exist for this hotel. Deactivate instead of removing.\n";
-        pause();
-        return;
+        out() << "Active or completed bookings exist for this hotel. Deactivate instead of removing.\n";
+        co_await input.pause();
+        co_return;
     }
 
-    const std::string confirmation = readLine("Type DELETE to confirm removal: ");
+    const std::string confirmation = co_await input.readLine("Type DELETE to confirm removal: ");
     if (confirmation != "DELETE") {
-        std::cout << "Cancellation confirmed.\n";
-        pause();
-        return;
+        out() << "Cancellation confirmed.\n";
+        co_await input.pause();
+        co_return;
     }
 
     if (!ctx.svc.hotels->remove(hotel.id)) {
-        std::cout << "Failed to remove hotel.\n";
-        pause();
-        return;
+        out() << "Failed to remove hotel.\n";
+        co_await input.pause();
+        co_return;
     }
 
     ctx.svc.hotels->saveAll();
-    std::cout << "Hotel removed.\n";
-    pause();
+    out() << "Hotel removed.\n";
+    co_await input.pause();
 }
 
-void manageHotels(AppContext& ctx) {
+Task<> manageHotels(AppContext& ctx, FlowInput& input) {
     for (;;) {
         banner("Hotel management");
-        std::cout << "1) List hotels\n";
-        std::cout << "2) Add hotel\n";
-        std::cout << "3) Edit hotel\n";
-        std::cout << "4) Remove hotel\n";
-        std::cout << "0) Back\n";
-        const int choice = ConsoleIO::readIntInRange("Select: ", 0, 4);
-
-        if (choice == 0) return;
-        if (choice == 1) { listHotels(ctx); continue; }
-        if (choice == 2) { createHotel(ctx); continue; }
-        if (choice == 3) { editHotel(ctx); continue; }
-        if (choice == 4) { removeHotel(ctx); continue; }
+        out() << "1) List hotels\n";
+        out() << "2) Add hotel\n";
+        out() << "3) Edit hotel\n";
+        out() << "4) Remove hotel\n";
+        out() << "0) Back\n";
+        const int choice = co_await input.readIntInRange("Select: ", 0, 4);
+
+        if (choice == 0) co_return;
+        if (choice == 1) { co_await listHotels(ctx, input); continue; }
+        if (choice == 2) { co_await createHotel(ctx, input); continue; }
+        if (choice == 3) { co_await editHotel(ctx, input); continue; }
+        if (choice == 4) { co_await removeHotel(ctx, input); continue; }
     }
 }
 
-void listRoomsForHotel(AppContext& ctx, const Hotel& hotel) {
-    banner("Rooms for " + hotel.name);
-    auto rooms = ctx.svc.rooms->listByHotel(hotel.id);
-    if (rooms.empty()) {
-        std::cout << "No rooms configured for this hotel yet.\n";
-        pause();
-        return;
-    }
+Task<> listRoomsForHotel(AppContext& ctx, const Hotel& hotel, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.listRoomsForHotel", "action");
+    // Last room number of each page visited before the current one.
+    std::vector<std::optional<int>> trail{std::nullopt};
 
-    std::sort(rooms.begin(), rooms.end(), [](const Room& a, const Room& b) {
-        return a.number < b.number;
-    });
+    for (;;) {
+        const auto page = ctx.svc.rooms->listByHotelPage(hotel.id, trail.back(), kPageSize);
+        const bool hasNext = page.next.has_value();
+        const bool hasPrevious = trail.size() > 1;
+
+        Frame frame;
+        banner(frame, "Rooms for " + hotel.name);
+        if (page.items.empty() && !hasPrevious) {
+            frame << "No rooms configured for this hotel yet.\n";
+            frame.present();
+            co_await input.pause();
+            co_return;
+        }
 
-    std::cout << std::left
+        frame << std::left
               << std::setw(8)  << "Room"
               << std::setw(10) << "Type"
               << std::setw(8)  << "Beds"
               << std::setw(10) << "Size"
               << std::setw(10) << "Active"
               << "Amenities" << '\n';
-    std::cout << std::string(80, '-') << '\n';
+        frame << std::string(80, '-') << '\n';
 
-    for (const auto& room : rooms) {
-        std::cout << std::left
+        for (const auto& room : page.items) {
+            frame << std::left
                   << std::setw(8)  << room.number
                   << std::setw(10) << room.typeId
                   << std::setw(8)  << room.beds
                   << std::setw(10) << room.sizeSqm
                   << std::setw(10) << (room.active ? "Yes" : "No")
                   << join(room.amenities, ", ") << '\n';
-        if (!room.notes.empty()) {
-            std::cout << "    Notes: " << room.notes << '\n';
+            if (!room.notes.empty()) {
+                frame << "    Notes: " << room.notes << '\n';
+            }
         }
-    }
 
-    pause();
+        if (!hasNext && !hasPrevious) {
+            frame.present();
+            co_await input.pause();
+            co_return;
+        }
+
+        renderPageFooter(frame, hasNext, hasPrevious, /*selectable=*/false);
+        frame.present();
+
+        int row = 0;
+        switch (co_await readPageCommand(hasNext, hasPrevious, /*selectable=*/false, row, input)) {
+            case PageCommand::Next:     trail.push_back(page.next); continue;
+            case PageCommand::Previous: trail.pop_back(); continue;
+            case PageCommand::Back:     co_return;
+            case PageCommand::Row:
+            case PageCommand::Invalid:  break;
+        }
+        out() << "Invalid selection.\n";
+    }
 }
 
-void addRoom(AppContext& ctx, const Hotel& hotel) {
+Task<> addRoom(AppContext& ctx, const Hotel& hotel, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.addRoom", "action");
     banner("Add room to " + hotel.name);
     int number = 0;
     for (;;) {
-        const auto value = readLine("Room number: ");
+        const auto value = co_await input.readLine("Room number: ");
         if (const auto parsed = parseInt(value); parsed && *parsed > 0) {
             number = *parsed;
             if (ctx.svc.rooms->get(hotel.id, number)) {
-                std::cout << "Room already exists. Choose another number.\n";
+                out() << "Room already exists. Choose another number.\n";
                 continue;
             }
             break;
         }
-        std::cout << "Enter a positive integer.\n";
+        out() << "Enter a positive integer.\n";
     }
 
-    const std::string typeId = readLine("Type (STANDARD/DELUXE/SUITE/...): ");
+    std::string knownTypes;
+    for (const auto& type : ctx.svc.pricing->listTypes()) {
+        if (!knownTypes.empty()) knownTypes += "/";
+        knownTypes += type.id;
+    }
+    const std::string typeId = co_await input.readLine("Type (" + knownTypes + "/...): ");
 
     int beds = 1;
     for (;;) {
-        const auto value = readLine("Beds: ");
+        const auto value = co_await input.readLine("Beds: ");
         if (const auto parsed = parseInt(value); parsed && *parsed > 0) {
             beds = *parsed;
             break;
         }
-        std::cout << "Enter a positive integer.\n";
+        out() << "Enter a positive integer.\n";
     }
 
     int sizeSqm = 0;
     for (;;) {
-        const auto value = readLine("Size in sqm: ");
+        const auto value = co_await input.readLine("Size in sqm: ");
         if (const auto parsed = parseInt(value); parsed && *parsed > 0) {
             sizeSqm = *parsed;
             break;
         }
-        std::cout << "Enter a positive integer.\n";
+        out() << "Enter a positive integer.\n";
     }
 
-    const std::string amenitiesStr = readLine("Amenities (comma separated): ", true);
+    const std::string amenitiesStr = co_await input.readLine("Amenities (comma separated): ", true);
     const auto amenities = splitAmenities(amenitiesStr);
-    const std::string notes = readLine("Notes (optional): ", true);
+    const std::string notes = co_await input.readLine("Notes (optional): ", true);
 
     Room room{};
     room.hotelId = hotel.id;
@@ -410,74 +485,78 @@ void addRoom(AppContext& ctx, const Hotel& hotel) {
 
     ctx.svc.rooms->upsert(room);
     ctx.svc.rooms->saveAll();
+    ctx.svc.pricing->invalidateRoom(room.id);
 
-    std::cout << "Room " << number << " created.\n";
-    pause();
+    out() << "Room " << number << " created.\n";
+    co_await input.pause();
 }
 
-void editRoom(AppContext& ctx, const Hotel& hotel) {
+Task<> editRoom(AppContext& ctx, const Hotel& hotel, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.editRoom", "action");
     banner("Edit room - " + hotel.name);
     std::optional<Room> roomOpt;
     int roomNumber = 0;
     for (;;) {
-        roomNumber = ConsoleIO::readIntInRange(
+        roomNumber = co_await input.readIntInRange(
             "Room number (0 to cancel): ", 0, std::numeric_limits<int>::max());
-        if (roomNumber == 0) return;
+        if (roomNumber == 0) co_return;
         roomOpt = ctx.svc.rooms->get(hotel.id, roomNumber);
         if (roomOpt) break;
-        std::cout << "Room not found. Try again.\n";
+        out() << "Room not found. Try again.\n";
     }
 
     auto room = *roomOpt;
-    std::cout << "Updating room " << room.number << "\n";
+    out() << "Updating room " << room.number << "\n";
 
-    const std::string type = readLine("Type [" + room.typeId + "]: ", true);
+    const std::string type = co_await input.readLine("Type [" + room.typeId + "]: ", true);
     if (!type.empty()) room.typeId = type;
 
-    const std::string bedsStr = readLine("Beds [" + std::to_string(room.beds) + "]: ", true);
+    const std::string bedsStr = co_await input.readLine("Beds [" + std::to_string(room.beds) + "]: ", true);
     if (!bedsStr.empty()) {
         if (const auto bedsParsed = parseInt(bedsStr); bedsParsed && *bedsParsed > 0) {
             room.beds = *bedsParsed;
         }
         else {
-            std::cout << "Invalid beds value. Keeping previous setting.\n";
+            out() << "Invalid beds value. Keeping previous setting.\n";
         }
     }
 
-    const std::string sizeStr = readLine("Size sqm [" + std::to_string(room.sizeSqm) + "]: ", true);
+    const std::string sizeStr = co_await input.readLine("Size sqm [" + std::to_string(room.sizeSqm) + "]: ", true);
     if (!sizeStr.empty()) {
         if (const auto sizeParsed = parseInt(sizeStr); sizeParsed && *sizeParsed > 0) {
             room.sizeSqm = *sizeParsed;
         }
         else {
-            std::cout << "Invalid size. Keeping previous setting.\n";
+            out() << "Invalid size. Keeping previous setting.\n";
         }
     }
 
-    const std::string amenitiesStr = readLine(
+    const std::string amenitiesStr = co_await input.readLine(
         "Amenities (comma list) [" + join(room.amenities, ", ") + "]: ", true);
     if (!amenitiesStr.empty()) room.amenities = splitAmenities(amenitiesStr);
 
-    const std::string notes = readLine("Notes [" + room.notes + "]: ", true);
+    const std::string notes = co_await input.readLine("Notes [" + room.notes + "]: ", true);
     if (!notes.empty()) room.notes = notes;
 
     ctx.svc.rooms->upsert(room);
     ctx.svc.rooms->saveAll();
+    ctx.svc.pricing->invalidateRoom(room.id);
 
-    std::cout << "Room updated.\n";
-    pause();
+    out() << "Room updated.\n";
+    co_await input.pause();
 }
 
-void toggleRoomAvailability(AppContext& ctx, const Hotel& hotel) {
+Task<> toggleRoomAvailability(AppContext& ctx, const Hotel& hotel, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.toggleRoomAvailability", "action");
     banner("Toggle room availability");
     for (;;) {
-        const int roomNumber = ConsoleIO::readIntInRange(
+        const int roomNumber = co_await input.readIntInRange(
             "Room number (0 to cancel): ", 0, std::numeric_limits<int>::max());
-        if (roomNumber == 0) return;
+        if (roomNumber == 0) co_return;
 
         auto roomOpt = ctx.svc.rooms->get(hotel.id, roomNumber);
         if (!roomOpt) {
-            std::cout << "Room not found. Try again.\n";
+            out() << "Room not found. Try again.\n";
             continue;
         }
 
@@ -485,151 +564,136 @@ void toggleRoomAvailability(AppContext& ctx, const Hotel& hotel) {
         room.active = !room.active;
         ctx.svc.rooms->upsert(room);
         ctx.svc.rooms->saveAll();
+        ctx.svc.pricing->invalidateRoom(room.id);
 
-        std::cout << "Room " << room.number
+        out() << "Room " << room.number
                   << (room.active ? " activated." : " deactivated.") << "\n";
-        pause();
-        return;
+        co_await input.pause();
+        co_return;
     }
 }
 
-void removeRoom(AppContext& ctx, const Hotel& hotel) {
+Task<> removeRoom(AppContext& ctx, const Hotel& hotel, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.removeRoom", "action");
     banner("Remove room");
     for (;;) {
-        const int roomNumber = ConsoleIO::readIntInRange(
+        const int roomNumber = co_await input.readIntInRange(
             "Room number (0 to cancel): ", 0, std::numeric_limits<int>::max());
-        if (roomNumber == 0) return;
+        if (roomNumber == 0) co_return;
 
         if (roomHasBlockingBookings(ctx, hotel.id, roomNumber)) {
-            std::cout << "This room has bookings attached. Set to inactive instead.\n";
-            pause();
-            return;
+            out() << "This room has bookings attached. Set to inactive instead.\n";
+            co_await input.pause();
+            co_return;
         }
 
-        if (!ctx.svc.rooms->remove(hotel.id, roomNumber)) {
-            std::cout << "Room not found. Try again.\n";
+        const auto removed = ctx.svc.rooms->get(hotel.id, roomNumber);
+        if (!removed || !ctx.svc.rooms->remove(hotel.id, roomNumber)) {
+            out() << "Room not found. Try again.\n";
             continue;
         }
+        ctx.svc.pricing->invalidateRoom(removed->id);
 
         ctx.svc.rooms->saveAll();
-        std::cout << "Room removed.\n";
-        pause();
-        return;
+        out() << "Room removed.\n";
+        co_await input.pause();
+        co_return;
     }
 }
 
-void manageRoomsForHotel(AppContext& ctx, const Hotel& hotel) {
+Task<> manageRoomsForHotel(AppContext& ctx, const Hotel& hotel, FlowInput& input) {
     for (;;) {
         banner("Rooms - " + hotel.name);
-        std::cout << "1) List rooms\n";
-        std::cout << "2) Add room\n";
-        std::cout << "3) Edit room\n";
-        std::cout << "4) Toggle availability\n";
-        std::cout << "5) Remove room\n";
-        std::cout << "0) Back\n";
-        const int choice = ConsoleIO::readIntInRange("Select: ", 0, 5);
-
-        if (choice == 0) return;
-        if (choice == 1) { listRoomsForHotel(ctx, hotel); continue; }
-        if (choice == 2) { addRoom(ctx, hotel); continue; }
-        if (choice == 3) { editRoom(ctx, hotel); continue; }
-        if (choice == 4) { toggleRoomAvailability(ctx, hotel); continue; }
-        if (choice == 5) { removeRoom(ctx, hotel); continue; }
+        out() << "1) List rooms\n";
+        out() << "2) Add room\n";
+        out() << "3) Edit room\n";
+        out() << "4) Toggle availability\n";
+        out() << "5) Remove room\n";
+        out() << "0) Back\n";
+        const int choice = co_await input.readIntInRange("Select: ", 0, 5);
+
+        if (choice == 0) co_return;
+        if (choice == 1) { co_await listRoomsForHotel(ctx, hotel, input); continue; }
+        if (choice == 2) { co_await addRoom(ctx, hotel, input); continue; }
+        if (choice == 3) { co_await editRoom(ctx, hotel, input); continue; }
+        if (choice == 4) { co_await toggleRoomAvailability(ctx, hotel, input); continue; }
+        if (choice == 5) { co_await removeRoom(ctx, hotel, input); continue; }
     }
 }
 
-void manageRooms(AppContext& ctx) {
+Task<> manageRooms(AppContext& ctx, FlowInput& input) {
     for (;;) {
-        auto hotels = ctx.svc.hotels->list();
+        const auto hotels = ctx.svc.hotels->listOrderedByName();
         if (hotels.empty()) {
             banner("Room management");
-            std::cout << "Create a hotel before managing rooms.\n";
-            pause();
-            return;
+            out() << "Create a hotel before managing rooms.\n";
+            co_await input.pause();
+            co_return;
         }
 
-        std::sort(hotels.begin(), hotels.end(), [](const Hotel& a, const Hotel& b) {
-            return a.name < b.name;
-        });
-
         banner("Select hotel");
         for (std::size_t i = 0; i < hotels.size(); ++i) {
-            std::cout << (i + 1) << ") " << hotels[i].name << " (" << hotels[i].id << ")\n";
+            out() << (i + 1) << ") " << hotels[i].name << " (" << hotels[i].id << ")\n";
         }
-        std::cout << "0) Back\n";
+        out() << "0) Back\n";
 
-        const int choice = ConsoleIO::readIntInRange(
+        const int choice = co_await input.readIntInRange(
             "Hotel: ", 0, static_cast<int>(hotels.size()));
-        if (choice == 0) return;
+        if (choice == 0) co_return;
 
-        manageRoomsForHotel(ctx, hotels[static_cast<std::size_t>(choice) - 1]);
+        co_await manageRoomsForHotel(ctx, hotels[static_cast<std::size_t>(choice) - 1], input);
     }
 }
 
-void inspectRooms(AppContext& ctx) {
+Task<> inspectRooms(AppContext& ctx, FlowInput& input) {
     for (;;) {
-        auto hotels = ctx.svc.hotels->list();
+        const auto hotels = ctx.svc.hotels->listOrderedByName();
         if (hotels.empty()) {
             banner("Inspect rooms");
-            std::cout << "No hotels configured yet.\n";
-            pause();
-            return;
+            out() << "No hotels configured yet.\n";
+            co_await input.pause();
+            co_return;
         }
 
-        std::sort(hotels.begin(), hotels.end(), [](const Hotel& a, const Hotel& b) {
-            return a.name < b.name;
-        });
-
         banner("Inspect rooms");
-        std::cout << "Select a hotel to view its rooms:\n";
+        out() << "Select a hotel to view its rooms:\n";
         for (std::size_t i = 0; i < hotels.size(); ++i) {
-            std::cout << (i + 1) << ") " << hotels[i].name << " (" << hotels[i].id << ")\n";
+            out() << (i + 1) << ") " << hotels[i].name << " (" << hotels[i].id << ")\n";
         }
-        std::cout << "0) Back\n";
+        out() << "0) Back\n";
 
-        const int choice = ConsoleIO::readIntInRange(
+        const int choice = co_await input.readIntInRange(
             "Hotel: ", 0, static_cast<int>(hotels.size()));
-        if (choice == 0) return;
+        if (choice == 0) co_return;
 
-        listRoomsForHotel(ctx, hotels[static_cast<std::size_t>(choice) - 1]);
+        co_await listRoomsForHotel(ctx, hotels[static_cast<std::size_t>(choice) - 1], input);
     }
 }
 
-struct BookingMetrics {
-    int rooms{};
-    int roomNights{};
-    int guests{};
-    std::int64_t roomRevenue{};
-    std::int64_t diningRevenue{};
-};
+// Walks the booking history one page at a time, newest first. Only the page on
+// screen is fetched, so the cost does not depend on how many bookings exist.
+// With `selectable` the chosen booking is returned fresh from the repository.
+Task<std::optional<Booking>> browseBookings(AppContext& ctx, const std::string& title, bool selectable, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.browseBookings", "action");
+    // Cursor that produced each visited page; the first page has none.
+    std::vector<std::optional<hms::BookingCursor>> trail{std::nullopt};
 
-BookingMetrics summarize(const Booking& booking) {
-    BookingMetrics metrics{};
-    for (const auto& item : booking.items) {
-        if (std::holds_alternative<RoomStayItem>(item)) {
-            const auto& stay = std::get<RoomStayItem>(item);
-            ++metrics.rooms;
-            metrics.roomNights += stay.nights;
-            metrics.roomRevenue += stay.nightlyRateLocked * stay.nights;
-            metrics.guests += static_cast<int>(stay.occupants.size());
-        }
-        else if (std::holds_alternative<RestaurantOrderLine>(item)) {
-            const auto& order = std::get<RestaurantOrderLine>(item);
-            metrics.diningRevenue += order.unitPriceSnapshot * order.qty;
+    for (;;) {
+        const auto page = ctx.svc.bookings->listPage(trail.back(), kPageSize);
+        const std::size_t firstRow = (trail.size() - 1) * kPageSize;
+        const bool hasNext = page.next.has_value();
+        const bool hasPrevious = trail.size() > 1;
+
+        Frame frame;
+        banner(frame, title);
+        if (page.items.empty() && !hasPrevious) {
+            frame << "No bookings on record.\n";
+            frame.present();
+            co_await input.pause();
+            co_return std::nullopt;
         }
-    }
-    return metrics;
-}
-
-void listBookings(AppContext& ctx, const std::vector<Booking>& sorted) {
-    banner("Bookings");
-    if (sorted.empty()) {
-        std::cout << "No bookings on record.\n";
-        pause();
-        return;
-    }
 
-    std::cout << std::left
+        frame << std::left
               << std::setw(6)  << "#"
               << std::setw(12) << "Booking"
               << std::setw(28) << "Hotel"
@@ -638,17 +702,17 @@ void listBookings(AppContext& ctx, const std::vector<Booking>& sorted) {
               << std::setw(12) << "Rooms"
               << std::setw(16) << "Revenue"
               << "Created" << '\n';
-    std::cout << std::string(110, '-') << '\n';
+        frame << std::string(110, '-') << '\n';
 
-    for (std::size_t i = 0; i < sorted.size(); ++i) {
-        const auto& booking = sorted[i];
-        const auto metrics = summarize(booking);
-        const std::string hotelName = hotelDisplayName(ctx, booking.hotelId);
-        const std::string created = formatTimestamp(booking.createdAt);
-        const std::int64_t revenue = metrics.roomRevenue + metrics.diningRevenue;
+        for (std::size_t i = 0; i < page.items.size(); ++i) {
+            const auto& booking = page.items[i];
+            const auto metrics = summarize(booking);
+            const std::string hotelName = hotelDisplayName(ctx, booking.hotelId);
+            const std::string created = formatTimestamp(booking.createdAt);
+            const std::int64_t revenue = metrics.roomRevenue + metrics.diningRevenue;
 
-        std::cout << std::left
-                  << std::setw(6)  << (i + 1)
+            frame << std::left
+                  << std::setw(6)  << (firstRow + i + 1)
                   << std::setw(12) << booking.bookingId
                   << std::setw(28) << hotelName.substr(0, 27)
                   << std::setw(14) << bookingStatusToString(booking.status)
@@ -656,265 +720,462 @@ void listBookings(AppContext& ctx, const std::vector<Booking>& sorted) {
                   << std::setw(12) << metrics.rooms
                   << std::setw(16) << formatMoney(revenue)
                   << created << '\n';
-    }
-
-    pause();
-}
+        }
 
-std::optional<Booking> pickBooking(AppContext& ctx, const std::vector<Booking>& sorted) {
-    if (sorted.empty()) {
-        std::cout << "No bookings available.\n";
-        pause();
-        return std::nullopt;
-    }
+        if (!selectable && !hasNext && !hasPrevious) {
+            frame.present();
+            co_await input.pause();
+            co_return std::nullopt;
+        }
 
-    const auto choice = readLine("Booking number: ");
-    if (const auto parsed = parseInt(choice)) {
-        if (*parsed >= 1 && static_cast<std::size_t>(*parsed) <= sorted.size()) {
-            const auto& selected = sorted[static_cast<std::size_t>(*parsed) - 1];
-            if (auto current = ctx.svc.bookings->get(selected.bookingId)) {
-                return current;
-            }
+        renderPageFooter(frame, hasNext, hasPrevious, selectable);
+        frame.present();
+
+        int row = 0;
+        switch (co_await readPageCommand(hasNext, hasPrevious, selectable, row, input)) {
+            case PageCommand::Next:     trail.push_back(page.next); continue;
+            case PageCommand::Previous: trail.pop_back(); continue;
+            case PageCommand::Back:     co_return std::nullopt;
+            case PageCommand::Row:
+                if (row > static_cast<int>(firstRow) &&
+                    static_cast<std::size_t>(row) <= firstRow + page.items.size()) {
+                    const auto& chosen = page.items[static_cast<std::size_t>(row) - firstRow - 1];
+                    if (auto current = ctx.svc.bookings->get(chosen.bookingId)) {
+                        co_return current;
+                    }
+                }
+                break;
+            case PageCommand::Invalid:
+                break;
         }
+        out() << "Invalid selection.\n";
     }
+}
 
-    std::cout << "Invalid selection.\n";
-    pause();
-    return std::nullopt;
+Task<> listBookings(AppContext& ctx, FlowInput& input) {
+    co_await browseBookings(ctx, "Bookings", /*selectable=*/false, input);
+}
+
+Task<std::optional<Booking>> pickBooking(AppContext& ctx, FlowInput& input) {
+    co_return co_await browseBookings(ctx, "Select booking", /*selectable=*/true, input);
 }
 
-void viewBookingDetails(AppContext& ctx, const Booking& booking) {
-    banner("Booking details");
+Task<> viewBookingDetails(AppContext& ctx, const Booking& booking, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.viewBookingDetails", "action");
+    Frame frame;
+    banner(frame, "Booking details");
     const auto metrics = summarize(booking);
-    std::cout << "Booking ID : " << booking.bookingId << '\n';
-    std::cout << "Hotel      : " << hotelDisplayName(ctx, booking.hotelId) << '\n';
-    std::cout << "Status     : " << bookingStatusToString(booking.status) << '\n';
-    std::cout << "Created    : " << formatTimestamp(booking.createdAt) << '\n';
-    std::cout << "Updated    : " << formatTimestamp(booking.updatedAt) << '\n';
+    frame << "Booking ID : " << booking.bookingId << '\n';
+    frame << "Hotel      : " << hotelDisplayName(ctx, booking.hotelId) << '\n';
+    frame << "Status     : " << bookingStatusToString(booking.status) << '\n';
+    frame << "Created    : " << formatTimestamp(booking.createdAt) << '\n';
+    frame << "Updated    : " << formatTimestamp(booking.updatedAt) << '\n';
 
-    std::string primaryGuest = booking.primaryGuestId;
+    std::string primaryGuest = booking.primaryGuestId.str();
     if (auto guest = ctx.svc.users->getById(booking.primaryGuestId)) {
         primaryGuest = guest->firstName + " " + guest->lastName + " (" + guest->userId + ")";
     }
-    std::cout << "Primary guest: " << primaryGuest << '\n';
-    std::cout << "Guests on stay: " << metrics.guests << '\n';
-    std::cout << "Room nights   : " << metrics.roomNights << '\n';
-    std::cout << "Room revenue  : " << formatMoney(metrics.roomRevenue) << '\n';
-    std::cout << "Dining revenue: " << formatMoney(metrics.diningRevenue) << '\n';
+    frame << "Primary guest: " << primaryGuest << '\n';
+    frame << "Guests on stay: " << metrics.guests << '\n';
+    frame << "Room nights   : " << metrics.roomNights << '\n';
+    frame << "Room revenue  : " << formatMoney(metrics.roomRevenue) << '\n';
+    frame << "Dining revenue: " << formatMoney(metrics.diningRevenue) << '\n';
 
     if (booking.items.empty()) {
-        std::cout << "No line items captured.\n";
+        frame << "No line items captured.\n";
     }
     else {
-        std::cout << "\nLine items:\n";
+        frame << "\nLine items:\n";
         for (const auto& item : booking.items) {
             if (std::holds_alternative<RoomStayItem>(item)) {
                 const auto& stay = std::get<RoomStayItem>(item);
-                std::cout << "- Room " << stay.roomNumber
-                          << " - " << stay.nights << " night(s) @ "
-                          << formatMoney(stay.nightlyRateLocked) << " per night\n";
+                frame << "- Room " << stay.roomNumber
+                      << " - " << stay.nights << " night(s) @ "
+                      << formatMoney(stay.nightlyRateLocked) << " per night\n";
                 if (!stay.occupants.empty()) {
                     std::vector<std::string> names;
                     for (const auto& occ : stay.occupants) {
                         names.push_back(occ.firstName + " " + occ.lastName);
                     }
-                    std::cout << "  Guests: " << join(names, ", ") << '\n';
+                    frame << "  Guests: " << join(names, ", ") << '\n';
                 }
             }
             else {
                 const auto& order = std::get<RestaurantOrderLine>(item);
-                std::cout << "- Dining - " << order.nameSnapshot
-                          << " x" << order.qty
-                          << " - " << formatMoney(order.unitPriceSnapshot * order.qty)
-                          << " (" << order.category << ")\n";
+                frame << "- Dining - " << order.nameSnapshot
+                      << " x" << order.qty
+                      << " - " << formatMoney(order.unitPriceSnapshot * order.qty)
+                      << " (" << order.category << ")\n";
             }
         }
     }
 
-    pause();
+    frame.present();
+    co_await input.pause();
 }
 
-void changeBookingStatus(AppContext& ctx, Booking booking) {
+Task<> changeBookingStatus(AppContext& ctx, Booking booking, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.changeBookingStatus", "action");
     banner("Update booking status");
-    std::cout << "Current status: " << bookingStatusToString(booking.status) << '\n';
-    std::cout << "1) Mark ACTIVE\n";
-    std::cout << "2) Mark CHECKED_OUT\n";
-    std::cout << "3) Mark CANCELLED\n";
-    std::cout << "0) Back\n";
-    const int choice = ConsoleIO::readIntInRange("Select: ", 0, 3);
+    out() << "Current status: " << bookingStatusToString(booking.status) << '\n';
+    out() << "1) Mark ACTIVE\n";
+    out() << "2) Mark CHECKED_OUT\n";
+    out() << "3) Mark CANCELLED\n";
+    out() << "0) Back\n";
+    const int choice = co_await input.readIntInRange("Select: ", 0, 3);
 
     BookingStatus newStatus = booking.status;
-    if (choice == 0) return;
+    if (choice == 0) co_return;
     if (choice == 1) newStatus = BookingStatus::ACTIVE;
     else if (choice == 2) newStatus = BookingStatus::CHECKED_OUT;
     else if (choice == 3) newStatus = BookingStatus::CANCELLED;
 
-    booking.status = newStatus;
-    booking.updatedAt = nowSeconds();
-
-    ctx.svc.bookings->upsert(booking);
+    // Applied to the latest copy, so changes other sessions made while this
+    // screen was open (e.g. a guest's restaurant order) are kept. If the
+    // status itself moved on in the meantime, nothing is changed.
+    bool statusMoved = false;
+    const auto stored = ctx.svc.bookings->update(booking.bookingId, [&](Booking& current) {
+        if (current.status != booking.status) {
+            statusMoved = true;
+            return false;
+        }
+        current.status = newStatus;
+        current.updatedAt = nowSeconds();
+        return true;
+    });
+    if (!stored) {
+        out() << (statusMoved ? "The status was changed by someone else meanwhile. Nothing was updated.\n"
+                              : "Unable to update booking.\n");
+        co_await input.pause();
+        co_return;
+    }
     ctx.svc.bookings->saveAll();
 
-    std::cout << "Status updated to " << bookingStatusToString(newStatus) << "\n";
-    pause();
+    out() << "Status updated to " << bookingStatusToString(newStatus) << "\n";
+    co_await input.pause();
 }
 
-void purgeBooking(AppContext& ctx, const Booking& booking) {
+Task<> purgeBooking(AppContext& ctx, const Booking& booking, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.purgeBooking", "action");
     banner("Remove booking record");
     if (booking.status != BookingStatus::CANCELLED) {
-        std::cout << "Only cancelled bookings can be removed.\n";
-        pause();
-        return;
+        out() << "Only cancelled bookings can be removed.\n";
+        co_await input.pause();
+        co_return;
     }
 
-    const std::string confirmation = readLine("Type DELETE to confirm: ");
+    const std::string confirmation = co_await input.readLine("Type DELETE to confirm: ");
     if (confirmation != "DELETE") {
-        std::cout << "Cancelled.\n";
-        pause();
-        return;
+        out() << "Cancelled.\n";
+        co_await input.pause();
+        co_return;
     }
 
-    if (!ctx.svc.bookings->remove(booking.bookingId)) {
-        std::cout << "Unable to remove booking.\n";
-        pause();
-        return;
+    if (!ctx.svc.bookings->removeIfUnchanged(booking)) {
+        out() << "Unable to remove booking (it was changed or removed meanwhile).\n";
+        co_await input.pause();
+        co_return;
     }
 
     ctx.svc.bookings->saveAll();
-    std::cout << "Booking removed.\n";
-    pause();
+    out() << "Booking removed.\n";
+    co_await input.pause();
 }
 
-void manageBookings(AppContext& ctx) {
+Task<> manageBookings(AppContext& ctx, FlowInput& input) {
     for (;;) {
-        auto bookings = ctx.svc.bookings->list();
-        std::sort(bookings.begin(), bookings.end(), [](const Booking& a, const Booking& b) {
-            return a.createdAt > b.createdAt;
-        });
-
         banner("Booking oversight");
-        std::cout << "1) List bookings\n";
-        std::cout << "2) View booking details\n";
-        std::cout << "3) Update booking status\n";
-        std::cout << "4) Remove cancelled booking\n";
-        std::cout << "0) Back\n";
-        const int choice = ConsoleIO::readIntInRange("Select: ", 0, 4);
-
-        if (choice == 0) return;
-        if (choice == 1) { listBookings(ctx, bookings); continue; }
+        out() << "1) List bookings\n";
+        out() << "2) View booking details\n";
+        out() << "3) Update booking status\n";
+        out() << "4) Remove cancelled booking\n";
+        out() << "0) Back\n";
+        const int choice = co_await input.readIntInRange("Select: ", 0, 4);
+
+        if (choice == 0) co_return;
+        if (choice == 1) { co_await listBookings(ctx, input); continue; }
         if (choice == 2) {
-            if (auto booking = pickBooking(ctx, bookings)) viewBookingDetails(ctx, *booking);
+            if (auto booking = co_await pickBooking(ctx, input)) co_await viewBookingDetails(ctx, *booking, input);
             continue;
         }
         if (choice == 3) {
-            if (auto booking = pickBooking(ctx, bookings)) changeBookingStatus(ctx, *booking);
+            if (auto booking = co_await pickBooking(ctx, input)) co_await changeBookingStatus(ctx, *booking, input);
             continue;
         }
         if (choice == 4) {
-            if (auto booking = pickBooking(ctx, bookings)) purgeBooking(ctx, *booking);
+            if (auto booking = co_await pickBooking(ctx, input)) co_await purgeBooking(ctx, *booking, input);
             continue;
         }
     }
 }
 
-void showReports(AppContext& ctx) {
-    banner("Operations snapshot");
-    const auto hotels = ctx.svc.hotels->list();
-    const auto rooms = ctx.svc.rooms->list();
-    const auto bookings = ctx.svc.bookings->list();
+// Local midnight of "YYYY-MM-DD", as epoch seconds.
+std::optional<std::int64_t> parseDate(const std::string& text) {
+    std::tm tm{};
+    std::istringstream in(text);
+    in >> std::get_time(&tm, "%Y-%m-%d");
+    if (in.fail() || in.peek() != std::char_traits<char>::eof()) return std::nullopt;
+    tm.tm_isdst = -1;
+    const std::time_t t = std::mktime(&tm);
+    if (t == static_cast<std::time_t>(-1)) return std::nullopt;
+    return static_cast<std::int64_t>(t);
+}
 
-    int activeRooms = 0;
-    for (const auto& room : rooms) if (room.active) ++activeRooms;
+// Hotel and creation period for history reports; blank answers mean "all".
+Task<hms::BookingFilter> readHistoryFilter(AppContext& ctx, FlowInput& input) {
+    hms::BookingFilter filter;
+    for (;;) {
+        const std::string id = co_await input.readLine("Hotel ID (blank for all): ", true);
+        if (id.empty()) break;
+        if (ctx.svc.hotels->get(id)) {
+            filter.hotelId = id;
+            break;
+        }
+        out() << "Hotel not found.\n";
+    }
+    for (;;) {
+        const std::string from = co_await input.readLine("Created from (YYYY-MM-DD, blank for any): ", true);
+        if (from.empty()) break;
+        if ((filter.createdFrom = parseDate(from))) break;
+        out() << "Please enter a date as YYYY-MM-DD.\n";
+    }
+    for (;;) {
+        const std::string to = co_await input.readLine("Created until (YYYY-MM-DD, inclusive, blank for any): ", true);
+        if (to.empty()) break;
+        if (auto day = parseDate(to)) {
+            filter.createdBefore = *day + 24 * 60 * 60;
+            break;
+        }
+        out() << "Please enter a date as YYYY-MM-DD.\n";
+    }
+    co_return filter;
+}
 
-    int activeBookings = 0;
-    int checkedOutBookings = 0;
-    std::int64_t activeRevenue = 0;
-    std::int64_t realizedRevenue = 0;
-    int activeRoomUsage = 0;
+// Figures for one hotel and period over hot and archived bookings. The
+// archive is streamed, and its blocks outside the hotel or period are not
+// even read.
+Task<> showHistory(AppContext& ctx, const hms::BookingFilter& filter, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.showHistory", "action");
+    hms::OperationsSnapshot snap{};
+    int cancelled = 0;
+    const auto add = [&](const Booking& booking) {
+        hms::accumulate(snap, booking);
+        if (booking.status == BookingStatus::CANCELLED) ++cancelled;
+    };
+    const auto hot = filter.hotelId ? ctx.svc.bookings->listByHotel(*filter.hotelId) : ctx.svc.bookings->list();
+    for (const auto& booking : hot) {
+        if (filter.matches(booking)) add(booking);
+    }
+    bool archiveReadable = true;
+    if (ctx.svc.archive) {
+        archiveReadable = ctx.svc.archive->scan(filter, [&](const Booking& booking) {
+            if (!ctx.svc.bookings->get(booking.bookingId)) add(booking);
+            return true;
+        });
+    }
 
-    for (const auto& booking : bookings) {
-        const auto metrics = summarize(booking);
-        if (booking.status == BookingStatus::ACTIVE) {
-            ++activeBookings;
-            activeRoomUsage += metrics.rooms;
-            activeRevenue += metrics.roomRevenue + metrics.diningRevenue;
-        }
-        else if (booking.status == BookingStatus::CHECKED_OUT) {
-            ++checkedOutBookings;
-            realizedRevenue += metrics.roomRevenue + metrics.diningRevenue;
+    Frame frame;
+    banner(frame, "Booking history");
+    frame << "Hotel            : " << (filter.hotelId ? hotelDisplayName(ctx, *filter.hotelId) : std::string("All hotels")) << '\n';
+    frame << "Period           : " << (filter.createdFrom ? formatTimestamp(*filter.createdFrom) : std::string("start"))
+          << " - " << (filter.createdBefore ? formatTimestamp(*filter.createdBefore) : std::string("now")) << '\n';
+    frame << "Active bookings  : " << snap.activeBookings << '\n';
+    frame << "Checked-out stay : " << snap.checkedOutBookings << '\n';
+    frame << "Cancelled        : " << cancelled << '\n';
+    frame << "Active pipeline  : " << formatMoney(snap.activeRevenue) << '\n';
+    frame << "Revenue realized : " << formatMoney(snap.realizedRevenue) << '\n';
+    if (!archiveReadable) frame << "(archive partly unreadable; figures are incomplete)\n";
+    frame.present();
+    co_await input.pause();
+}
+
+Task<> exportHistory(AppContext& ctx, const hms::BookingFilter& filter, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.exportHistory", "action");
+    const auto fallback = (hms::BookingRepository::defaultPath().parent_path() / "exports" / "bookings.csv").lexically_normal();
+    const auto entered = co_await input.readLine("File [" + fallback.string() + "]: ", true);
+    const std::filesystem::path target = entered.empty() ? fallback : std::filesystem::path(entered);
+    std::error_code ec;
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+
+    std::size_t rows = 0;
+    if (hms::exportBookingsCsv(*ctx.svc.bookings, ctx.svc.archive, filter, target, rows)) {
+        out() << rows << " booking(s) written to " << target.string() << "\n";
+    }
+    else {
+        out() << "Could not write " << target.string() << "\n";
+    }
+    co_await input.pause();
+}
+
+Task<> showReports(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("admin.showReports", "action");
+    for (;;) {
+        {
+            Frame frame;
+            banner(frame, "Operations snapshot");
+            const auto hotelCount = ctx.svc.hotels->list().size();
+            auto snap = summarize(ctx.svc.rooms->list(), ctx.svc.bookings->list());
+
+            // Closed bookings in the archive still count as realized stays;
+            // they are streamed from disk now rather than kept in memory. A
+            // copy still hot (archived, then the save failed) is counted once.
+            std::size_t archived = 0;
+            bool archiveReadable = true;
+            if (ctx.svc.archive) {
+                archiveReadable = ctx.svc.archive->forEach([&](const Booking& booking) {
+                    if (ctx.svc.bookings->get(booking.bookingId)) return true;
+                    ++archived;
+                    hms::accumulate(snap, booking);
+                    return true;
+                });
+            }
+
+            std::ostringstream occStream;
+            occStream << std::fixed << std::setprecision(1) << snap.occupancyPercent();
+
+            frame << "Hotels configured : " << hotelCount << '\n';
+            frame << "Rooms total      : " << snap.totalRooms << " (" << snap.activeRooms << " active)\n";
+            frame << "Active bookings  : " << snap.activeBookings << '\n';
+            frame << "Checked-out stay : " << snap.checkedOutBookings << '\n';
+            frame << "Occupancy (live) : " << occStream.str() << "%\n";
+            frame << "Active pipeline  : " << formatMoney(snap.activeRevenue) << '\n';
+            frame << "Revenue realized : " << formatMoney(snap.realizedRevenue) << '\n';
+            if (ctx.svc.archive) {
+                frame << "Archived         : " << archived << " closed booking(s)";
+                if (!archiveReadable) frame << " (archive partly unreadable)";
+                frame << '\n';
+            }
+            frame << "\n1) History by hotel and period\n";
+            frame << "2) Export bookings to CSV\n";
+            frame << "0) Back\n";
         }
+        const int choice = co_await input.readIntInRange("Select: ", 0, 2);
+        if (choice == 0) co_return;
+
+        const auto filter = co_await readHistoryFilter(ctx, input);
+        if (choice == 1) co_await showHistory(ctx, filter, input);
+        else             co_await exportHistory(ctx, filter, input);
     }
+}
 
-    const int totalRooms = static_cast<int>(rooms.size());
-    const double occupancy = (activeRooms > 0)
-        ? (static_cast<double>(activeRoomUsage) / static_cast<double>(activeRooms)) * 100.0
-        : 0.0;
-    std::ostringstream occStream;
-    occStream << std::fixed << std::setprecision(1) << occupancy;
+// With journaled bookings: bytes written to disk per byte of change, i.e.
+// journal plus compacted snapshots over journal alone.
+void writeAmplification(std::ostream& frame, const hms::diagnostics::Registry& registry) {
+    std::uint64_t journal = 0;
+    std::uint64_t snapshots = 0;
+    for (const auto& [name, value] : registry.counters()) {
+        if (name == "bookings.journalBytesWritten") journal = value;
+        if (name == "bookings.snapshotBytesWritten") snapshots = value;
+    }
+    if (journal == 0) return;
+    frame << "\nBooking write amplification: " << std::fixed << std::setprecision(2)
+          << static_cast<double>(journal + snapshots) / static_cast<double>(journal) << "x\n";
+}
 
-    std::cout << "Hotels configured : " << hotels.size() << '\n';
-    std::cout << "Rooms total      : " << totalRooms << " (" << activeRooms << " active)\n";
-    std::cout << "Active bookings  : " << activeBookings << '\n';
-    std::cout << "Checked-out stay : " << checkedOutBookings << '\n';
-    std::cout << "Occupancy (live) : " << occStream.str() << "%\n";
-    std::cout << "Active pipeline  : " << formatMoney(activeRevenue) << '\n';
-    std::cout << "Revenue realized : " << formatMoney(realizedRevenue) << '\n';
+// Latency histograms and byte counters collected by the repositories since
+// start-up (or the last reset).
+Task<> showDiagnostics(FlowInput& input) {
+    HMS_TRACE_SPAN("admin.showDiagnostics", "action");
+    auto& registry = hms::diagnostics::Registry::instance();
+    for (;;) {
+        {
+            Frame frame;
+            banner(frame, "Diagnostics");
+            registry.writeReport(frame);
+            writeAmplification(frame, registry);
+            frame << "\n1) Refresh\n";
+            frame << "2) Dump to file\n";
+            frame << "3) Reset metrics\n";
+            frame << "0) Back\n";
+        }
+        const int choice = co_await input.readIntInRange("Select: ", 0, 3);
 
-    pause();
+        if (choice == 0) co_return;
+        if (choice == 2) {
+            const auto fallback = hms::diagnostics::defaultDumpPath();
+            const auto entered = co_await input.readLine("File [" + fallback.string() + "]: ", true);
+            const std::filesystem::path target = entered.empty() ? fallback : std::filesystem::path(entered);
+            if (registry.dumpToFile(target)) {
+                out() << "Metrics written to " << target.string() << "\n";
+            }
+            else {
+                out() << "Could not write " << target.string() << "\n";
+            }
+            co_await input.pause();
+            continue;
+        }
+        if (choice == 3) {
+            registry.reset();
+            out() << "Metrics reset.\n";
+            co_await input.pause();
+        }
+    }
 }
 
 } // namespace
 
 namespace hms::ui {
 
-bool DashboardAdmin(hms::AppContext& ctx) {
+Task<bool> DashboardAdminFlow(hms::AppContext& ctx, FlowInput& input) {
     for (;;) {
         banner("Admin dashboard");
-        std::cout << "1) Manage hotels\n";
-        std::cout << "2) Manage rooms\n";
-        std::cout << "3) Booking oversight\n";
-        std::cout << "4) Operational reports\n";
-        std::cout << "5) Logout\n";
-        std::cout << "0) Exit application\n";
-        const int choice = ConsoleIO::readIntInRange("Select: ", 0, 5);
-
-        if (choice == 5) {
-            return true; // logout
+        out() << "1) Manage hotels\n";
+        out() << "2) Manage rooms\n";
+        out() << "3) Booking oversight\n";
+        out() << "4) Operational reports\n";
+        out() << "5) Diagnostics\n";
+        out() << "6) Logout\n";
+        out() << "0) Exit application\n";
+        const int choice = co_await input.readIntInRange("Select: ", 0, 6);
+
+        if (choice == 6) {
+            co_return true; // logout
         }
         if (choice == 0) {
             ctx.running = false;
-            return false; // exit app entirely
+            co_return false; // exit app entirely
         }
-        if (choice == 1) { manageHotels(ctx); continue; }
-        if (choice == 2) { manageRooms(ctx); continue; }
-        if (choice == 3) { manageBookings(ctx); continue; }
-        if (choice == 4) { showReports(ctx); continue; }
+        if (choice == 1) { co_await manageHotels(ctx, input); continue; }
+        if (choice == 2) { co_await manageRooms(ctx, input); continue; }
+        if (choice == 3) { co_await manageBookings(ctx, input); continue; }
+        if (choice == 4) { co_await showReports(ctx, input); continue; }
+        if (choice == 5) { co_await showDiagnostics(input); continue; }
     }
 }
 
-bool DashboardManager(hms::AppContext& ctx) {
+Task<bool> DashboardManagerFlow(hms::AppContext& ctx, FlowInput& input) {
     for (;;) {
         banner("Manager dashboard");
-        std::cout << "1) View hotels summary\n";
-        std::cout << "2) Inspect rooms\n";
-        std::cout << "3) Booking oversight\n";
-        std::cout << "4) Operational reports\n";
-        std::cout << "5) Logout\n";
-        std::cout << "0) Exit application\n";
-        const int choice = ConsoleIO::readIntInRange("Select: ", 0, 5);
+        out() << "1) View hotels summary\n";
+        out() << "2) Inspect rooms\n";
+        out() << "3) Booking oversight\n";
+        out() << "4) Operational reports\n";
+        out() << "5) Logout\n";
+        out() << "0) Exit application\n";
+        const int choice = co_await input.readIntInRange("Select: ", 0, 5);
 
         if (choice == 5) {
-            return true;
+            co_return true;
         }
         if (choice == 0) {
             ctx.running = false;
-            return false;
+            co_return false;
         }
-        if (choice == 1) { listHotels(ctx); continue; }
-        if (choice == 2) { inspectRooms(ctx); continue; }
-        if (choice == 3) { manageBookings(ctx); continue; }
-        if (choice == 4) { showReports(ctx); continue; }
+        if (choice == 1) { co_await listHotels(ctx, input); continue; }
+        if (choice == 2) { co_await inspectRooms(ctx, input); continue; }
+        if (choice == 3) { co_await manageBookings(ctx, input); continue; }
+        if (choice == 4) { co_await showReports(ctx, input); continue; }
     }
 }
 
+bool DashboardAdmin(hms::AppContext& ctx) {
+    FlowInput input;
+    return runBlocking(DashboardAdminFlow(ctx, input), input);
+}
+
+bool DashboardManager(hms::AppContext& ctx) {
+    FlowInput input;
+    return runBlocking(DashboardManagerFlow(ctx, input), input);
+}
+
 }
@@ -1,7 +1,14 @@
 #pragma once
 #include "../AppContext.h"
+#include "../core/Flow.h"
 
 namespace hms::ui {
+// The admin and manager menus as flows reading from `input`; true on
+// logout, false when the user exits the application.
+Task<bool> DashboardAdminFlow(hms::AppContext& ctx, FlowInput& input);
+Task<bool> DashboardManagerFlow(hms::AppContext& ctx, FlowInput& input);
+
+// Run the flows above on in()/out().
 bool DashboardAdmin(hms::AppContext& ctx);
 bool DashboardManager(hms::AppContext& ctx);
 }
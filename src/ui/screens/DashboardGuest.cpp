@@ -1,6 +1,9 @@
 #include "DashboardGuest.h"
 #include "../core/ConsoleIO.h"
+#include "../core/Flow.h"
+#include "../core/Frame.h"
 #include "../../security/Security.h"
+#include "../../diagnostics/Trace.h"
 #include <algorithm>
 #include <cctype>
 #include <cstdint>
@@ -17,39 +20,11 @@
 namespace {
 
 using hms::AppContext;
+using hms::ui::FlowInput;
+using hms::ui::Frame;
+using hms::ui::Task;
 using hms::ui::banner;
-using hms::ui::pause;
-using hms::ui::readLine;
-using hms::ui::readPassword;
-
-struct MenuItem {
-    std::string   id;
-    std::string   name;
-    std::string   category;
-    std::int64_t  priceCents{};
-};
-
-struct Restaurant {
-    std::string        id;
-    std::string        name;
-    std::string        description;
-    std::vector<MenuItem> menu;
-};
-
-const std::vector<Restaurant> kRestaurants = {
-    {"RST-0001", "Sunrise Cafe", "Fresh breakfasts & light bites", {
-         {"bf-omelette",    "Masala Omelette",      "Breakfast",  1800},
-         {"bf-pancakes",    "Maple Pancakes",       "Breakfast",  2200},
-         {"bf-coldbrew",    "Cold Brew Coffee",     "Drinks",     900},
-         {"bf-fruitbowl",   "Seasonal Fruit Bowl",  "Breakfast",  1500},
-     }},
-    {"RST-0002", "Azure Grill", "Signature grills & sundowner drinks", {
-         {"grl-tikka",      "Tandoori Chicken Tikka","Dinner",    3200},
-         {"grl-seabass",    "Charred Sea Bass",      "Dinner",    4200},
-         {"grl-paneer",     "Smoked Paneer Skewers", "Dinner",    2800},
-         {"grl-mojito",     "Classic Mojito",        "Drinks",    1200},
-     }}
-};
+using hms::ui::out;
 
 std::string trimCopy(std::string s) {
     const auto notSpace = [](int ch) { return !std::isspace(ch); };
@@ -109,30 +84,15 @@ std::string bookingStatusToString(hms::BookingStatus status) {
     return "ACTIVE";
 }
 
-std::string nextBookingId(const hms::BookingRepository& repo) {
-    int maxValue = 0;
-    for (const auto& booking : repo.list()) {
-        const auto pos = booking.bookingId.find_last_of('-');
-        if (pos == std::string::npos) continue;
-        const auto tail = booking.bookingId.substr(pos + 1);
-        if (const auto number = parseInt(tail)) {
-            maxValue = std::max(maxValue, *number);
-        }
-    }
-
-    std::ostringstream oss;
-    oss << "BKG-" << std::setw(6) << std::setfill('0') << (maxValue + 1);
-    return oss.str();
-}
-
 std::string nextOrderLineId(const hms::Booking& booking) {
     int maxValue = 0;
     for (const auto& item : booking.items) {
         if (!std::holds_alternative<hms::RestaurantOrderLine>(item)) continue;
         const auto& line = std::get<hms::RestaurantOrderLine>(item);
-        const auto pos = line.lineId.find_last_of('-');
-        if (pos == std::string::npos) continue;
-        const auto tail = line.lineId.substr(pos + 1);
+        const std::string_view id = line.lineId;
+        const auto pos = id.find_last_of('-');
+        if (pos == std::string_view::npos) continue;
+        const std::string tail{id.substr(pos + 1)};
         if (const auto number = parseInt(tail)) {
             maxValue = std::max(maxValue, *number);
         }
@@ -143,30 +103,6 @@ std::string nextOrderLineId(const hms::Booking& booking) {
     return oss.str();
 }
 
-std::int64_t estimateNightlyRate(const hms::Room& room) {
-    std::int64_t base = 9000; // EUR 90.00 default
-    const std::string type = room.typeId;
-    if (type == "DELUXE" || type == "LUXURY") {
-        base = 15000;
-    }
-    else if (type == "SUITE") {
-        base = 22000;
-    }
-    else if (type == "STANDARD") {
-        base = 11000;
-    }
-
-    base += static_cast<std::int64_t>(std::max(room.beds - 1, 0)) * 2000;
-    base += static_cast<std::int64_t>(std::max(room.sizeSqm, 0)) * 70;
-
-    for (const auto& amenity : room.amenities) {
-        if (amenity == "Sea View" || amenity == "Balcony") base += 1800;
-        if (amenity == "Jacuzzi" || amenity == "Mini Bar") base += 1200;
-    }
-
-    return std::max<std::int64_t>(base, 5000);
-}
-
 hms::User sanitizeOccupant(const hms::User& user) {
     hms::User copy = user;
     copy.login.clear();
@@ -177,7 +113,7 @@ hms::User sanitizeOccupant(const hms::User& user) {
     return copy;
 }
 
-hms::User makeExtraOccupant(const std::string& bookingId,
+hms::User makeExtraOccupant(const hms::BookingId& bookingId,
                             int index,
                             const std::string& first,
                             const std::string& last,
@@ -193,35 +129,22 @@ hms::User makeExtraOccupant(const std::string& bookingId,
     return guest;
 }
 
-std::optional<std::string> promptExtraGuest(const std::string& label) {
-    std::cout << label;
-    std::string line;
-    std::getline(std::cin, line);
-    line = trimCopy(line);
-    if (line.empty()) return std::nullopt;
-    return line;
+Task<std::optional<std::string>> promptExtraGuest(const std::string& label, FlowInput& input) {
+    const std::string line = co_await input.readLine(label, /*allowEmpty=*/true);
+    if (line.empty()) co_return std::nullopt;
+    co_return line;
 }
 
 std::vector<hms::Booking> bookingsForGuest(const AppContext& ctx) {
     if (!ctx.currentUser) return {};
-    std::vector<hms::Booking> mine;
-    for (auto booking : ctx.svc.bookings->list()) {
-        if (booking.primaryGuestId == ctx.currentUser->userId) {
-            mine.push_back(std::move(booking));
-        }
-    }
-    std::sort(mine.begin(), mine.end(), [](const auto& a, const auto& b) {
-        if (a.createdAt == b.createdAt) return a.bookingId > b.bookingId;
-        return a.createdAt > b.createdAt;
-    });
-    return mine;
+    return ctx.svc.bookings->listByGuest(ctx.currentUser->userId); // newest first
 }
 
-std::string hotelName(const AppContext& ctx, const std::string& hotelId) {
+std::string hotelName(const AppContext& ctx, const hms::HotelId& hotelId) {
     if (auto h = ctx.svc.hotels->get(hotelId)) {
-        return h->name.empty() ? hotelId : h->name;
+        return h->name.empty() ? hotelId.str() : h->name;
     }
-    return hotelId;
+    return hotelId.str();
 }
 
 std::vector<int> roomNumbersForBooking(const hms::Booking& booking) {
@@ -237,19 +160,19 @@ std::vector<int> roomNumbersForBooking(const hms::Booking& booking) {
     return numbers;
 }
 
-void showBookingsSummary(const AppContext& ctx, bool verbose) {
+void showBookingsSummary(const AppContext& ctx, std::ostream& out, bool verbose) {
     const auto mine = bookingsForGuest(ctx);
     if (mine.empty()) {
-        std::cout << "You have no bookings yet.\n";
+        out << "You have no bookings yet.\n";
         return;
     }
 
     for (const auto& booking : mine) {
-        std::cout << "- " << booking.bookingId << " @ "
-                  << hotelName(ctx, booking.hotelId)
-                  << " (" << bookingStatusToString(booking.status) << ")\n";
-        std::cout << "  Created: " << formatTimestamp(booking.createdAt)
-                  << ", Updated: " << formatTimestamp(booking.updatedAt) << "\n";
+        out << "- " << booking.bookingId << " @ "
+            << hotelName(ctx, booking.hotelId)
+            << " (" << bookingStatusToString(booking.status) << ")\n";
+        out << "  Created: " << formatTimestamp(booking.createdAt)
+            << ", Updated: " << formatTimestamp(booking.updatedAt) << "\n";
 
         std::int64_t roomTotal = 0;
         std::int64_t diningTotal = 0;
@@ -259,116 +182,115 @@ void showBookingsSummary(const AppContext& ctx, bool verbose) {
                 const auto& stay = std::get<hms::RoomStayItem>(item);
                 const auto total = stay.nightlyRateLocked * stay.nights;
                 roomTotal += total;
-                std::cout << "    Room " << stay.roomNumber
-                          << ": " << stay.nights << " night(s) x "
-                          << formatMoney(stay.nightlyRateLocked)
-                          << " = " << formatMoney(total) << "\n";
+                out << "    Room " << stay.roomNumber
+                    << ": " << stay.nights << " night(s) x "
+                    << formatMoney(stay.nightlyRateLocked)
+                    << " = " << formatMoney(total) << "\n";
                 if (verbose && !stay.occupants.empty()) {
-                    std::cout << "      Guests: ";
+                    out << "      Guests: ";
                     for (std::size_t i = 0; i < stay.occupants.size(); ++i) {
                         const auto& g = stay.occupants[i];
-                        std::cout << g.firstName;
-                        if (!g.lastName.empty()) std::cout << ' ' << g.lastName;
-                        if (i + 1 < stay.occupants.size()) std::cout << ", ";
+                        out << g.firstName;
+                        if (!g.lastName.empty()) out << ' ' << g.lastName;
+                        if (i + 1 < stay.occupants.size()) out << ", ";
                     }
-                    std::cout << "\n";
+                    out << "\n";
                 }
             }
             else if (std::holds_alternative<hms::RestaurantOrderLine>(item)) {
                 const auto& line = std::get<hms::RestaurantOrderLine>(item);
                 const auto total = line.unitPriceSnapshot * line.qty;
                 diningTotal += total;
-                std::cout << "    Dining: " << line.nameSnapshot
-                          << " x " << line.qty
-                          << " (" << formatMoney(line.unitPriceSnapshot)
-                          << ") -> " << formatMoney(total);
+                out << "    Dining: " << line.nameSnapshot
+                    << " x " << line.qty
+                    << " (" << formatMoney(line.unitPriceSnapshot)
+                    << ") -> " << formatMoney(total);
                 if (!line.restaurantId.empty()) {
-                    std::cout << " @ " << line.restaurantId;
+                    out << " @ " << line.restaurantId;
                 }
-                std::cout << "\n";
+                out << "\n";
             }
         }
 
-        std::cout << "  Room total:   " << formatMoney(roomTotal) << "\n";
-        std::cout << "  Dining total: " << formatMoney(diningTotal) << "\n";
-        std::cout << "  Grand total:  " << formatMoney(roomTotal + diningTotal) << "\n\n";
+        out << "  Room total:   " << formatMoney(roomTotal) << "\n";
+        out << "  Dining total: " << formatMoney(diningTotal) << "\n";
+        out << "  Grand total:  " << formatMoney(roomTotal + diningTotal) << "\n\n";
     }
 }
 
-void handleBookRoom(AppContext& ctx) {
-    if (!ctx.currentUser) return;
+Task<> handleBookRoom(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("guest.handleBookRoom", "action");
+    if (!ctx.currentUser) co_return;
 
-    auto hotels = ctx.svc.hotels->list();
+    const auto hotels = ctx.svc.hotels->listOrderedByName();
     if (hotels.empty()) {
-        std::cout << "No hotels are available for booking right now.\n";
-        pause();
-        return;
-    }
-
-    std::sort(hotels.begin(), hotels.end(), [](const auto& a, const auto& b) {
-        return a.name < b.name;
-    });
-
-    banner("Book a room");
-    std::cout << "Select a hotel:\n";
-    for (std::size_t i = 0; i < hotels.size(); ++i) {
-        const auto& h = hotels[i];
-        std::cout << "  " << (i + 1) << ") " << h.name
+        out() << "No hotels are available for booking right now.\n";
+        co_await input.pause();
+        co_return;
+    }
+
+    {
+        Frame frame;
+        banner(frame, "Book a room");
+        frame << "Select a hotel:\n";
+        for (std::size_t i = 0; i < hotels.size(); ++i) {
+            const auto& h = hotels[i];
+            frame << "  " << (i + 1) << ") " << h.name
                   << " - " << h.address << "\n";
+        }
+        frame << "  0) Cancel\n";
     }
-    std::cout << "  0) Cancel\n";
 
-    const int hotelChoice = ConsoleIO::readIntInRange(
+    const int hotelChoice = co_await input.readIntInRange(
         "Hotel: ", 0, static_cast<int>(hotels.size()));
-    if (hotelChoice == 0) return;
+    if (hotelChoice == 0) co_return;
 
     const auto selectedHotel = hotels[hotelChoice - 1];
-    auto rooms = ctx.svc.rooms->listByHotel(selectedHotel.id);
+    auto rooms = ctx.svc.rooms->listByHotel(selectedHotel.id); // ordered by room number
     rooms.erase(std::remove_if(rooms.begin(), rooms.end(), [](const hms::Room& r) {
                     return !r.active;
                 }),
                 rooms.end());
 
     if (rooms.empty()) {
-        std::cout << "No active rooms are available in this hotel.\n";
-        pause();
-        return;
-    }
-
-    std::sort(rooms.begin(), rooms.end(), [](const auto& a, const auto& b) {
-        return a.number < b.number;
-    });
-
-    std::cout << "\nAvailable rooms at " << selectedHotel.name << ":\n";
-    for (std::size_t i = 0; i < rooms.size(); ++i) {
-        const auto& room = rooms[i];
-        const auto rate = estimateNightlyRate(room);
-        std::cout << "  " << (i + 1) << ") Room " << room.number
+        out() << "No active rooms are available in this hotel.\n";
+        co_await input.pause();
+        co_return;
+    }
+
+    {
+        Frame frame;
+        frame << "\nAvailable rooms at " << selectedHotel.name << ":\n";
+        for (std::size_t i = 0; i < rooms.size(); ++i) {
+            const auto& room = rooms[i];
+            const auto rate = ctx.svc.pricing->quote(room);
+            frame << "  " << (i + 1) << ") Room " << room.number
                   << " - Beds: " << room.beds
                   << " - Size: " << room.sizeSqm << " sqm"
                   << " - Rate: " << formatMoney(rate);
-        if (!room.amenities.empty()) {
-            std::cout << " - Amenities: ";
-            for (std::size_t a = 0; a < room.amenities.size(); ++a) {
-                std::cout << room.amenities[a];
-                if (a + 1 < room.amenities.size()) std::cout << ", ";
+            if (!room.amenities.empty()) {
+                frame << " - Amenities: ";
+                for (std::size_t a = 0; a < room.amenities.size(); ++a) {
+                    frame << room.amenities[a];
+                    if (a + 1 < room.amenities.size()) frame << ", ";
+                }
             }
+            frame << "\n";
         }
-        std::cout << "\n";
+        frame << "  0) Cancel\n";
     }
-    std::cout << "  0) Cancel\n";
 
-    const int roomChoice = ConsoleIO::readIntInRange(
+    const int roomChoice = co_await input.readIntInRange(
         "Room: ", 0, static_cast<int>(rooms.size()));
-    if (roomChoice == 0) return;
+    if (roomChoice == 0) co_return;
 
     const auto selectedRoom = rooms[roomChoice - 1];
-    const int nights = ConsoleIO::readIntInRange("Number of nights (1-30): ", 1, 30);
+    const int nights = co_await input.readIntInRange("Number of nights (1-30): ", 1, 30);
 
-    const auto nightlyRate = estimateNightlyRate(selectedRoom);
+    const auto nightlyRate = ctx.svc.pricing->quote(selectedRoom);
     const auto totalCost   = nightlyRate * nights;
 
-    const auto bookingId = nextBookingId(*ctx.svc.bookings);
+    const auto bookingId = ctx.svc.bookings->nextBookingId();
 
     hms::Booking booking{};
     booking.bookingId = bookingId;
@@ -387,7 +309,7 @@ void handleBookRoom(AppContext& ctx) {
     int extraIndex = 1;
     while (true) {
         const auto prompt = std::string("Add another guest full name (or press Enter to continue): ");
-        const auto extra = promptExtraGuest(prompt);
+        const auto extra = co_await promptExtraGuest(prompt, input);
         if (!extra) break;
 
         std::istringstream iss(*extra);
@@ -397,7 +319,7 @@ void handleBookRoom(AppContext& ctx) {
         first = trimCopy(first);
         last  = trimCopy(last);
         if (first.empty()) {
-            std::cout << "Skipping empty guest entry.\n";
+            out() << "Skipping empty guest entry.\n";
             continue;
         }
         ++extraIndex;
@@ -406,117 +328,138 @@ void handleBookRoom(AppContext& ctx) {
 
     booking.items.push_back(stay);
 
-    std::cout << "\nSummary:\n";
-    std::cout << "  Hotel:  " << selectedHotel.name << "\n";
-    std::cout << "  Room:   " << selectedRoom.number << " for " << nights
+    out() << "\nSummary:\n";
+    out() << "  Hotel:  " << selectedHotel.name << "\n";
+    out() << "  Room:   " << selectedRoom.number << " for " << nights
               << " night(s)\n";
-    std::cout << "  Guests: " << stay.occupants.size() << "\n";
-    std::cout << "  Total:  " << formatMoney(totalCost) << "\n";
+    out() << "  Guests: " << stay.occupants.size() << "\n";
+    out() << "  Total:  " << formatMoney(totalCost) << "\n";
 
-    auto confirm = readLine("Confirm this booking? (y/N): ", /*allowEmpty=*/true);
+    auto confirm = co_await input.readLine("Confirm this booking? (y/N): ", /*allowEmpty=*/true);
     std::transform(confirm.begin(), confirm.end(), confirm.begin(), [](unsigned char ch){ return static_cast<char>(std::tolower(ch)); });
     if (confirm != "y" && confirm != "yes") {
-        std::cout << "Booking cancelled.\n";
-        pause();
-        return;
+        out() << "Booking cancelled.\n";
+        co_await input.pause();
+        co_return;
     }
 
-    if (!ctx.svc.bookings->upsert(booking)) {
-        std::cout << "Failed to store booking.\n";
-        pause();
-        return;
+    if (!ctx.svc.bookings->upsertIfUnchanged(booking)) {
+        out() << "Failed to store booking.\n";
+        co_await input.pause();
+        co_return;
     }
     if (!ctx.svc.bookings->saveAll()) {
-        std::cout << "Warning: booking saved in memory but not on disk.\n";
+        out() << "Warning: booking saved in memory but not on disk.\n";
     }
 
-    std::cout << "Booking confirmed! Your reference is " << booking.bookingId << "\n";
-    pause();
+    out() << "Booking confirmed! Your reference is " << booking.bookingId << "\n";
+    co_await input.pause();
 }
 
-void handleRestaurantReservation(AppContext& ctx) {
-    if (!ctx.currentUser) return;
+Task<> handleRestaurantReservation(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("guest.handleRestaurantReservation", "action");
+    if (!ctx.currentUser) co_return;
 
     auto mine = bookingsForGuest(ctx);
     if (mine.empty()) {
-        std::cout << "You need an active room booking before placing a restaurant order.\n";
-        pause();
-        return;
+        out() << "You need an active room booking before placing a restaurant order.\n";
+        co_await input.pause();
+        co_return;
     }
 
     banner("Reserve restaurant");
-    std::cout << "Choose the booking to bill:\n";
+    out() << "Choose the booking to bill:\n";
     for (std::size_t i = 0; i < mine.size(); ++i) {
         const auto& booking = mine[i];
-        std::cout << "  " << (i + 1) << ") " << booking.bookingId
+        out() << "  " << (i + 1) << ") " << booking.bookingId
                   << " @ " << hotelName(ctx, booking.hotelId)
                   << " (Rooms: ";
         const auto rooms = roomNumbersForBooking(booking);
-        if (rooms.empty()) std::cout << "-";
+        if (rooms.empty()) out() << "-";
         else {
             for (std::size_t r = 0; r < rooms.size(); ++r) {
-                std::cout << rooms[r];
-                if (r + 1 < rooms.size()) std::cout << ", ";
+                out() << rooms[r];
+                if (r + 1 < rooms.size()) out() << ", ";
             }
         }
-        std::cout << ")\n";
+        out() << ")\n";
     }
-    std::cout << "  0) Cancel\n";
+    out() << "  0) Cancel\n";
 
-    const int bookingChoice = ConsoleIO::readIntInRange(
+    const int bookingChoice = co_await input.readIntInRange(
         "Booking: ", 0, static_cast<int>(mine.size()));
-    if (bookingChoice == 0) return;
+    if (bookingChoice == 0) co_return;
 
     const auto bookingId = mine[bookingChoice - 1].bookingId;
     auto bookingOpt = ctx.svc.bookings->get(bookingId);
     if (!bookingOpt) {
-        std::cout << "Booking could not be loaded.\n";
-        pause();
-        return;
+        out() << "Booking could not be loaded.\n";
+        co_await input.pause();
+        co_return;
     }
 
     auto booking = *bookingOpt;
-    std::cout << "\nAvailable restaurants:\n";
-    for (std::size_t i = 0; i < kRestaurants.size(); ++i) {
-        const auto& r = kRestaurants[i];
-        std::cout << "  " << (i + 1) << ") " << r.name
-                  << " - " << r.description << "\n";
+    const auto restaurants = ctx.svc.restaurants->listByHotel(booking.hotelId);
+    if (restaurants.empty()) {
+        out() << "No restaurants are available at " << hotelName(ctx, booking.hotelId) << ".\n";
+        co_await input.pause();
+        co_return;
+    }
+
+    out() << "\nAvailable restaurants:\n";
+    for (std::size_t i = 0; i < restaurants.size(); ++i) {
+        const auto& r = restaurants[i];
+        out() << "  " << (i + 1) << ") " << r.name;
+        if (!r.cuisine.empty()) out() << " - " << r.cuisine;
+        out() << "\n";
     }
-    std::cout << "  0) Cancel\n";
+    out() << "  0) Cancel\n";
 
-    const int restaurantChoice = ConsoleIO::readIntInRange(
-        "Restaurant: ", 0, static_cast<int>(kRestaurants.size()));
-    if (restaurantChoice == 0) return;
+    const int restaurantChoice = co_await input.readIntInRange(
+        "Restaurant: ", 0, static_cast<int>(restaurants.size()));
+    if (restaurantChoice == 0) co_return;
 
-    const auto& restaurant = kRestaurants[restaurantChoice - 1];
+    const auto& restaurant = restaurants[restaurantChoice - 1];
+    const auto menu = ctx.svc.restaurants->menuFor(restaurant.id); // grouped by category
+    if (menu.empty()) {
+        out() << restaurant.name << " has no menu available.\n";
+        co_await input.pause();
+        co_return;
+    }
 
-    bool addedSomething = false;
+    std::vector<hms::RestaurantOrderLine> added;
     std::int64_t orderTotal = 0;
     for (;;) {
-        std::cout << "\n" << restaurant.name << " menu:\n";
-        for (std::size_t i = 0; i < restaurant.menu.size(); ++i) {
-            const auto& item = restaurant.menu[i];
-            std::cout << "  " << (i + 1) << ") [" << item.category << "] "
-                      << item.name << " - " << formatMoney(item.priceCents) << "\n";
+        {
+            Frame frame;
+            frame << "\n" << restaurant.name << " menu:\n";
+            for (std::size_t i = 0; i < menu.size(); ++i) {
+                const auto& item = menu[i];
+                if (i == 0 || menu[i - 1].category != item.category) {
+                    frame << "  " << item.category << "\n";
+                }
+                frame << "    " << (i + 1) << ") " << item.name
+                      << " - " << formatMoney(item.price) << "\n";
+            }
+            frame << "  0) Finish order\n";
         }
-        std::cout << "  0) Finish order\n";
 
-        const int itemChoice = ConsoleIO::readIntInRange(
-            "Item: ", 0, static_cast<int>(restaurant.menu.size()));
+        const int itemChoice = co_await input.readIntInRange(
+            "Item: ", 0, static_cast<int>(menu.size()));
         if (itemChoice == 0) break;
 
-        const auto& menuItem = restaurant.menu[itemChoice - 1];
-        const int qty = ConsoleIO::readIntInRange("Quantity (1-10): ", 1, 10);
+        const auto& menuItem = menu[itemChoice - 1];
+        const int qty = co_await input.readIntInRange("Quantity (1-10): ", 1, 10);
 
         auto rooms = roomNumbersForBooking(booking);
         int billedRoom = 0;
         if (!rooms.empty()) {
-            std::cout << "Bill to which room?\n";
+            out() << "Bill to which room?\n";
             for (std::size_t i = 0; i < rooms.size(); ++i) {
-                std::cout << "  " << (i + 1) << ") Room " << rooms[i] << "\n";
+                out() << "  " << (i + 1) << ") Room " << rooms[i] << "\n";
             }
-            std::cout << "  0) No room (walk-in)\n";
-            const int roomChoice = ConsoleIO::readIntInRange(
+            out() << "  0) No room (walk-in)\n";
+            const int roomChoice = co_await input.readIntInRange(
                 "Room: ", 0, static_cast<int>(rooms.size()));
             if (roomChoice > 0) {
                 billedRoom = rooms[roomChoice - 1];
@@ -529,7 +472,7 @@ void handleRestaurantReservation(AppContext& ctx) {
         line.category = menuItem.category;
         line.menuItemId = menuItem.id;
         line.nameSnapshot = menuItem.name;
-        line.unitPriceSnapshot = menuItem.priceCents;
+        line.unitPriceSnapshot = menuItem.price;
         line.qty = qty;
         line.billedRoomNumber = billedRoom;
         line.takenByUsername = restaurant.id + "-desk";
@@ -538,155 +481,167 @@ void handleRestaurantReservation(AppContext& ctx) {
 
         booking.items.push_back(line);
         booking.updatedAt = line.createdAt;
-        addedSomething = true;
+        added.push_back(line);
         orderTotal += line.unitPriceSnapshot * line.qty;
 
-        std::cout << "Added " << menuItem.name << " x " << qty
+        out() << "Added " << menuItem.name << " x " << qty
                   << " - running total " << formatMoney(orderTotal) << "\n";
 
-        auto again = readLine("Add another item? (y/N): ", /*allowEmpty=*/true);
+        auto again = co_await input.readLine("Add another item? (y/N): ", /*allowEmpty=*/true);
         std::transform(again.begin(), again.end(), again.begin(), [](unsigned char ch){ return static_cast<char>(std::tolower(ch)); });
         if (again != "y" && again != "yes") break;
     }
 
-    if (!addedSomething) {
-        std::cout << "No items added.\n";
-        pause();
-        return;
+    if (added.empty()) {
+        out() << "No items added.\n";
+        co_await input.pause();
+        co_return;
     }
 
-    if (!ctx.svc.bookings->upsert(booking)) {
-        std::cout << "Failed to update booking with restaurant order.\n";
-        pause();
-        return;
+    // Other sessions may have changed the booking while the guest was
+    // ordering; add the new lines to its latest copy.
+    const auto stored = ctx.svc.bookings->update(booking.bookingId, [&](hms::Booking& current) {
+        for (auto line : added) {
+            line.lineId = nextOrderLineId(current);
+            current.items.push_back(std::move(line));
+        }
+        current.updatedAt = added.back().createdAt;
+        return true;
+    });
+    if (!stored) {
+        out() << "Failed to update booking with restaurant order.\n";
+        co_await input.pause();
+        co_return;
     }
     if (!ctx.svc.bookings->saveAll()) {
-        std::cout << "Warning: order saved in memory but not on disk.\n";
+        out() << "Warning: order saved in memory but not on disk.\n";
     }
 
-    std::cout << "Reservation saved! Total dining spend: " << formatMoney(orderTotal) << "\n";
-    pause();
+    out() << "Reservation saved! Total dining spend: " << formatMoney(orderTotal) << "\n";
+    co_await input.pause();
 }
 
-std::string promptWithDefault(const std::string& label, const std::string& current) {
-    std::cout << label << " [" << current << "]: ";
-    std::string line;
-    std::getline(std::cin, line);
-    line = trimCopy(line);
-    return line.empty() ? current : line;
+Task<std::string> promptWithDefault(const std::string& label, const std::string& current, FlowInput& input) {
+    const std::string line = co_await input.readLine(label + " [" + current + "]: ", /*allowEmpty=*/true);
+    co_return line.empty() ? current : line;
 }
 
-void editProfile(AppContext& ctx) {
-    if (!ctx.currentUser) return;
+Task<> editProfile(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("guest.editProfile", "action");
+    if (!ctx.currentUser) co_return;
 
     auto updated = *ctx.currentUser;
     banner("Edit profile");
-    updated.firstName = promptWithDefault("First name", updated.firstName);
-    updated.lastName  = promptWithDefault("Last name", updated.lastName);
-    updated.address   = promptWithDefault("Address", updated.address);
-    updated.phone     = promptWithDefault("Phone", updated.phone);
+    updated.firstName = co_await promptWithDefault("First name", updated.firstName, input);
+    updated.lastName  = co_await promptWithDefault("Last name", updated.lastName, input);
+    updated.address   = co_await promptWithDefault("Address", updated.address, input);
+    updated.phone     = co_await promptWithDefault("Phone", updated.phone, input);
 
     if (updated.firstName == ctx.currentUser->firstName &&
         updated.lastName  == ctx.currentUser->lastName &&
         updated.address   == ctx.currentUser->address &&
         updated.phone     == ctx.currentUser->phone) {
-        std::cout << "No changes detected.\n";
-        pause();
-        return;
+        out() << "No changes detected.\n";
+        co_await input.pause();
+        co_return;
     }
 
     if (!ctx.svc.users->upsert(updated)) {
-        std::cout << "Failed to update profile.\n";
-        pause();
-        return;
+        out() << "Failed to update profile.\n";
+        co_await input.pause();
+        co_return;
     }
     if (!ctx.svc.users->saveAll()) {
-        std::cout << "Warning: profile saved in memory but not on disk.\n";
+        out() << "Warning: profile saved in memory but not on disk.\n";
     }
 
     ctx.currentUser = updated;
-    std::cout << "Profile updated successfully.\n";
-    pause();
+    out() << "Profile updated successfully.\n";
+    co_await input.pause();
 }
 
-void changePassword(AppContext& ctx) {
-    if (!ctx.currentUser) return;
+Task<> changePassword(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("guest.changePassword", "action");
+    if (!ctx.currentUser) co_return;
 
     banner("Change password");
-    const auto current = readPassword("Current password: ");
-    if (!hms::VerifyPasswordDemo(ctx.currentUser->passwordHash, current)) {
-        std::cout << "Incorrect password.\n";
-        pause();
-        return;
+    const auto current = co_await input.readPassword("Current password: ");
+    if (!hms::VerifyPassword(ctx.currentUser->passwordHash, current)) {
+        out() << "Incorrect password.\n";
+        co_await input.pause();
+        co_return;
     }
 
-    const auto newPass = readPassword("New password (min 6 chars): ");
+    const auto newPass = co_await input.readPassword("New password (min 6 chars): ");
     if (newPass.size() < 6) {
-        std::cout << "Password must be at least 6 characters.\n";
-        pause();
-        return;
+        out() << "Password must be at least 6 characters.\n";
+        co_await input.pause();
+        co_return;
     }
-    const auto confirm = readPassword("Confirm new password: ");
+    const auto confirm = co_await input.readPassword("Confirm new password: ");
     if (newPass != confirm) {
-        std::cout << "Passwords do not match.\n";
-        pause();
-        return;
+        out() << "Passwords do not match.\n";
+        co_await input.pause();
+        co_return;
     }
 
     auto updated = *ctx.currentUser;
-    updated.passwordHash = hms::HashPasswordDemo(newPass);
+    updated.passwordHash = hms::HashPassword(newPass);
     updated.password.clear();
 
     if (!ctx.svc.users->upsert(updated)) {
-        std::cout << "Failed to update password.\n";
-        pause();
-        return;
+        out() << "Failed to update password.\n";
+        co_await input.pause();
+        co_return;
     }
     if (!ctx.svc.users->saveAll()) {
-        std::cout << "Warning: password saved in memory but not on disk.\n";
+        out() << "Warning: password saved in memory but not on disk.\n";
     }
 
     ctx.currentUser = updated;
-    std::cout << "Password changed successfully.\n";
-    pause();
+    out() << "Password changed successfully.\n";
+    co_await input.pause();
 }
 
 void showProfileHeader(const AppContext& ctx) {
     if (!ctx.currentUser) return;
     const auto& user = *ctx.currentUser;
-    std::cout << "Logged in as: " << user.firstName;
-    if (!user.lastName.empty()) std::cout << ' ' << user.lastName;
-    std::cout << " (" << user.login << ")\n";
-    std::cout << "Phone: " << (user.phone.empty() ? "n/a" : user.phone) << "\n";
-    std::cout << "Address: " << (user.address.empty() ? "n/a" : user.address) << "\n";
-    std::cout << "------------------------------\n";
+    out() << "Logged in as: " << user.firstName;
+    if (!user.lastName.empty()) out() << ' ' << user.lastName;
+    out() << " (" << user.login << ")\n";
+    out() << "Phone: " << (user.phone.empty() ? "n/a" : user.phone) << "\n";
+    out() << "Address: " << (user.address.empty() ? "n/a" : user.address) << "\n";
+    out() << "------------------------------\n";
 }
 
-void handleProfile(AppContext& ctx) {
-    if (!ctx.currentUser) return;
+Task<> handleProfile(AppContext& ctx, FlowInput& input) {
+    HMS_TRACE_SPAN("guest.handleProfile", "action");
+    if (!ctx.currentUser) co_return;
 
     for (;;) {
         banner("Profile & bookings");
         showProfileHeader(ctx);
-        std::cout << "1) View my bookings\n";
-        std::cout << "2) Edit contact details\n";
-        std::cout << "3) Change password\n";
-        std::cout << "0) Back\n";
+        out() << "1) View my bookings\n";
+        out() << "2) Edit contact details\n";
+        out() << "3) Change password\n";
+        out() << "0) Back\n";
 
-        const int choice = ConsoleIO::readIntInRange("Select: ", 0, 3);
+        const int choice = co_await input.readIntInRange("Select: ", 0, 3);
         if (choice == 1) {
-            banner("My bookings");
-            showBookingsSummary(ctx, /*verbose=*/true);
-            pause();
+            Frame frame;
+            banner(frame, "My bookings");
+            showBookingsSummary(ctx, frame, /*verbose=*/true);
+            frame.present();
+            co_await input.pause();
         }
         else if (choice == 2) {
-            editProfile(ctx);
+            co_await editProfile(ctx, input);
         }
         else if (choice == 3) {
-            changePassword(ctx);
+            co_await changePassword(ctx, input);
         }
         else if (choice == 0) {
-            return;
+            co_return;
         }
     }
 }
@@ -695,36 +650,41 @@ void handleProfile(AppContext& ctx) {
 
 namespace hms::ui {
 
-bool DashboardGuest(hms::AppContext& ctx) {
+Task<bool> DashboardGuestFlow(hms::AppContext& ctx, FlowInput& input) {
     for (;;) {
         banner("Guest Dashboard");
-        std::cout << "1) Book a room\n";
-        std::cout << "2) Reserve restaurant\n";
-        std::cout << "3) Profile & bookings\n";
-        std::cout << "4) Logout\n";
-        std::cout << "0) Exit application\n";
-        const int choice = ConsoleIO::readIntInRange("Select: ", 0, 4);
+        out() << "1) Book a room\n";
+        out() << "2) Reserve restaurant\n";
+        out() << "3) Profile & bookings\n";
+        out() << "4) Logout\n";
+        out() << "0) Exit application\n";
+        const int choice = co_await input.readIntInRange("Select: ", 0, 4);
 
         if (choice == 1) {
-            handleBookRoom(ctx);
+            co_await handleBookRoom(ctx, input);
             continue;
         }
         if (choice == 2) {
-            handleRestaurantReservation(ctx);
+            co_await handleRestaurantReservation(ctx, input);
             continue;
         }
         if (choice == 3) {
-            handleProfile(ctx);
+            co_await handleProfile(ctx, input);
             continue;
         }
         if (choice == 4) {
-            return true;
+            co_return true;
         }
         if (choice == 0) {
             ctx.running = false;
-            return false;
+            co_return false;
         }
     }
 }
 
+bool DashboardGuest(hms::AppContext& ctx) {
+    FlowInput input;
+    return runBlocking(DashboardGuestFlow(ctx, input), input);
+}
+
 }
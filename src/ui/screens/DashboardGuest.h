@@ -1,5 +1,13 @@
 #pragma once
 #include "../AppContext.h"
+#include "../core/Flow.h"
 
 
-namespace hms::ui { bool DashboardGuest(hms::AppContext& ctx); }
+namespace hms::ui {
+// The guest menu as a flow: reads its input from `input`, so any driver
+// can run it. true on logout, false when the user exits the application.
+Task<bool> DashboardGuestFlow(hms::AppContext& ctx, FlowInput& input);
+
+// Runs DashboardGuestFlow on in()/out().
+bool DashboardGuest(hms::AppContext& ctx);
+}
@@ -10,12 +10,18 @@ namespace hms::ui {
             auto login = readLine("Login: ");
             auto pw    = readPassword("Password: ");
             auto u = users.getByLogin(login);
-            if (u && hms::VerifyPasswordDemo(u->passwordHash, pw)) {
+            if (u && hms::VerifyPassword(u->passwordHash, pw)) {
+                if (hms::PasswordNeedsRehash(u->passwordHash)) {
+                    // Old format or cost: replaced now that the password is
+                    // at hand; written with the next save.
+                    u->passwordHash = hms::HashPassword(pw);
+                    users.upsert(*u);
+                }
                 auto sanitized = *u;
                 sanitized.password.clear();
                 return sanitized;
             }
-            std::cout << "Invalid login or password. "<<(2-i)<<" tries left.\n";
+            out() << "Invalid login or password. "<<(2-i)<<" tries left.\n";
         }
         return std::nullopt;
     }
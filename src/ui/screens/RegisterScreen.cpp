@@ -24,16 +24,16 @@ namespace hms::ui {
             login = readLine("Choose a login: ");
             if (validateLogin(users, login, why))
                 break;
-            std::cout<<"  "<<why<<"\n";
+            out()<<"  "<<why<<"\n";
         }
 
         std::string pw, pw2;
         for(;;) {
             pw  = readPassword("Choose a password: ");
             pw2 = readPassword("Repeat password:   ");
-            if(pw!=pw2){ std::cout<<"  Passwords do not match.\n"; continue; }
+            if(pw!=pw2){ out()<<"  Passwords do not match.\n"; continue; }
             if(validatePasswordStrength(pw, why)) break;
-            std::cout<<"  "<<why<<"\n";
+            out()<<"  "<<why<<"\n";
         }
 
         // Role selection policy:
@@ -56,7 +56,7 @@ namespace hms::ui {
         u.userId   = genUserId();
         u.login    = login;
         u.password = "";
-        u.passwordHash = hms::HashPasswordDemo(pw);
+        u.passwordHash = hms::HashPassword(pw);
         u.role     = role;
 
         u.firstName = readLine("First name (optional): ", true);
@@ -65,12 +65,12 @@ namespace hms::ui {
         u.address   = readLine("Address    (optional): ", true);
 
         if(!users.upsert(u) || !users.saveAll()){
-            std::cout<<"Could not save user.\n"; return std::nullopt;
+            out()<<"Could not save user.\n"; return std::nullopt;
         }
         std::string roleLabel = "GUEST";
         if (u.role == hms::Role::ADMIN) roleLabel = "ADMIN";
         else if (u.role == hms::Role::MANAGER) roleLabel = "MANAGER";
-        std::cout<<"Account created ("<<roleLabel<<").\n";
+        out()<<"Account created ("<<roleLabel<<").\n";
         return u;
     }
 }
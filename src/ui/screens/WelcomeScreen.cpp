@@ -4,9 +4,9 @@
 namespace hms::ui {
     int WelcomeScreen() {
         banner("Welcome to HMS");
-        std::cout<<"1) Login\n";
-        std::cout<<"2) Register\n";
-        std::cout<<"3) Exit\n";
+        out()<<"1) Login\n";
+        out()<<"2) Register\n";
+        out()<<"3) Exit\n";
         return ConsoleIO::readIntInRange("Select: ", 1, 3);
     }
 }
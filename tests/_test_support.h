@@ -1,6 +1,7 @@
 #pragma once
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <string>
 #include <cstdlib>
 #include <stdexcept>
@@ -36,4 +37,9 @@ namespace test_support {
         std::ofstream out(p, std::ios::trunc);
         out << s;
     }
+
+    inline std::string read_text(const std::filesystem::path& p) {
+        std::ifstream in(p, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
 }
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "../src/storage/Arena.h"
+#include "../src/storage/BookingRepository.h"
+#include "_test_support.h"
+
+#include <cstdint>
+#include <string>
+
+using namespace hms;
+using test_support::TempDir;
+using test_support::write_text;
+
+TEST(Arena, AllocationsAreAlignedAndReleasedTogether) {
+MonotonicArena arena(256);
+for (std::size_t align : {1u, 2u, 8u, 16u, 64u}) {
+    auto* p = arena.allocate(3, align);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % align, 0u) << align;
+}
+arena.allocate(10'000, 8); // larger than the next block: gets its own
+EXPECT_GE(arena.blockCount(), 2u);
+EXPECT_GE(arena.bytesReserved(), arena.bytesAllocated());
+
+arena.release();
+EXPECT_EQ(arena.blockCount(), 0u);
+EXPECT_EQ(arena.bytesReserved(), 0u);
+EXPECT_NE(arena.allocate(8, 8), nullptr); // usable again after release
+}
+
+TEST(Arena, ScopeRoutesAllocatorAndNests) {
+EXPECT_EQ(ArenaScope::current(), nullptr);
+MonotonicArena outer, inner;
+{
+    const ArenaScope a{outer};
+    ArenaString s(200, 'x');
+    EXPECT_GE(outer.bytesAllocated(), 200u);
+    {
+        const ArenaScope b{inner};
+        EXPECT_EQ(ArenaScope::current(), &inner);
+    }
+    EXPECT_EQ(ArenaScope::current(), &outer);
+}
+EXPECT_EQ(ArenaScope::current(), nullptr);
+
+ArenaString heap(200, 'y'); // no scope: plain heap
+EXPECT_EQ(heap.size(), 200u);
+}
+
+TEST(Arena, ParsesJsonFileIntoArena) {
+TempDir tmp;
+const auto path = tmp.join("doc.json");
+write_text(path, R"([{"name":"a fairly long string that skips SSO","n":3}])");
+
+MonotonicArena arena;
+const ArenaScope scope{arena};
+const ArenaJson* doc = parseJsonFile(path, arena);
+ASSERT_NE(doc, nullptr);
+ASSERT_TRUE(doc->is_array());
+EXPECT_EQ((*doc)[0].at("name").get<std::string>(), "a fairly long string that skips SSO");
+EXPECT_EQ((*doc)[0].at("n").get<int>(), 3);
+EXPECT_GT(arena.bytesAllocated(), 0u);
+
+write_text(path, "[{");
+EXPECT_EQ(parseJsonFile(path, arena), nullptr);
+EXPECT_EQ(parseJsonFile(tmp.join("missing.json"), arena), nullptr);
+}
+
+TEST(Arena, RepositoryReloadKeepsDataIndependentOfArena) {
+TempDir tmp;
+const auto path = tmp.join("bookings.json");
+BookingRepository repo(path);
+ASSERT_TRUE(repo.load());
+
+Booking b;
+b.bookingId = "BKG-000001";
+b.hotelId = "HTL-0001";
+b.primaryGuestId = "guest-with-a-name-longer-than-sso";
+RoomStayItem stay;
+stay.hotelId = "HTL-0001";
+stay.roomNumber = 101;
+User occupant;
+occupant.userId = "occupant-with-a-long-identifier";
+occupant.firstName = "Ada";
+stay.occupants.push_back(occupant);
+b.items.emplace_back(stay);
+ASSERT_TRUE(repo.upsert(b));
+ASSERT_TRUE(repo.saveAll());
+
+for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(repo.load());
+    auto got = repo.get("BKG-000001");
+    ASSERT_TRUE(got.has_value());
+    EXPECT_EQ(got->primaryGuestId, "guest-with-a-name-longer-than-sso");
+    ASSERT_EQ(got->items.size(), 1u);
+    const auto& loaded = std::get<RoomStayItem>(got->items[0]);
+    ASSERT_EQ(loaded.occupants.size(), 1u);
+    EXPECT_EQ(loaded.occupants[0].userId, "occupant-with-a-long-identifier");
+}
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include "../src/storage/BookingArchive.h"
+#include "../src/storage/BookingExport.h"
+#include "../src/storage/BookingRepository.h"
+#include "../src/storage/Lz.h"
+#include "../src/models/Codec.h"
+#include "../src/diagnostics/Metrics.h"
+#include "_test_support.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace hms;
+using test_support::TempDir;
+using nlohmann::json;
+namespace fs = std::filesystem;
+
+static Booking closedBooking(int n, std::int64_t at, std::string hotelId = "HTL-0001",
+                             BookingStatus status = BookingStatus::CHECKED_OUT) {
+    Booking b{};
+    char id[16];
+    std::snprintf(id, sizeof id, "BKG-%06d", n);
+    b.bookingId = id;
+    b.hotelId = std::move(hotelId);
+    b.status = status;
+    b.createdAt = b.updatedAt = at;
+    b.primaryGuestId = "USR-0001";
+    b.version = 1;
+    RoomStayItem stay;
+    stay.hotelId = b.hotelId;
+    stay.roomNumber = 100 + n % 50;
+    stay.nights = 1 + n % 4;
+    stay.nightlyRateLocked = 9900;
+    b.items.emplace_back(stay);
+    return b;
+}
+
+TEST(BookingArchive, AppendedSegmentsStreamBackInOrder) {
+TempDir tmp;
+BookingArchive archive{tmp.join("archive")};
+EXPECT_EQ(archive.segmentCount(), 0u);
+EXPECT_TRUE(archive.forEach([](const Booking&) { return true; })); // no directory yet
+
+std::vector<Booking> first, second;
+for (int i = 1; i <= 3000; ++i) first.push_back(closedBooking(i, 1000 + i, i % 2 ? "HTL-0001" : "HTL-0002"));
+for (int i = 3001; i <= 3010; ++i) second.push_back(closedBooking(i, 1000 + i));
+ASSERT_TRUE(archive.append(first));
+ASSERT_TRUE(archive.append(second));
+ASSERT_TRUE(archive.append({})); // nothing to write, no segment
+EXPECT_EQ(archive.segmentCount(), 2u);
+
+// Several blocks, and far smaller than the JSON it replaces.
+std::uintmax_t bytes = 0;
+for (const auto& entry : fs::directory_iterator(archive.directory())) bytes += entry.file_size();
+EXPECT_LT(bytes, json(first).dump().size() / 4);
+
+// Segments in append order; within one, by hotel and then creation time.
+int seen = 0;
+bool ordered = true;
+Booking previous{};
+ASSERT_TRUE(archive.forEach([&](const Booking& b) {
+    if (seen++ > 0 && seen != 3001) {
+        ordered = ordered && (previous.hotelId < b.hotelId ||
+                              (previous.hotelId == b.hotelId && previous.createdAt < b.createdAt));
+    }
+    previous = b;
+    return true;
+}));
+EXPECT_EQ(seen, 3010);
+EXPECT_TRUE(ordered);
+EXPECT_EQ(previous.bookingId, "BKG-003010");
+
+int visited = 0;
+ASSERT_TRUE(archive.forEach([&](const Booking&) { return ++visited < 5; }));
+EXPECT_EQ(visited, 5);
+
+auto got = archive.get("BKG-002999");
+ASSERT_TRUE(got.has_value());
+EXPECT_EQ(json(*got), json(first[2998]));
+EXPECT_FALSE(archive.get("BKG-999999").has_value());
+EXPECT_EQ(archive.listByHotel("HTL-0002").size(), 1500u);
+}
+
+TEST(BookingArchive, FilteredScansSkipBlocksOutsideTheirRange) {
+TempDir tmp;
+BookingArchive archive{tmp.join("archive")};
+std::vector<Booking> bookings;
+for (int i = 1; i <= 9000; ++i) bookings.push_back(closedBooking(i, 1000 + i, i % 3 ? "HTL-0001" : "HTL-0003"));
+ASSERT_TRUE(archive.append(bookings));
+
+auto& registry = diagnostics::Registry::instance();
+const auto blocksRead = [&] { return registry.counter("archive.blocksRead").value(); };
+auto before = blocksRead();
+ASSERT_TRUE(archive.forEach([](const Booking&) { return true; }));
+const auto allBlocks = blocksRead() - before;
+ASSERT_GT(allBlocks, 4u);
+
+BookingFilter filter;
+filter.hotelId = "HTL-0003";
+filter.createdFrom = 2000;
+filter.createdBefore = 3000;
+std::vector<Booking> matched;
+before = blocksRead();
+ASSERT_TRUE(archive.scan(filter, [&](const Booking& b) { matched.push_back(b); return true; }));
+EXPECT_LT(blocksRead() - before, allBlocks / 2);
+ASSERT_EQ(matched.size(), 333u); // i = 1002..1998, every third
+for (const auto& b : matched) {
+    EXPECT_TRUE(filter.matches(b));
+}
+
+filter.hotelId = "HTL-0004"; // past every block's hotel range
+before = blocksRead();
+ASSERT_TRUE(archive.scan(filter, [](const Booking&) { return true; }));
+EXPECT_EQ(blocksRead(), before);
+}
+
+TEST(BookingArchive, ReadsSegmentsWithoutAnIndex) {
+TempDir tmp;
+BookingArchive archive{tmp.join("archive")};
+std::string raw;
+BinaryWriter writer(raw);
+writeBinary(writer, closedBooking(1, 100));
+writeBinary(writer, closedBooking(2, 200, "HTL-0002"));
+std::string stored;
+lz::compress(raw, stored);
+std::string segment = "HMSSEG1\n";
+for (std::uint32_t v : {static_cast<std::uint32_t>(raw.size()), static_cast<std::uint32_t>(stored.size()), 2u}) {
+    for (int i = 0; i < 4; ++i) segment.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+segment += stored;
+fs::create_directories(archive.directory());
+std::ofstream(archive.directory() / "segment-000001.seg", std::ios::binary) << segment;
+
+ASSERT_TRUE(archive.append({closedBooking(3, 300)}));
+EXPECT_EQ(archive.segmentCount(), 2u);
+EXPECT_EQ(archive.listByHotel("HTL-0001").size(), 2u);
+ASSERT_TRUE(archive.get("BKG-000002").has_value());
+}
+
+TEST(BookingArchive, ExportStreamsHotAndArchivedBookingsAsCsv) {
+TempDir tmp;
+BookingArchive archive{tmp.join("data/archive")};
+BookingRepository repo{tmp.join("data/bookings.json")};
+ASSERT_TRUE(repo.load());
+ASSERT_TRUE(archive.append({closedBooking(1, 86400), closedBooking(2, 90000, "HTL-0002")}));
+Booking active = closedBooking(3, 100000);
+active.status = BookingStatus::ACTIVE;
+ASSERT_TRUE(repo.upsert(active));
+ASSERT_TRUE(repo.upsert(closedBooking(1, 86400))); // archived, then still hot: written once
+
+const auto csv = tmp.join("out/bookings.csv");
+fs::create_directories(csv.parent_path());
+std::size_t rows = 0;
+BookingFilter filter;
+filter.hotelId = "HTL-0001";
+ASSERT_TRUE(exportBookingsCsv(repo, &archive, filter, csv, rows));
+EXPECT_EQ(rows, 2u);
+EXPECT_EQ(test_support::read_text(csv),
+          "bookingId,hotelId,status,createdAt,updatedAt,primaryGuestId,rooms,roomNights,roomRevenue,diningRevenue\n"
+          "BKG-000003,HTL-0001,ACTIVE,1970-01-02T03:46:40Z,1970-01-02T03:46:40Z,USR-0001,1,4,396.00,0.00\n"
+          "BKG-000001,HTL-0001,CHECKED_OUT,1970-01-02T00:00:00Z,1970-01-02T00:00:00Z,USR-0001,1,2,198.00,0.00\n");
+
+ASSERT_TRUE(exportBookingsCsv(repo, &archive, BookingFilter{}, csv, rows));
+EXPECT_EQ(rows, 3u);
+}
+
+TEST(BookingArchive, DamagedSegmentsKeepTheirIntactBlocks) {
+TempDir tmp;
+BookingArchive archive{tmp.join("archive")};
+std::vector<Booking> bookings;
+for (int i = 1; i <= 50; ++i) bookings.push_back(closedBooking(i, i));
+ASSERT_TRUE(archive.append(bookings));
+auto& registry = diagnostics::Registry::instance();
+const auto damaged = registry.counter("archive.damagedSegments").value();
+const auto checksumErrors = registry.counter("archive.checksumErrors").value();
+
+// Torn at the end: the index is gone, the checksummed block is still read.
+const auto segment = fs::directory_iterator(archive.directory())->path();
+const auto text = test_support::read_text(segment);
+std::ofstream(segment, std::ios::binary | std::ios::trunc) << text.substr(0, text.size() - 3);
+int seen = 0;
+EXPECT_TRUE(archive.forEach([&](const Booking&) { ++seen; return true; }));
+EXPECT_EQ(seen, 50);
+EXPECT_EQ(registry.counter("archive.damagedSegments").value(), damaged + 1);
+
+// A flipped bit inside the block fails its checksum instead of decoding
+// into wrong bookings.
+auto flipped = text;
+flipped[8 + 16 + 5] ^= 0x10;
+std::ofstream(segment, std::ios::binary | std::ios::trunc) << flipped;
+seen = 0;
+EXPECT_FALSE(archive.forEach([&](const Booking&) { ++seen; return true; }));
+EXPECT_EQ(seen, 0);
+EXPECT_EQ(registry.counter("archive.checksumErrors").value(), checksumErrors + 1);
+}
+
+TEST(BookingArchive, ArchiveClosedKeepsActiveAndRecentBookingsHot) {
+TempDir tmp;
+const auto path = tmp.join("data/bookings.json");
+BookingArchive archive{tmp.join("data/archive")};
+BookingRepository repo{path};
+ASSERT_TRUE(repo.load());
+
+Booking active = closedBooking(1, 100);
+active.status = BookingStatus::ACTIVE;
+ASSERT_TRUE(repo.upsert(active));
+ASSERT_TRUE(repo.upsert(closedBooking(2, 100)));                                          // old, checked out
+ASSERT_TRUE(repo.upsert(closedBooking(3, 200, "HTL-0002", BookingStatus::CANCELLED)));    // old, cancelled
+ASSERT_TRUE(repo.upsert(closedBooking(4, 5000)));                                         // recently closed
+ASSERT_TRUE(repo.upsert(closedBooking(5, 100)));                                          // old but the newest id
+ASSERT_TRUE(repo.saveAll());
+
+std::size_t moved = 0;
+ASSERT_TRUE(repo.archiveClosed(archive, 1000, moved));
+EXPECT_EQ(moved, 2u);
+EXPECT_EQ(repo.count(), 3u);
+EXPECT_FALSE(repo.get("BKG-000002").has_value());
+EXPECT_TRUE(repo.get("BKG-000005").has_value());
+ASSERT_TRUE(archive.get("BKG-000003").has_value());
+EXPECT_EQ(archive.get("BKG-000003")->status, BookingStatus::CANCELLED);
+
+ASSERT_TRUE(repo.archiveClosed(archive, 1000, moved));
+EXPECT_EQ(moved, 0u); // nothing left to move, no empty segment
+EXPECT_EQ(archive.segmentCount(), 1u);
+
+ASSERT_TRUE(repo.saveAll());
+BookingRepository reloaded{path};
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.count(), 3u);
+EXPECT_EQ(reloaded.nextBookingId().str(), "BKG-000006");
+}
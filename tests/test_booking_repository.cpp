@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
+#include "../src/storage/BackgroundCompactor.h"
 #include "../src/storage/BookingRepository.h"
 #include "_test_support.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <thread>
+
 using namespace hms;
 using test_support::TempDir;
 namespace fs = std::filesystem;
@@ -41,3 +48,572 @@ EXPECT_TRUE(fs::exists(path));
 EXPECT_FALSE(fs::exists(fs::path{path.string()+".tmp"}));
 }
 
+
+static Booking makeBooking(std::string id, std::int64_t createdAt, std::string hotelId="H1") {
+    Booking b{};
+    b.bookingId = std::move(id);
+    b.hotelId = std::move(hotelId);
+    b.createdAt = createdAt;
+    b.updatedAt = createdAt;
+    b.primaryGuestId = "U1";
+    return b;
+}
+
+TEST(BookingRepository, ListPageWalksNewestFirstWithStableCursor) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+ASSERT_TRUE(repo.load());
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000001", 100)));
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000002", 300)));
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000003", 200)));
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000004", 300))); // ties on createdAt -> bookingId desc
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000005", 50)));
+
+auto first = repo.listPage(std::nullopt, 2);
+ASSERT_EQ(first.items.size(), 2u);
+EXPECT_EQ(first.items[0].bookingId, "BKG-000004");
+EXPECT_EQ(first.items[1].bookingId, "BKG-000002");
+ASSERT_TRUE(first.next.has_value());
+
+// A booking inserted ahead of the cursor must not shift the following pages.
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000006", 400)));
+
+auto second = repo.listPage(first.next, 2);
+ASSERT_EQ(second.items.size(), 2u);
+EXPECT_EQ(second.items[0].bookingId, "BKG-000003");
+EXPECT_EQ(second.items[1].bookingId, "BKG-000001");
+ASSERT_TRUE(second.next.has_value());
+
+auto third = repo.listPage(second.next, 2);
+ASSERT_EQ(third.items.size(), 1u);
+EXPECT_EQ(third.items[0].bookingId, "BKG-000005");
+EXPECT_FALSE(third.next.has_value());
+}
+
+TEST(BookingRepository, ListByGuestIsNewestFirstAndTracksUpdates) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+ASSERT_TRUE(repo.load());
+auto a = makeBooking("BKG-000001", 100);
+auto b = makeBooking("BKG-000002", 200);
+auto other = makeBooking("BKG-000003", 300);
+other.primaryGuestId = "U2";
+ASSERT_TRUE(repo.upsert(a));
+ASSERT_TRUE(repo.upsert(b));
+ASSERT_TRUE(repo.upsert(other));
+
+auto mine = repo.listByGuest("U1");
+ASSERT_EQ(mine.size(), 2u);
+EXPECT_EQ(mine[0].bookingId, "BKG-000002");
+
+a.createdAt = 500; // re-keyed by upsert
+ASSERT_TRUE(repo.upsert(a));
+mine = repo.listByGuest("U1");
+ASSERT_EQ(mine.size(), 2u);
+EXPECT_EQ(mine[0].bookingId, "BKG-000001");
+
+ASSERT_TRUE(repo.remove("BKG-000001"));
+EXPECT_EQ(repo.listByGuest("U1").size(), 1u);
+EXPECT_EQ(repo.get("BKG-000003")->primaryGuestId, "U2");
+EXPECT_EQ(repo.listPage(std::nullopt, 10).items.size(), 2u);
+}
+
+TEST(BookingRepository, NextBookingIdFollowsHighestNumericSuffix) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+ASSERT_TRUE(repo.load());
+EXPECT_EQ(repo.nextBookingId(), "BKG-000001");
+
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000007", 100)));
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000003", 200)));
+ASSERT_TRUE(repo.upsert(makeBooking("LEGACY-x12", 300))); // non-numeric suffix is ignored
+EXPECT_EQ(repo.nextBookingId(), "BKG-000008");
+}
+
+TEST(BookingRepository, ReadsBothFormatVersionsAndRejectsNewerOnes) {
+TempDir tmp;
+auto path = tmp.join("bookings.json");
+BookingRepository repo{path};
+ASSERT_TRUE(repo.load());
+auto b = makeBooking("BKG-000001", 100);
+RestaurantOrderLine line;
+line.lineId = "ROL-0001";
+line.menuItemId = "M1";
+line.qty = 2;
+b.items.emplace_back(line);
+ASSERT_TRUE(repo.upsert(b));
+
+ASSERT_TRUE(repo.saveAll());
+auto text = test_support::read_text(path);
+EXPECT_EQ(text.find("{\n  \"formatVersion\": 2,\n  \"bookings\": ["), 0u);
+EXPECT_EQ(text.find("\"kind\""), std::string::npos);
+BookingRepository v2{path};
+ASSERT_TRUE(v2.load());
+EXPECT_EQ(std::get<RestaurantOrderLine>(v2.get("BKG-000001")->items.at(0)).qty, 2);
+
+EXPECT_FALSE(repo.setFormatVersion(3));
+ASSERT_TRUE(repo.setFormatVersion(1));
+ASSERT_TRUE(repo.saveAll());
+text = test_support::read_text(path);
+EXPECT_EQ(text.front(), '[');
+EXPECT_NE(text.find("\"kind\": \"RestaurantOrder\""), std::string::npos);
+BookingRepository v1{path};
+ASSERT_TRUE(v1.load());
+EXPECT_EQ(std::get<RestaurantOrderLine>(v1.get("BKG-000001")->items.at(0)).menuItemId, "M1");
+
+test_support::write_text(path, R"({"formatVersion":3,"bookings":[]})");
+EXPECT_FALSE(v1.load());
+}
+
+TEST(BookingRepository, LoadLeavesItemsEncodedUntilFirstUse) {
+TempDir tmp;
+auto path = tmp.join("bookings.json");
+{
+    BookingRepository seed{path};
+    ASSERT_TRUE(seed.load());
+    auto b = makeBooking("BKG-000001", 100);
+    RoomStayItem stay;
+    stay.hotelId = "H1";
+    stay.roomNumber = 101;
+    stay.nights = 3;
+    b.items.emplace_back(stay);
+    RestaurantOrderLine line;
+    line.lineId = "ROL-0001";
+    b.items.emplace_back(line);
+    ASSERT_TRUE(seed.upsert(b));
+    ASSERT_TRUE(seed.upsert(makeBooking("BKG-000002", 200))); // no items
+    ASSERT_TRUE(seed.saveAll());
+}
+
+BookingRepository repo{path};
+ASSERT_TRUE(repo.load());
+auto b = *repo.get("BKG-000001");
+EXPECT_EQ(b.hotelId, "H1");
+EXPECT_FALSE(b.items.isDecoded());
+EXPECT_EQ(b.items.size(), 2u);
+EXPECT_EQ(std::get<RoomStayItem>(b.items[0]).nights, 3);
+EXPECT_TRUE(b.items.isDecoded());
+EXPECT_TRUE(repo.get("BKG-000002")->items.isDecoded());
+
+// Rows inside the repository stay encoded, and saving round-trips them.
+EXPECT_FALSE(repo.get("BKG-000001")->items.isDecoded());
+const auto before = test_support::read_text(path);
+ASSERT_TRUE(repo.saveAll());
+EXPECT_EQ(test_support::read_text(path), before);
+EXPECT_FALSE(repo.get("BKG-000001")->items.isDecoded());
+}
+
+TEST(BookingRepository, UndecodableItemsReadEmptyAndBlockSaving) {
+TempDir tmp;
+auto path = tmp.join("bookings.json");
+const std::string text =
+    R"({"formatVersion":2,"bookings":[{"bookingId":"B1","hotelId":"H1","status":"ACTIVE","createdAt":1,)"
+    R"("updatedAt":1,"primaryGuestId":"U1","items":[{"t":7}]}]})";
+test_support::write_text(path, text);
+
+BookingRepository repo{path};
+ASSERT_TRUE(repo.load()); // items are only checked when used
+auto b = *repo.get("B1");
+EXPECT_FALSE(b.items.empty()); // one item announced
+EXPECT_EQ(b.items.begin(), b.items.end());
+EXPECT_TRUE(b.items.decodeFailed());
+
+EXPECT_FALSE(repo.saveAll());
+EXPECT_EQ(test_support::read_text(path), text);
+}
+
+TEST(BookingRepository, LoadRejectsMalformedHeaders) {
+TempDir tmp;
+auto path = tmp.join("bookings.json");
+BookingRepository repo{path};
+
+test_support::write_text(path, R"([{"bookingId":"B1","hotelId":"H1","createdAt":1,"updatedAt":1,"primaryGuestId":"U1"}])");
+EXPECT_FALSE(repo.load()); // status missing
+
+test_support::write_text(path, R"([{"bookingId":7,"hotelId":"H1","status":"ACTIVE","createdAt":1,"updatedAt":1,"primaryGuestId":"U1"}])");
+EXPECT_FALSE(repo.load());
+
+test_support::write_text(path, R"([{"bookingId":"B1","hotelId":"H1","status":"ACTIVE","createdAt":1,"updatedAt":1,"primaryGuestId":"U1","items":{}}])");
+EXPECT_FALSE(repo.load());
+
+test_support::write_text(path, R"([{"bookingId":"B1","hotelId":"H1","status":"ACTIVE","createdAt":1,"updatedAt":1,"primaryGuestId":"U1","note":{"x":[1]}}])");
+ASSERT_TRUE(repo.load()); // unknown fields are skipped
+EXPECT_EQ(repo.count(), 1u);
+}
+
+TEST(BookingRepository, ConcurrentSessionsGetDistinctIdsAndKeepEveryBooking) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+ASSERT_TRUE(repo.load());
+
+constexpr int kThreads = 4;
+constexpr int kPerThread = 200;
+std::vector<std::thread> sessions;
+for (int t = 0; t < kThreads; ++t) {
+    sessions.emplace_back([&repo, t] {
+        for (int i = 0; i < kPerThread; ++i) {
+            repo.upsert(makeBooking(repo.nextBookingId().str(), t * kPerThread + i));
+            (void)repo.listPage(std::nullopt, 10); // readers interleave with the writes
+            if (i % 50 == 0) repo.saveAll();
+        }
+    });
+}
+for (auto& s : sessions) s.join();
+
+EXPECT_EQ(repo.count(), static_cast<std::size_t>(kThreads * kPerThread));
+std::set<std::string> ids;
+for (const auto& b : repo.list()) ids.insert(b.bookingId.str());
+EXPECT_EQ(ids.size(), static_cast<std::size_t>(kThreads * kPerThread));
+
+BookingRepository reloaded{repo.resolvedPath()};
+ASSERT_TRUE(repo.saveAll());
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.count(), repo.count());
+}
+
+TEST(BookingRepository, VersionedWritesRejectStaleCopies) {
+TempDir tmp;
+auto path = tmp.join("bookings.json");
+test_support::write_text(path, R"([{"bookingId":"B1","hotelId":"H1","status":"ACTIVE","createdAt":1,"updatedAt":1,"primaryGuestId":"U1"}])");
+BookingRepository repo{path};
+ASSERT_TRUE(repo.load());
+EXPECT_EQ(repo.get("B1")->version, 1u); // unversioned files start at 1
+
+auto first = *repo.get("B1");
+auto second = *repo.get("B1");
+first.status = BookingStatus::CHECKED_OUT;
+ASSERT_TRUE(repo.upsertIfUnchanged(first));
+EXPECT_EQ(first.version, 2u);
+
+second.status = BookingStatus::CANCELLED;
+EXPECT_FALSE(repo.upsertIfUnchanged(second)); // read version 1, store is at 2
+EXPECT_FALSE(repo.removeIfUnchanged(second));
+EXPECT_EQ(repo.get("B1")->status, BookingStatus::CHECKED_OUT);
+
+auto fresh = makeBooking("B2", 5);
+ASSERT_TRUE(repo.upsertIfUnchanged(fresh)); // version 0: must be new
+auto duplicate = makeBooking("B2", 6);
+EXPECT_FALSE(repo.upsertIfUnchanged(duplicate));
+
+ASSERT_TRUE(repo.upsert(second)); // unconditional: last writer wins
+EXPECT_EQ(repo.get("B1")->version, 3u);
+EXPECT_FALSE(repo.removeIfUnchanged(first));
+EXPECT_TRUE(repo.removeIfUnchanged(*repo.get("B1")));
+
+ASSERT_TRUE(repo.saveAll());
+BookingRepository reloaded{path};
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.get("B2")->version, 1u);
+}
+
+TEST(BookingRepository, UpdateRetriesSoConcurrentChangesAllLand) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+ASSERT_TRUE(repo.load());
+ASSERT_TRUE(repo.upsert(makeBooking("B1", 1)));
+
+constexpr int kThreads = 4;
+constexpr int kPerThread = 250;
+std::vector<std::thread> sessions;
+for (int t = 0; t < kThreads; ++t) {
+    sessions.emplace_back([&repo] {
+        for (int i = 0; i < kPerThread; ++i) {
+            const auto stored = repo.update("B1", [](Booking& b) {
+                ++b.updatedAt;
+                return true;
+            }, /*attempts=*/1000);
+            EXPECT_TRUE(stored.has_value());
+        }
+    });
+}
+for (auto& s : sessions) s.join();
+
+const auto b = *repo.get("B1");
+EXPECT_EQ(b.updatedAt, 1 + kThreads * kPerThread); // no increment lost
+EXPECT_EQ(b.version, 1u + kThreads * kPerThread);
+
+EXPECT_FALSE(repo.update("B1", [](Booking&) { return false; }).has_value());
+EXPECT_FALSE(repo.update("nope", [](Booking&) { return true; }).has_value());
+EXPECT_EQ(repo.get("B1")->version, b.version);
+}
+
+TEST(BookingRepository, ShardedModeSplitsTheSingleFileAndSavesOnlyChangedShards) {
+TempDir tmp;
+auto path = tmp.join("data/bookings.json");
+{
+    BookingRepository single{path};
+    ASSERT_TRUE(single.load());
+    ASSERT_TRUE(single.upsert(makeBooking("BKG-000001", 100, "HTL-0001")));
+    ASSERT_TRUE(single.upsert(makeBooking("BKG-000002", 200, "HTL-0002")));
+    ASSERT_TRUE(single.upsert(makeBooking("BKG-000003", 300, "HTL-0001")));
+    ASSERT_TRUE(single.saveAll());
+}
+
+BookingRepository repo{path};
+repo.setSharded(true);
+ASSERT_TRUE(repo.load());
+EXPECT_EQ(repo.shardCount(), 2u);
+EXPECT_EQ(repo.count(), 3u);
+ASSERT_TRUE(repo.saveAll());
+const auto dir = repo.shardDirectory();
+EXPECT_EQ(dir, tmp.join("data/bookings"));
+ASSERT_TRUE(fs::exists(dir / "HTL-0001.json"));
+ASSERT_TRUE(fs::exists(dir / "HTL-0002.json"));
+EXPECT_TRUE(fs::exists(path)); // left in place
+
+fs::remove(dir / "HTL-0002.json");
+auto b = *repo.get("BKG-000001");
+b.status = BookingStatus::CHECKED_OUT;
+ASSERT_TRUE(repo.upsertIfUnchanged(b));
+ASSERT_TRUE(repo.saveAll());
+EXPECT_FALSE(fs::exists(dir / "HTL-0002.json")); // unchanged shard not rewritten
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000004", 400, "HTL-0002")));
+ASSERT_TRUE(repo.saveAll());
+
+BookingRepository reloaded{path};
+reloaded.setSharded(true);
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.count(), 4u); // a changed shard is written in full
+EXPECT_EQ(reloaded.get("BKG-000001")->status, BookingStatus::CHECKED_OUT);
+EXPECT_EQ(reloaded.listByHotel("HTL-0002").size(), 2u);
+EXPECT_EQ(reloaded.nextBookingId(), "BKG-000005");
+}
+
+TEST(BookingRepository, ShardedQueriesFanOutAndMerge) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+repo.setSharded(true);
+ASSERT_TRUE(repo.load());
+for (int i = 1; i <= 9; ++i) {
+    const std::string hotel = "H" + std::to_string(i % 3);
+    ASSERT_TRUE(repo.upsert(makeBooking("BKG-00000" + std::to_string(i), i * 10, hotel)));
+}
+EXPECT_EQ(repo.shardCount(), 3u);
+
+std::vector<std::string> seen;
+std::optional<BookingCursor> cursor;
+do {
+    auto page = repo.listPage(cursor, 4);
+    for (const auto& b : page.items) seen.push_back(b.bookingId.str());
+    cursor = page.next;
+} while (cursor);
+ASSERT_EQ(seen.size(), 9u);
+EXPECT_EQ(seen.front(), "BKG-000009");
+EXPECT_EQ(seen.back(), "BKG-000001");
+EXPECT_TRUE(std::is_sorted(seen.rbegin(), seen.rend()));
+
+const auto mine = repo.listByGuest("U1");
+ASSERT_EQ(mine.size(), 9u);
+EXPECT_EQ(mine.front().bookingId, "BKG-000009");
+EXPECT_EQ(repo.listByHotel("H1").size(), 3u);
+EXPECT_TRUE(repo.listByHotel("H7").empty());
+
+// Changing the hotel moves the booking between shards.
+auto moved = *repo.get("BKG-000004");
+moved.hotelId = "H2";
+ASSERT_TRUE(repo.upsertIfUnchanged(moved));
+EXPECT_EQ(repo.listByHotel("H1").size(), 2u);
+EXPECT_EQ(repo.listByHotel("H2").size(), 4u);
+EXPECT_EQ(repo.count(), 9u);
+EXPECT_TRUE(repo.removeIfUnchanged(moved));
+EXPECT_FALSE(repo.get("BKG-000004").has_value());
+}
+
+TEST(BookingRepository, ShardedWritesForDifferentHotelsRunConcurrently) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+repo.setSharded(true);
+ASSERT_TRUE(repo.load());
+
+constexpr int kHotels = 4;
+constexpr int kPerHotel = 150;
+std::vector<std::thread> sessions;
+for (int h = 0; h < kHotels; ++h) {
+    sessions.emplace_back([&repo, h] {
+        const std::string hotel = "HTL-000" + std::to_string(h);
+        for (int i = 0; i < kPerHotel; ++i) {
+            repo.upsert(makeBooking(repo.nextBookingId().str(), h * kPerHotel + i, hotel));
+            (void)repo.listPage(std::nullopt, 10);
+            if (i % 50 == 0) repo.saveAll();
+        }
+    });
+}
+for (auto& s : sessions) s.join();
+
+EXPECT_EQ(repo.shardCount(), static_cast<std::size_t>(kHotels));
+EXPECT_EQ(repo.count(), static_cast<std::size_t>(kHotels * kPerHotel));
+ASSERT_TRUE(repo.saveAll());
+BookingRepository reloaded{repo.resolvedPath()};
+reloaded.setSharded(true);
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.count(), repo.count());
+EXPECT_EQ(reloaded.listByHotel("HTL-0002").size(), static_cast<std::size_t>(kPerHotel));
+}
+
+static std::vector<std::string> journalFiles(const fs::path& dir) {
+    std::vector<std::string> names;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        const auto name = entry.path().filename().string();
+        if (name.find(".journal.") != std::string::npos) names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+TEST(BookingRepository, JournalReplaysChangesWithoutASave) {
+TempDir tmp;
+auto path = tmp.join("data/bookings.json");
+{
+    BookingRepository repo{path};
+    repo.setJournaled(true);
+    ASSERT_TRUE(repo.load());
+    ASSERT_TRUE(repo.upsert(makeBooking("BKG-000001", 100)));
+    ASSERT_TRUE(repo.upsert(makeBooking("BKG-000002", 200)));
+    auto b = *repo.get("BKG-000001");
+    b.status = BookingStatus::CANCELLED;
+    ASSERT_TRUE(repo.upsertIfUnchanged(b));
+    ASSERT_TRUE(repo.remove("BKG-000002"));
+    EXPECT_GT(repo.journalBytes(), 0u);
+    ASSERT_TRUE(repo.saveAll()); // nothing to do: every change is journaled
+}
+EXPECT_EQ(journalFiles(tmp.join("data")), std::vector<std::string>{"bookings.json.journal.0"});
+
+BookingRepository reloaded{path};
+reloaded.setJournaled(true);
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.count(), 1u);
+EXPECT_EQ(reloaded.get("BKG-000001")->status, BookingStatus::CANCELLED);
+EXPECT_EQ(reloaded.get("BKG-000001")->version, 2u);
+EXPECT_EQ(reloaded.nextBookingId(), "BKG-000003"); // as before: the removed id is not reused
+
+// Compaction folds the journal into the snapshot and deletes it.
+ASSERT_TRUE(reloaded.compact());
+EXPECT_EQ(reloaded.journalBytes(), 0u);
+EXPECT_TRUE(journalFiles(tmp.join("data")).empty());
+
+// Without journaling the journal is still replayed, then saved away.
+ASSERT_TRUE(reloaded.upsert(makeBooking("BKG-000003", 300)));
+BookingRepository plain{path};
+ASSERT_TRUE(plain.load());
+EXPECT_EQ(plain.count(), 2u);
+ASSERT_TRUE(plain.saveAll());
+EXPECT_TRUE(journalFiles(tmp.join("data")).empty());
+BookingRepository again{path};
+ASSERT_TRUE(again.load());
+EXPECT_EQ(again.count(), 2u);
+}
+
+TEST(BookingRepository, CompactionRunsAlongsideWriters) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+repo.setSharded(true);
+repo.setJournaled(true);
+ASSERT_TRUE(repo.load());
+
+constexpr int kHotels = 3;
+constexpr int kPerHotel = 200;
+{
+    BackgroundCompactor compactor{repo, /*threshold=*/4096, std::chrono::milliseconds(2)};
+    std::vector<std::thread> sessions;
+    for (int h = 0; h < kHotels; ++h) {
+        sessions.emplace_back([&repo, h] {
+            const std::string hotel = "HTL-000" + std::to_string(h);
+            for (int i = 0; i < kPerHotel; ++i) {
+                const auto id = repo.nextBookingId();
+                repo.upsert(makeBooking(id.str(), h * kPerHotel + i, hotel));
+                // Every other booking moves to the next hotel, across shards.
+                if (i % 2 == 0) {
+                    auto b = *repo.get(id);
+                    b.hotelId = "HTL-000" + std::to_string((h + 1) % kHotels);
+                    repo.upsertIfUnchanged(b);
+                }
+            }
+        });
+    }
+    for (auto& s : sessions) s.join();
+    EXPECT_GT(compactor.compactions(), 0u);
+}
+ASSERT_TRUE(repo.compact());
+EXPECT_TRUE(journalFiles(repo.shardDirectory()).empty());
+
+BookingRepository reloaded{repo.resolvedPath()};
+reloaded.setSharded(true);
+reloaded.setJournaled(true);
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.count(), static_cast<std::size_t>(kHotels * kPerHotel));
+for (const auto& b : repo.list()) {
+    const auto copy = reloaded.get(b.bookingId);
+    ASSERT_TRUE(copy.has_value());
+    EXPECT_EQ(copy->hotelId, b.hotelId);
+    EXPECT_EQ(copy->version, b.version);
+}
+}
+
+TEST(BookingRepository, ReplayCopesWithCrashesMidWayThroughAChange) {
+TempDir tmp;
+BookingRepository repo{tmp.join("bookings.json")};
+repo.setSharded(true);
+repo.setJournaled(true);
+ASSERT_TRUE(repo.load());
+ASSERT_TRUE(repo.upsert(makeBooking("BKG-000001", 100, "H1")));
+ASSERT_TRUE(repo.compact()); // H1.json is generation 1
+const auto dir = repo.shardDirectory();
+
+auto b = *repo.get("BKG-000001");
+b.hotelId = "H2";
+ASSERT_TRUE(repo.upsertIfUnchanged(b));
+EXPECT_EQ(journalFiles(dir), (std::vector<std::string>{"H1.json.journal.1", "H2.json.journal.0"}));
+// Crash after the put reached H2's journal but before the delete reached H1's.
+fs::remove(dir / "H1.json.journal.1");
+// And a journal left behind by a compaction that died before deleting it.
+{
+    std::ofstream stale(dir / "H1.json.journal.0");
+    stale << R"({"op":"put","booking":{"bookingId":"BKG-000009","hotelId":"H1","primaryGuestId":"U1"}})" << '\n';
+}
+
+BookingRepository reloaded{repo.resolvedPath()};
+reloaded.setSharded(true);
+reloaded.setJournaled(true);
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.count(), 1u); // the newer copy wins; the stale journal is ignored
+EXPECT_EQ(reloaded.get("BKG-000001")->hotelId, "H2");
+EXPECT_TRUE(reloaded.listByHotel("H1").empty());
+}
+
+TEST(BookingRepository, TornJournalRecordsAreDroppedAndReported) {
+TempDir tmp;
+auto path = tmp.join("data/bookings.json");
+const auto journal = tmp.join("data/bookings.json.journal.0");
+{
+    BookingRepository repo{path};
+    repo.setJournaled(true);
+    ASSERT_TRUE(repo.load());
+    ASSERT_TRUE(repo.upsert(makeBooking("BKG-000001", 100)));
+    ASSERT_TRUE(repo.upsert(makeBooking("BKG-000002", 200)));
+}
+const auto good = fs::file_size(journal);
+{
+    // A record that fails its checksum, then one cut off mid-write.
+    std::ofstream out(journal, std::ios::binary | std::ios::app);
+    out << R"(00000000 {"op":"del","bookingId":"BKG-000001"})" << '\n';
+    out << R"(1234abcd {"op":"put","booking":{"bookingId":"BKG-0)";
+}
+const auto torn = fs::file_size(journal) - good;
+
+BookingRepository repo{path};
+repo.setJournaled(true);
+ASSERT_TRUE(repo.load());
+EXPECT_EQ(repo.count(), 2u);
+EXPECT_EQ(repo.lastRecovery().droppedRecords, 2u);
+EXPECT_EQ(repo.lastRecovery().droppedBytes, torn);
+ASSERT_EQ(repo.lastRecovery().truncatedFiles.size(), 1u);
+EXPECT_EQ(fs::file_size(journal), good); // cut back to the last good record
+
+// Appends carry on after the good records.
+ASSERT_TRUE(repo.remove("BKG-000002"));
+BookingRepository reloaded{path};
+reloaded.setJournaled(true);
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.count(), 1u);
+EXPECT_EQ(reloaded.lastRecovery().droppedRecords, 0u);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "../src/models/Booking.h"
+#include "../src/models/Codec.h"
+#include "../src/models/Hotel.h"
+#include "../src/models/Restaurant.h"
+#include "../src/models/Room.h"
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using namespace hms;
+using nlohmann::json;
+
+namespace {
+
+Booking sampleBooking() {
+    Booking b;
+    b.bookingId = "BKG-000007";
+    b.hotelId = "HTL-0002";
+    b.status = BookingStatus::CHECKED_OUT;
+    b.createdAt = 1700000000;
+    b.updatedAt = -5;
+    b.primaryGuestId = "USR-0001";
+
+    RoomStayItem stay;
+    stay.hotelId = "HTL-0002";
+    stay.roomNumber = 305;
+    stay.nights = 3;
+    stay.nightlyRateLocked = 12900;
+    User guest;
+    guest.userId = "USR-0001";
+    guest.firstName = "Zo\xC3\xAB";
+    guest.lastName = "O\"Neil\\\n";
+    guest.role = Role::MANAGER;
+    stay.occupants.push_back(guest);
+    b.items.emplace_back(stay);
+
+    RestaurantOrderLine line;
+    line.lineId = "ROL-0001";
+    line.restaurantId = "R-1";
+    line.category = "Dinner";
+    line.menuItemId = "M-9";
+    line.nameSnapshot = "Tab\there";
+    line.unitPriceSnapshot = 1850;
+    line.qty = 2;
+    line.billedRoomNumber = 305;
+    b.items.emplace_back(line);
+    return b;
+}
+
+}
+
+TEST(Codec, JsonWriterMatchesNlohmannLayout) {
+const std::vector<std::vector<std::string>> nested{{"a", "b\x01\x1f"}, {}, {"\"q\"", "\\", "\b\f\n\r\t"}};
+EXPECT_EQ(toJsonText(nested, 2), json(nested).dump(2));
+EXPECT_EQ(toJsonText(nested), json(nested).dump());
+EXPECT_EQ(toJsonText(std::vector<int>{}), "[]");
+EXPECT_EQ(toJsonText(std::vector<std::int64_t>{-1, 0, INT64_MAX}, 4), json(std::vector<std::int64_t>{-1, 0, INT64_MAX}).dump(4));
+}
+
+TEST(Codec, WriterAndDomAgreeOnModels) {
+const auto b = sampleBooking();
+const json dom = b;
+EXPECT_EQ(json::parse(toJsonText(b)), dom);
+EXPECT_EQ(json::parse(toJsonText(b, 2)), dom);
+EXPECT_EQ(dom.at("status"), "CHECKED_OUT");
+EXPECT_EQ(dom.at("items").at(1).at("t"), 1);
+EXPECT_EQ(dom.at("items").at(1).at("lineId"), "ROL-0001");
+EXPECT_FALSE(dom.at("items").at(0).at("occupants").at(0).contains("password"));
+
+// Fields come out in declaration order.
+const auto text = toJsonText(b);
+EXPECT_LT(text.find("\"bookingId\""), text.find("\"hotelId\""));
+EXPECT_LT(text.find("\"updatedAt\""), text.find("\"primaryGuestId\""));
+
+const auto back = dom.get<Booking>();
+EXPECT_EQ(json(back), dom);
+}
+
+TEST(Codec, JsonReadsLegacyAndOptionalFields) {
+const auto room = json::parse(R"({"hotelId":"HTL-0001","number":12})").get<Room>();
+EXPECT_EQ(room.id, "HTL-0001-12");
+EXPECT_EQ(room.beds, 1);
+
+const auto restaurant = json::parse(R"({"id":"R1","hotelId":"HTL-0001","name":"N","cuisine":"Thai"})").get<Restaurant>();
+EXPECT_EQ(restaurant.cuisine, "Thai");
+EXPECT_FALSE(json(restaurant).contains("cuisine"));
+EXPECT_EQ(json(restaurant).at("style"), "Thai");
+
+EXPECT_THROW(json::parse(R"({"hotelId":"H","roomNumber":1})").get<RoomStayItem>(), std::out_of_range);
+EXPECT_THROW(json::parse(R"({"kind":"Spa","value":{}})").get<BookingItem>(), std::runtime_error);
+EXPECT_THROW(json::parse(R"({"t":2})").get<BookingItem>(), std::runtime_error);
+}
+
+TEST(Codec, BookingItemsReadFlatAndNestedLayouts) {
+const auto b = sampleBooking();
+const auto nested = [&] {
+    std::string out;
+    StringSink sink{out};
+    JsonWriter<StringSink> w(sink, -1, VariantLayout::Nested);
+    writeJson(w, b);
+    return out;
+}();
+EXPECT_NE(nested.find(R"("kind":"RestaurantOrder","value":{"lineId")"), std::string::npos);
+
+const auto flat = toJsonText(b);
+EXPECT_NE(flat.find(R"({"t":1,"lineId")"), std::string::npos);
+EXPECT_LT(flat.size(), nested.size());
+
+EXPECT_EQ(json(json::parse(nested).get<Booking>()), json(b));
+EXPECT_EQ(json(json::parse(flat).get<Booking>()), json(b));
+}
+
+TEST(Codec, BinaryRoundTrip) {
+const auto b = sampleBooking();
+const auto bytes = encodeBinary(b);
+EXPECT_LT(bytes.size(), toJsonText(b).size() / 2);
+
+Booking back;
+ASSERT_TRUE(decodeBinary(bytes, back));
+EXPECT_EQ(json(back), json(b));
+
+for (std::size_t cut = 0; cut < bytes.size(); ++cut) {
+    Booking partial;
+    EXPECT_FALSE(decodeBinary(std::string_view(bytes).substr(0, cut), partial)) << cut;
+}
+}
+
+TEST(Codec, BinaryAcceptsRecordsWithFewerFields) {
+// A Hotel written before "stars" and "address" existed.
+std::string old;
+BinaryWriter w(old);
+w.varint(2);
+w.bytes("HTL-0009");
+w.bytes("Old Inn");
+
+Hotel h;
+ASSERT_TRUE(decodeBinary(old, h));
+EXPECT_EQ(h.id, "HTL-0009");
+EXPECT_EQ(h.name, "Old Inn");
+EXPECT_EQ(h.stars, 3);
+
+// More fields than the schema knows is rejected.
+std::string future = encodeBinary(h);
+future[0] = 5;
+EXPECT_FALSE(decodeBinary(future, h));
+}
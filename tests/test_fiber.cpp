@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#if defined(__linux__)
+#include "../src/server/Fiber.h"
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using hms::server::Fiber;
+
+TEST(Fiber, YieldSuspendsUntilTheNextResume) {
+std::vector<std::string> log;
+Fiber fiber([&] {
+    log.push_back("a");
+    EXPECT_NE(Fiber::current(), nullptr);
+    Fiber::yield();
+    log.push_back("b");
+});
+EXPECT_EQ(Fiber::current(), nullptr);
+
+EXPECT_TRUE(fiber.resume());
+EXPECT_EQ(log, (std::vector<std::string>{"a"}));
+EXPECT_FALSE(fiber.resume()); // ran to the end
+EXPECT_EQ(log, (std::vector<std::string>{"a", "b"}));
+EXPECT_TRUE(fiber.finished());
+EXPECT_FALSE(fiber.resume());
+}
+
+TEST(Fiber, EscapingExceptionIsRethrownByResume) {
+Fiber fiber([] { throw std::runtime_error("boom"); });
+EXPECT_THROW(fiber.resume(), std::runtime_error);
+EXPECT_TRUE(fiber.finished());
+}
+
+TEST(Fiber, SuspendingInsideCatchBlocksKeepsEachFibersException) {
+// Both fibers park while handling their own exception; each must still see
+// its own one afterwards, and rethrow it.
+auto body = [](const char* what) {
+    return [what] {
+        try {
+            throw std::runtime_error(what);
+        }
+        catch (const std::exception&) {
+            Fiber::yield();
+            try { throw; }
+            catch (const std::runtime_error& again) { EXPECT_STREQ(again.what(), what); }
+        }
+    };
+};
+Fiber first(body("first"));
+Fiber second(body("second"));
+EXPECT_TRUE(first.resume());
+EXPECT_TRUE(second.resume());
+EXPECT_EQ(std::current_exception(), nullptr); // nothing leaked into the caller
+EXPECT_FALSE(first.resume());
+EXPECT_FALSE(second.resume());
+}
+#endif
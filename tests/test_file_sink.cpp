@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "../src/storage/BookingRepository.h"
+#include "../src/storage/FileSink.h"
+#include "_test_support.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <nlohmann/json.hpp>
+
+using namespace hms;
+using test_support::TempDir;
+
+namespace {
+
+std::string readAll(const std::filesystem::path& p) {
+    std::ifstream in(p, std::ios::binary);
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    return oss.str();
+}
+
+Booking makeBooking(int n) {
+    Booking b;
+    b.bookingId = "BKG-" + std::to_string(100000 + n);
+    b.hotelId = "HTL-0001";
+    b.primaryGuestId = "USR-0001";
+    b.createdAt = n;
+    RoomStayItem stay;
+    stay.hotelId = "HTL-0001";
+    stay.roomNumber = 100 + n;
+    b.items.emplace_back(stay);
+    return b;
+}
+
+}
+
+TEST(FileSink, SmallBufferStillWritesEverythingInOrder) {
+TempDir tmp;
+const auto path = tmp.join("out.txt");
+std::string expected;
+{
+    FileSink sink(path, 64);
+    ASSERT_TRUE(sink.good());
+    for (int i = 0; i < 500; ++i) {
+        const auto chunk = std::to_string(i) + (i % 7 == 0 ? std::string(200, 'x') : ",");
+        sink.write(chunk.data(), chunk.size());
+        sink.put(';');
+        expected += chunk + ';';
+    }
+    EXPECT_EQ(sink.bytesWritten(), expected.size());
+    ASSERT_TRUE(sink.finish());
+}
+EXPECT_EQ(readAll(path), expected);
+}
+
+TEST(FileSink, AtomicWriteLeavesNoTempFile) {
+TempDir tmp;
+const auto path = tmp.join("data.json");
+std::uint64_t bytes = 0;
+ASSERT_TRUE(writeFileAtomically(path, [](FileSink& sink) { sink.write("[]", 2); }, bytes));
+EXPECT_EQ(bytes, 3u);
+EXPECT_EQ(readAll(path), "[]\n");
+EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+EXPECT_FALSE(writeFileAtomically(tmp.join("missing-dir/x.json"), [](FileSink&) {}, bytes));
+}
+
+TEST(FileSink, RepositorySavesPrettyOrCompact) {
+TempDir tmp;
+const auto path = tmp.join("bookings.json");
+BookingRepository repo(path);
+ASSERT_TRUE(repo.load());
+for (int i = 0; i < 50; ++i) ASSERT_TRUE(repo.upsert(makeBooking(i)));
+
+ASSERT_TRUE(repo.saveAll());
+const auto pretty = readAll(path);
+EXPECT_EQ(nlohmann::json::parse(pretty).at("bookings"), nlohmann::json(repo.list()));
+EXPECT_NE(pretty.find("\n    {\n      \"bookingId\": "), std::string::npos);
+
+repo.setJsonStyle(JsonStyle::Compact);
+ASSERT_TRUE(repo.saveAll());
+const auto compact = readAll(path);
+EXPECT_EQ(compact.find('\n'), compact.size() - 1);
+EXPECT_LT(compact.size() * 3, pretty.size() * 2); // at least a third smaller
+EXPECT_EQ(nlohmann::json::parse(compact), nlohmann::json::parse(pretty));
+
+BookingRepository reloaded(path);
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(nlohmann::json(reloaded.list()), nlohmann::json(repo.list()));
+}
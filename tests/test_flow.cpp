@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "../src/ui/core/Flow.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace hms::ui;
+
+namespace {
+
+Task<int> askAge(FlowInput& input) {
+    co_return co_await input.readIntInRange("Age: ", 1, 120);
+}
+
+Task<std::string> greet(FlowInput& input) {
+    const std::string name = co_await input.readLine("Name: ");
+    const int age = co_await askAge(input);
+    co_return name + " " + std::to_string(age);
+}
+
+Task<int> countLines(FlowInput& input, int& seen) {
+    try {
+        for (;;) {
+            co_await input.line();
+            ++seen;
+        }
+    }
+    catch (const InputClosed&) {
+    }
+    co_return seen;
+}
+
+}
+
+TEST(Flow, ScriptedInputRunsNestedTasksWithConsoleRetries) {
+std::istringstream none;
+std::ostringstream shown;
+SessionStreams streams(none, shown);
+
+FlowInput input;
+EXPECT_EQ(runScripted(greet(input), input, {"", "  Ada ", "abc", "300", "36"}), "Ada 36");
+EXPECT_EQ(shown.str(),
+          "Name: Please enter a value.\n"
+          "Name: Age: Please enter a number between 1 and 120.\n"
+          "Age: Please enter a number between 1 and 120.\n"
+          "Age: ");
+}
+
+TEST(Flow, SupplyResumesTheWaitingFlowOneLineAtATime) {
+std::istringstream none;
+std::ostringstream shown;
+SessionStreams streams(none, shown);
+
+FlowInput input;
+auto task = greet(input);
+EXPECT_FALSE(input.waiting());
+task.start();
+EXPECT_TRUE(input.waiting());
+EXPECT_EQ(input.waitingFor(), FlowInput::Kind::Line);
+EXPECT_FALSE(task.done());
+
+input.supply("Grace");
+EXPECT_FALSE(task.done());
+EXPECT_EQ(shown.str(), "Name: Age: ");
+
+input.supply("85");
+EXPECT_TRUE(task.done());
+EXPECT_FALSE(input.waiting());
+EXPECT_EQ(task.result(), "Grace 85");
+}
+
+TEST(Flow, PasswordsAreRequestedAsSecrets) {
+std::istringstream none;
+std::ostringstream shown;
+SessionStreams streams(none, shown);
+
+FlowInput input;
+auto task = input.readPassword("Password: ");
+task.start();
+EXPECT_EQ(input.waitingFor(), FlowInput::Kind::Secret);
+input.supply(" s3cret ");
+ASSERT_TRUE(task.done());
+EXPECT_EQ(task.result(), " s3cret "); // not trimmed, like ConsoleIO
+}
+
+TEST(Flow, ClosingTheInputThrowsInputClosedIntoTheFlow) {
+std::istringstream none;
+std::ostringstream shown;
+SessionStreams streams(none, shown);
+
+FlowInput input;
+EXPECT_THROW(runScripted(greet(input), input, {"Ada"}), InputClosed);
+
+FlowInput counted;
+int seen = 0;
+auto task = countLines(counted, seen);
+task.start();
+counted.supply("a");
+counted.supply("b");
+EXPECT_FALSE(task.done());
+counted.close();
+ASSERT_TRUE(task.done());
+EXPECT_EQ(task.result(), 2);
+}
+
+TEST(Flow, RunBlockingReadsFromTheSessionStreams) {
+std::istringstream typed("Linus\n54\n");
+std::ostringstream shown;
+SessionStreams streams(typed, shown);
+
+FlowInput input;
+EXPECT_EQ(runBlocking(greet(input), input), "Linus 54");
+
+FlowInput exhausted;
+EXPECT_THROW(runBlocking(greet(exhausted), exhausted), InputClosed);
+}
@@ -78,3 +78,31 @@ EXPECT_FALSE(repo.get("H_BAD").has_value());
 EXPECT_EQ(repo.list().size(), 1u);
 }
 
+
+TEST(HotelRepository, OrderedViewsFollowEdits) {
+TempDir tmp;
+HotelRepository repo{tmp.join("hotels.json")};
+ASSERT_TRUE(repo.load());
+ASSERT_TRUE(repo.upsert(makeHotel("H3","Charlie",4,"C St")));
+ASSERT_TRUE(repo.upsert(makeHotel("H1","Bravo",3,"B St")));
+ASSERT_TRUE(repo.upsert(makeHotel("H2","Alpha",5,"A St")));
+
+auto byId = repo.listOrderedById();
+ASSERT_EQ(byId.size(), 3u);
+EXPECT_EQ(byId[0].id, "H1");
+EXPECT_EQ(byId[2].id, "H3");
+
+// Renaming moves the hotel in the name index.
+ASSERT_TRUE(repo.upsert(makeHotel("H3","Aardvark",4,"C St")));
+auto byName = repo.listOrderedByName();
+ASSERT_EQ(byName.size(), 3u);
+EXPECT_EQ(byName[0].id, "H3");
+EXPECT_EQ(byName[1].id, "H2");
+EXPECT_EQ(byName[2].id, "H1");
+
+ASSERT_TRUE(repo.remove("H2"));
+byName = repo.listOrderedByName();
+ASSERT_EQ(byName.size(), 2u);
+EXPECT_EQ(byName[1].id, "H1");
+EXPECT_EQ(repo.get("H1")->name, "Bravo");
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "../src/models/Booking.h"
+#include "../src/models/Ids.h"
+
+#include <set>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <nlohmann/json.hpp>
+
+using namespace hms;
+
+static_assert(std::is_trivially_copyable_v<BookingId>);
+static_assert(sizeof(UserId) == 24);
+static_assert(!std::is_convertible_v<HotelId, UserId>, "id kinds must not mix");
+
+TEST(FixedId, RoundTripsAndComparesLikeStrings) {
+const BookingId a = "BKG-000001";
+const BookingId b = std::string("BKG-000002");
+EXPECT_EQ(a.view(), "BKG-000001");
+EXPECT_EQ(a.size(), 10u);
+EXPECT_EQ(a, "BKG-000001");
+EXPECT_NE(a, b);
+EXPECT_LT(a, b);
+EXPECT_LT(BookingId("BKG-1"), BookingId("BKG-10")); // prefix sorts first, as with std::string
+EXPECT_TRUE(BookingId{}.empty());
+EXPECT_EQ(a + "-G1", "BKG-000001-G1");
+
+std::set<std::string> asStrings{"HTL-0010", "HTL-0002", "HTL-0002-1", "A"};
+std::set<HotelId> asIds(asStrings.begin(), asStrings.end());
+auto s = asStrings.begin();
+for (const auto& id : asIds) EXPECT_EQ(id.view(), *s++);
+}
+
+TEST(FixedId, HashesByValue) {
+std::unordered_set<UserId> ids{"USR-0001", "USR-0002", "USR-1760517425889-21146"};
+EXPECT_EQ(ids.count(UserId("USR-0002")), 1u);
+EXPECT_EQ(ids.count(UserId("USR-1760517425889-21146")), 1u);
+EXPECT_EQ(ids.count(UserId("USR-0003")), 0u);
+EXPECT_EQ(UserId("USR-0001").hash(), UserId(std::string("USR-0001")).hash());
+}
+
+TEST(FixedId, RejectsIdsThatDoNotFit) {
+const std::string longest(UserId::kCapacity, 'x');
+UserId id;
+EXPECT_TRUE(UserId::parse(longest, id));
+EXPECT_EQ(id.view(), longest);
+EXPECT_FALSE(UserId::parse(longest + "x", id));
+EXPECT_EQ(id.view(), longest); // untouched
+EXPECT_TRUE(UserId(longest + "x").empty());
+
+nlohmann::json j = longest + "x";
+EXPECT_THROW(j.get<UserId>(), std::length_error);
+}
+
+TEST(FixedId, JsonBoundaryUsesPlainStrings) {
+Booking b;
+b.bookingId = "BKG-000042";
+b.hotelId = "HTL-0001";
+b.primaryGuestId = "USR-0001";
+const nlohmann::json j = b;
+EXPECT_TRUE(j.at("bookingId").is_string());
+EXPECT_EQ(j.at("hotelId"), "HTL-0001");
+
+const auto back = j.get<Booking>();
+EXPECT_EQ(back.bookingId, b.bookingId);
+EXPECT_EQ(back.primaryGuestId, b.primaryGuestId);
+}
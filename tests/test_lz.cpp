@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "../src/storage/Lz.h"
+
+#include <random>
+#include <string>
+
+using namespace hms;
+
+static std::string roundTrip(const std::string& raw) {
+    std::string packed;
+    lz::compress(raw, packed);
+    EXPECT_LE(packed.size(), lz::compressBound(raw.size()));
+    std::string back;
+    EXPECT_TRUE(lz::decompress(packed, raw.size(), back));
+    return back;
+}
+
+TEST(Lz, RoundTripsRepetitiveRandomAndTinyInputs) {
+EXPECT_EQ(roundTrip(""), "");
+EXPECT_EQ(roundTrip("a"), "a");
+EXPECT_EQ(roundTrip("abcdefghijklm"), "abcdefghijklm");
+
+std::string records;
+for (int i = 0; i < 2000; ++i) records += R"({"bookingId":"BKG-)" + std::to_string(100000 + i) + R"(","hotelId":"HTL-0001","status":"CHECKED_OUT"})";
+EXPECT_EQ(roundTrip(records), records);
+std::string packed;
+lz::compress(records, packed);
+EXPECT_LT(packed.size(), records.size() / 4);
+
+std::string run(100000, 'x'); // overlapping matches, long length runs
+EXPECT_EQ(roundTrip(run), run);
+
+std::mt19937 rng(42);
+std::string noise(70000, '\0'); // no matches, offsets past 64 KiB
+for (auto& c : noise) c = static_cast<char>(rng());
+EXPECT_EQ(roundTrip(noise), noise);
+}
+
+TEST(Lz, RejectsTruncatedOrMislabelledInput) {
+std::string raw;
+for (int i = 0; i < 500; ++i) raw += "room " + std::to_string(i % 37) + " night ";
+std::string packed;
+lz::compress(raw, packed);
+
+std::string out;
+EXPECT_FALSE(lz::decompress(packed, raw.size() + 1, out));
+EXPECT_FALSE(lz::decompress(packed, raw.size() - 1, out));
+for (std::size_t cut = 0; cut < packed.size(); cut += 7) {
+    EXPECT_FALSE(lz::decompress(std::string_view(packed).substr(0, cut), raw.size(), out)) << cut;
+}
+std::string badOffset = packed;
+for (auto& c : badOffset) c = static_cast<char>(c ^ 0x5a);
+lz::decompress(badOffset, raw.size(), out); // must not crash; result unspecified
+}
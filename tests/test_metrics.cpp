@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "../src/diagnostics/Metrics.h"
+#include "../src/storage/HotelRepository.h"
+#include "_test_support.h"
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using namespace hms;
+using namespace hms::diagnostics;
+using test_support::TempDir;
+
+TEST(Metrics, HistogramBucketsStayWithinOneSixteenth) {
+for (std::uint64_t v : std::initializer_list<std::uint64_t>{0, 1, 15, 16, 17, 31, 32, 1000, 123456789, std::uint64_t{1} << 40, UINT64_MAX}) {
+    const auto bucket = LatencyHistogram::bucketFor(v);
+    ASSERT_LT(bucket, LatencyHistogram::kBucketCount);
+    EXPECT_LE(LatencyHistogram::lowerBound(bucket), v);
+    EXPECT_GE(LatencyHistogram::upperBound(bucket), v);
+    const auto width = LatencyHistogram::upperBound(bucket) - LatencyHistogram::lowerBound(bucket);
+    EXPECT_LE(width, v / 16) << v;
+}
+EXPECT_EQ(LatencyHistogram::bucketFor(LatencyHistogram::upperBound(100)), 100u);
+EXPECT_EQ(LatencyHistogram::bucketFor(LatencyHistogram::upperBound(100) + 1), 101u);
+}
+
+TEST(Metrics, HistogramPercentiles) {
+LatencyHistogram h;
+EXPECT_EQ(h.percentile(50), 0u);
+for (std::uint64_t v = 1; v <= 1000; ++v) h.record(v * 1000);
+EXPECT_EQ(h.count(), 1000u);
+EXPECT_EQ(h.min(), 1000u);
+EXPECT_EQ(h.max(), 1'000'000u);
+EXPECT_NEAR(static_cast<double>(h.percentile(50)), 500'000.0, 500'000.0 / 16);
+EXPECT_NEAR(static_cast<double>(h.percentile(99)), 990'000.0, 990'000.0 / 16);
+EXPECT_EQ(h.percentile(100), 1'000'000u);
+
+h.reset();
+EXPECT_EQ(h.count(), 0u);
+EXPECT_EQ(h.min(), 0u);
+}
+
+TEST(Metrics, RepositoryOperationsAreRecordedAndDumped) {
+auto& registry = Registry::instance();
+const auto before = registry.histogram("hotels.upsert").count();
+
+TempDir tmp;
+HotelRepository repo{tmp.join("hotels.json")};
+ASSERT_TRUE(repo.load());
+Hotel h{};
+h.id = "H1";
+h.name = "Alpha";
+ASSERT_TRUE(repo.upsert(h));
+ASSERT_TRUE(repo.saveAll());
+EXPECT_EQ(registry.histogram("hotels.upsert").count(), before + 1);
+EXPECT_GT(registry.counter("hotels.bytesWritten").value(), 0u);
+
+const auto dump = tmp.join("out/metrics.json");
+ASSERT_TRUE(registry.dumpToFile(dump));
+std::ifstream in(dump);
+nlohmann::json doc;
+in >> doc;
+ASSERT_TRUE(doc.at("histograms").contains("hotels.upsert"));
+EXPECT_GE(doc["histograms"]["hotels.upsert"]["count"].get<std::uint64_t>(), 1u);
+EXPECT_FALSE(doc["histograms"]["hotels.upsert"]["buckets"].empty());
+EXPECT_TRUE(doc.at("counters").contains("hotels.bytesWritten"));
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "../src/pricing/PricingEngine.h"
+#include "_test_support.h"
+
+using namespace hms;
+using test_support::TempDir;
+namespace fs = std::filesystem;
+
+static Room makeRoom(const std::string& id, const std::string& typeId) {
+    Room r{};
+    r.id = id;
+    r.hotelId = "H1";
+    r.number = 101;
+    r.typeId = typeId;
+    r.beds = 2;
+    r.sizeSqm = 30;
+    r.amenities = {"Sea View", "Mini Bar", "Desk"};
+    return r;
+}
+
+TEST(PricingEngine, LoadWritesBuiltInTariffIfMissing) {
+TempDir tmp;
+auto path = tmp.join("data/pricing.json");
+PricingEngine engine{path};
+ASSERT_TRUE(engine.load());
+EXPECT_TRUE(fs::exists(path));
+
+PricingEngine reloaded{path};
+ASSERT_TRUE(reloaded.load());
+EXPECT_EQ(reloaded.listTypes().size(), 4u);
+EXPECT_EQ(reloaded.amenitySurcharge("Balcony"), 1800);
+}
+
+TEST(PricingEngine, MatchesLegacyTariff) {
+TempDir tmp;
+PricingEngine engine{tmp.join("pricing.json")};
+ASSERT_TRUE(engine.load());
+
+// DELUXE base + one extra bed + 30 sqm + Sea View + Mini Bar; "Desk" is free.
+EXPECT_EQ(engine.rateFor(makeRoom("H1-101", "DELUXE")), 15000 + 2000 + 2100 + 1800 + 1200);
+// Unknown types fall back to the default base rate.
+EXPECT_EQ(engine.rateFor(makeRoom("H1-101", "ATTIC")), 9000 + 2000 + 2100 + 1800 + 1200);
+
+Room tiny{};
+tiny.id = "H1-1";
+tiny.typeId = "ATTIC";
+tiny.beds = 1;
+EXPECT_EQ(engine.rateFor(tiny), 9000);
+
+PricingRules rules = engine.rules();
+rules.defaultNightlyRateCents = 1000;
+engine.setRules(rules);
+EXPECT_EQ(engine.rateFor(tiny), 5000); // minimum applies
+}
+
+TEST(PricingEngine, LoadsTariffFromFile) {
+TempDir tmp;
+auto path = tmp.join("pricing.json");
+test_support::write_text(path, R"({
+  "defaultNightlyRateCents": 4000,
+  "minimumNightlyRateCents": 0,
+  "extraBedCents": 100,
+  "perSqmCents": 0,
+  "roomTypes": [{"id":"LOFT","name":"Loft","nightlyRateCents":7000}],
+  "amenitySurchargesCents": {"Desk": 50}
+})");
+PricingEngine engine{path};
+ASSERT_TRUE(engine.load());
+EXPECT_FALSE(engine.getType("DELUXE").has_value());
+EXPECT_EQ(engine.rateFor(makeRoom("H1-101", "LOFT")), 7000 + 100 + 50);
+EXPECT_EQ(engine.rateFor(makeRoom("H1-101", "DELUXE")), 4000 + 100 + 50);
+}
+
+TEST(PricingEngine, QuotesAreCachedUntilInvalidated) {
+TempDir tmp;
+PricingEngine engine{tmp.join("pricing.json")};
+ASSERT_TRUE(engine.load());
+
+auto room = makeRoom("H1-101", "SUITE");
+engine.precompute({room, makeRoom("H1-102", "STANDARD")});
+EXPECT_EQ(engine.cachedCount(), 2u);
+const auto before = engine.quote(room);
+
+room.amenities.clear();
+EXPECT_EQ(engine.quote(room), before); // stale until the caller invalidates
+engine.invalidateRoom(room.id);
+EXPECT_EQ(engine.quote(room), 22000 + 2000 + 2100);
+EXPECT_EQ(engine.cachedCount(), 2u);
+}
+
+TEST(PricingEngine, TypeEditsInvalidateEveryQuote) {
+TempDir tmp;
+auto path = tmp.join("pricing.json");
+PricingEngine engine{path};
+ASSERT_TRUE(engine.load());
+
+auto room = makeRoom("H1-101", "SUITE");
+const auto before = engine.quote(room);
+
+auto suite = *engine.getType("SUITE");
+suite.nightlyRateCents += 500;
+ASSERT_TRUE(engine.upsertType(suite));
+EXPECT_EQ(engine.cachedCount(), 0u);
+EXPECT_EQ(engine.quote(room), before + 500);
+
+// Inactive or removed types price like unknown ones.
+suite.active = false;
+ASSERT_TRUE(engine.upsertType(suite));
+EXPECT_EQ(engine.quote(room), before - 22000 + 9000);
+ASSERT_TRUE(engine.removeType("SUITE"));
+EXPECT_FALSE(engine.removeType("SUITE"));
+EXPECT_EQ(engine.quote(room), before - 22000 + 9000);
+
+ASSERT_TRUE(engine.saveAll());
+PricingEngine reloaded{path};
+ASSERT_TRUE(reloaded.load());
+EXPECT_FALSE(reloaded.getType("SUITE").has_value());
+EXPECT_EQ(reloaded.listTypes().size(), 3u);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "../src/storage/RestaurantRepository.h"
+#include "_test_support.h"
+
+using namespace hms;
+using test_support::TempDir;
+namespace fs = std::filesystem;
+
+static const char* kCatalogue = R"({
+  "hotels": [],
+  "restaurants": [
+    {"id":"R1","hotelId":"H1","name":"Cafe","style":"Breakfast bar","menu":[
+      {"id":"coffee","name":"Coffee","category":"Drinks","priceCents":300},
+      {"id":"eggs","name":"Eggs","category":"Breakfast","priceCents":900},
+      {"id":"juice","name":"Juice","category":"Drinks","priceCents":400}
+    ]},
+    {"id":"R2","hotelId":"H1","name":"Grill","menu":[
+      {"id":"steak","name":"Steak","category":"Dinner","priceCents":3100}
+    ]},
+    {"id":"R3","hotelId":"H2","name":"Bistro","menu":[]}
+  ]
+})";
+
+TEST(RestaurantRepository, LoadCreatesEmptyCatalogueIfMissing) {
+TempDir tmp;
+auto path = tmp.join("data/catalogue.json");
+RestaurantRepository repo{path};
+ASSERT_TRUE(repo.load());
+EXPECT_TRUE(fs::exists(path));
+EXPECT_TRUE(repo.list().empty());
+}
+
+TEST(RestaurantRepository, IndexesByHotelRestaurantAndCategory) {
+TempDir tmp;
+auto path = tmp.join("catalogue.json");
+test_support::write_text(path, kCatalogue);
+RestaurantRepository repo{path};
+ASSERT_TRUE(repo.load());
+
+EXPECT_EQ(repo.list().size(), 3u);
+auto atH1 = repo.listByHotel("H1");
+ASSERT_EQ(atH1.size(), 2u);
+EXPECT_EQ(atH1[0].id, "R1");
+EXPECT_EQ(atH1[0].cuisine, "Breakfast bar");
+EXPECT_TRUE(repo.listByHotel("nope").empty());
+
+auto drinks = repo.menuFor("R1", "Drinks");
+ASSERT_EQ(drinks.size(), 2u);
+EXPECT_EQ(drinks[0].id, "coffee");
+EXPECT_EQ(drinks[1].restaurantId, "R1");
+
+auto categories = repo.categoriesFor("R1");
+ASSERT_EQ(categories.size(), 2u);
+EXPECT_EQ(categories[0], "Breakfast");
+
+auto menu = repo.menuFor("R1"); // grouped by category
+ASSERT_EQ(menu.size(), 3u);
+EXPECT_EQ(menu[0].id, "eggs");
+
+auto steak = repo.menuItem("R2", "steak");
+ASSERT_TRUE(steak.has_value());
+EXPECT_EQ(steak->price, 3100);
+EXPECT_FALSE(repo.menuItem("R1", "steak").has_value());
+EXPECT_TRUE(repo.menuFor("R3").empty());
+}
+
+TEST(RestaurantRepository, LoadRejectsNonObjectCatalogue) {
+TempDir tmp;
+auto path = tmp.join("catalogue.json");
+test_support::write_text(path, "[]");
+RestaurantRepository repo{path};
+EXPECT_FALSE(repo.load());
+}
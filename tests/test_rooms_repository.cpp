@@ -58,3 +58,24 @@ test_support::write_text(path, R"({"no":"array"})");
 RoomsRepository repo{path};
 EXPECT_FALSE(repo.load());
 }
+
+TEST(RoomsRepository, ListByHotelPageOrdersByNumber) {
+TempDir tmp;
+RoomsRepository repo{tmp.join("rooms.json")};
+ASSERT_TRUE(repo.load());
+ASSERT_TRUE(repo.upsert(makeRoom("H1",103)));
+ASSERT_TRUE(repo.upsert(makeRoom("H2",101)));
+ASSERT_TRUE(repo.upsert(makeRoom("H1",101)));
+ASSERT_TRUE(repo.upsert(makeRoom("H1",102)));
+
+auto first = repo.listByHotelPage("H1", std::nullopt, 2);
+ASSERT_EQ(first.items.size(), 2u);
+EXPECT_EQ(first.items[0].number, 101);
+EXPECT_EQ(first.items[1].number, 102);
+ASSERT_TRUE(first.next.has_value());
+
+auto second = repo.listByHotelPage("H1", first.next, 2);
+ASSERT_EQ(second.items.size(), 1u);
+EXPECT_EQ(second.items[0].number, 103);
+EXPECT_FALSE(second.next.has_value());
+}
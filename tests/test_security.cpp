@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "../src/security/HashWorkers.h"
+#include "../src/security/Security.h"
+#include "../src/security/Sha256.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace hms;
+
+static std::string hex(std::string_view bytes) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string out;
+    for (const unsigned char c : bytes) {
+        out.push_back(kHex[c >> 4]);
+        out.push_back(kHex[c & 0xF]);
+    }
+    return out;
+}
+
+// Keeps the cost of new hashes low for the duration of a test.
+struct CheapHashes {
+    CheapHashes() { SetPasswordIterations(10); }
+    ~CheapHashes() { SetPasswordIterations(kDefaultPasswordIterations); }
+};
+
+TEST(Security, Sha256AndPbkdf2MatchPublishedVectors) {
+Sha256 sha;
+sha.update("abc");
+const auto digest = sha.finish();
+EXPECT_EQ(hex({reinterpret_cast<const char*>(digest.data()), digest.size()}),
+          "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+// RFC 7914, section 11.
+EXPECT_EQ(hex(Pbkdf2HmacSha256("passwd", "salt", 1, 64)),
+          "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"
+          "49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783");
+EXPECT_EQ(hex(Pbkdf2HmacSha256("password", "salt", 2, 32)),
+          "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43");
+}
+
+TEST(Security, HashesAreSaltedAndVerify) {
+CheapHashes cheap;
+const auto first = HashPassword("secret");
+const auto second = HashPassword("secret");
+EXPECT_EQ(first.rfind("pbkdf2-sha256$10$", 0), 0u);
+EXPECT_NE(first, second); // a fresh salt each time
+EXPECT_TRUE(VerifyPassword(first, "secret"));
+EXPECT_TRUE(VerifyPassword(second, "secret"));
+EXPECT_FALSE(VerifyPassword(first, "Secret"));
+EXPECT_FALSE(VerifyPassword("pbkdf2-sha256$10$zz$00", "secret"));
+EXPECT_FALSE(VerifyPassword("", "secret"));
+EXPECT_FALSE(PasswordNeedsRehash(first));
+
+SetPasswordIterations(20);
+EXPECT_TRUE(PasswordNeedsRehash(first)); // the cost went up
+}
+
+TEST(Security, LegacyHashesVerifyAndNeedRehashing) {
+const std::string legacy = "a3737979fe04d906"; // "admin123" in the sample data
+EXPECT_TRUE(VerifyPassword(legacy, "admin123"));
+EXPECT_FALSE(VerifyPassword(legacy, "admin124"));
+EXPECT_TRUE(PasswordNeedsRehash(legacy));
+}
+
+// Waits like the session server: the calling task yields until notified.
+struct YieldingWaiter : WorkWaiter {
+    std::atomic<int> notified{0};
+    int suspended{0};
+
+    std::function<void()> notifier() override {
+        return [this] { ++notified; };
+    }
+    void suspend() override {
+        ++suspended;
+        std::this_thread::yield();
+    }
+};
+
+TEST(Security, HashWorkRunsOnTheWorkersWhenTheThreadHasAWaiter) {
+HashWorkers workers(2);
+std::thread::id ranOn;
+workers.run([&] { ranOn = std::this_thread::get_id(); });
+EXPECT_EQ(ranOn, std::this_thread::get_id()); // no waiter: inline
+
+YieldingWaiter waiter;
+WorkWaiter* previous = exchangeWorkWaiter(&waiter);
+workers.run([&] {
+    ranOn = std::this_thread::get_id();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+});
+EXPECT_NE(ranOn, std::this_thread::get_id());
+EXPECT_EQ(waiter.notified.load(), 1);
+EXPECT_GT(waiter.suspended, 0);
+EXPECT_THROW(workers.run([] { throw std::runtime_error("boom"); }), std::runtime_error);
+exchangeWorkWaiter(previous);
+}
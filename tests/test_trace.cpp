@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "../src/diagnostics/Metrics.h"
+#include "../src/diagnostics/Trace.h"
+#include "_test_support.h"
+
+#include <fstream>
+#include <set>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+using namespace hms::diagnostics;
+using test_support::TempDir;
+
+TEST(Trace, WritesChromeTraceEventsFromEveryThread) {
+TempDir tmp;
+auto& tracer = Tracer::instance();
+tracer.enable(tmp.join("trace/out.json"));
+
+{
+    HMS_TRACE_SPAN("test.outer", "test");
+    HMS_SCOPED_LATENCY("test.storage");
+}
+std::thread worker([] {
+    for (int i = 0; i < 5000; ++i) { HMS_TRACE_SPAN("test.worker", "test"); } // spans more than one chunk
+});
+worker.join();
+
+ASSERT_TRUE(tracer.flush());
+std::ifstream in(tmp.join("trace/out.json"));
+nlohmann::json doc;
+ASSERT_NO_THROW(in >> doc);
+
+std::size_t workerSpans = 0;
+std::set<std::string> names;
+std::set<int> tids;
+for (const auto& e : doc.at("traceEvents")) {
+    if (e.at("ph") != "X") continue;
+    names.insert(e.at("name").get<std::string>());
+    tids.insert(e.at("tid").get<int>());
+    EXPECT_GE(e.at("dur").get<double>(), 0.0);
+    if (e.at("name") == "test.worker") ++workerSpans;
+}
+EXPECT_EQ(workerSpans, 5000u);
+EXPECT_TRUE(names.count("test.outer"));
+EXPECT_TRUE(names.count("test.storage")); // metrics scopes double as storage spans
+EXPECT_GE(tids.size(), 2u);
+}
@@ -0,0 +1,531 @@
+// hms_datagen: writes users.json, hotels.json, rooms.json and bookings.json at
+// scale for load and performance work. Records are encoded with the same
+// codecs the repositories use, so the output loads through their load().
+//
+// Every record is derived from (seed, index) alone, which lets batches be
+// generated on worker threads and streamed to disk in order without keeping
+// more than a few batches in memory. The output is identical for any thread
+// count.
+
+#include "../src/models/Booking.h"
+#include "../src/models/Hotel.h"
+#include "../src/models/Room.h"
+#include "../src/models/User.h"
+#include "../src/pricing/PricingEngine.h"
+#include "../src/security/Security.h"
+#include "../src/storage/BookingRepository.h"
+#include "../src/storage/HotelRepository.h"
+#include "../src/storage/UserRepository.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    fs::path      out{"generated-data"};
+    std::int64_t  hotels{100};
+    std::int64_t  rooms{10'000};
+    std::int64_t  users{20'000};
+    std::int64_t  bookings{50'000};
+    std::uint64_t seed{42};
+    unsigned      threads{std::max(1u, std::thread::hardware_concurrency())};
+    std::int64_t  batch{4'096}; // records per worker task
+};
+
+void printUsage() {
+    std::cout <<
+        "Usage: hms_datagen [options]\n"
+        "  --out DIR        output directory (default: generated-data)\n"
+        "  --hotels N       number of hotels (default: 100)\n"
+        "  --rooms N        number of rooms, spread over the hotels (default: 10000)\n"
+        "  --users N        number of user accounts (default: 20000)\n"
+        "  --bookings N     number of bookings, ~2.7 items each (default: 50000)\n"
+        "  --seed N         random seed (default: 42)\n"
+        "  --threads N      worker threads (default: hardware concurrency)\n"
+        "  --batch N        records per worker task (default: 4096)\n"
+        "Example (10k hotels, 1M rooms, ~50M booking items):\n"
+        "  hms_datagen --hotels 10000 --rooms 1000000 --users 2000000 --bookings 19000000\n";
+}
+
+bool parseCount(std::string_view text, std::int64_t& out) {
+    try {
+        std::size_t idx = 0;
+        const long long value = std::stoll(std::string(text), &idx, 10);
+        if (idx != text.size() || value < 0) return false;
+        out = value;
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h") return false;
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const std::string_view value = argv[++i];
+        std::int64_t n = 0;
+        if (arg == "--out") { opt.out = fs::path(std::string(value)); continue; }
+        if (!parseCount(value, n)) {
+            std::cerr << "Invalid number for " << arg << ": " << value << "\n";
+            return false;
+        }
+        if      (arg == "--hotels")   opt.hotels = n;
+        else if (arg == "--rooms")    opt.rooms = n;
+        else if (arg == "--users")    opt.users = n;
+        else if (arg == "--bookings") opt.bookings = n;
+        else if (arg == "--seed")     opt.seed = static_cast<std::uint64_t>(n);
+        else if (arg == "--threads")  opt.threads = static_cast<unsigned>(std::max<std::int64_t>(1, n));
+        else if (arg == "--batch")    opt.batch = std::max<std::int64_t>(1, n);
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (opt.rooms > 0 && opt.hotels == 0) {
+        std::cerr << "Rooms need at least one hotel.\n";
+        return false;
+    }
+    if (opt.bookings > 0 && (opt.rooms == 0 || opt.users == 0)) {
+        std::cerr << "Bookings need at least one room and one user.\n";
+        return false;
+    }
+    return true;
+}
+
+// ---- deterministic randomness ----------------------------------------------
+
+std::uint64_t mix(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// splitmix64 stream seeded from (seed, record kind, record index).
+class Rng {
+public:
+    Rng(std::uint64_t seed, std::uint64_t kind, std::int64_t index)
+        : state_(mix(seed ^ mix(kind ^ mix(static_cast<std::uint64_t>(index))))) {}
+
+    std::uint64_t next() { return mix(state_ += 0x9E3779B97F4A7C15ull); }
+    double real() { return static_cast<double>(next() >> 11) * 0x1.0p-53; } // [0, 1)
+    std::int64_t below(std::int64_t n) { return n <= 0 ? 0 : static_cast<std::int64_t>(next() % static_cast<std::uint64_t>(n)); }
+    bool chance(double p) { return real() < p; }
+
+    // Index in [0, n) biased towards 0: a few hotels and repeat guests take
+    // most of the bookings.
+    std::int64_t skewed(std::int64_t n, double exponent) {
+        return std::min(n - 1, static_cast<std::int64_t>(std::pow(real(), exponent) * static_cast<double>(n)));
+    }
+
+    template <std::size_t N>
+    std::size_t weighted(const std::array<int, N>& weights) {
+        int total = 0;
+        for (int w : weights) total += w;
+        auto pick = static_cast<int>(below(total));
+        for (std::size_t i = 0; i < N; ++i) {
+            if (pick < weights[i]) return i;
+            pick -= weights[i];
+        }
+        return N - 1;
+    }
+
+    template <typename T, std::size_t N>
+    const T& pick(const std::array<T, N>& values) { return values[static_cast<std::size_t>(below(N))]; }
+
+private:
+    std::uint64_t state_;
+};
+
+enum Kind : std::uint64_t { kHotel = 1, kRoom, kUser, kBooking };
+
+// ---- vocabulary --------------------------------------------------------------
+
+constexpr std::array<std::string_view, 12> kHotelWords{
+    "Grand", "Royal", "Harbour", "Park", "Riverside", "Central",
+    "Garden", "Palace", "Seaside", "Alpine", "Old Town", "Summit"};
+constexpr std::array<std::string_view, 6> kHotelKinds{
+    "Hotel", "Inn", "Suites", "Resort", "Lodge", "House"};
+constexpr std::array<std::string_view, 16> kCities{
+    "Lisbon", "Porto", "Madrid", "Seville", "Paris", "Lyon", "Berlin", "Munich",
+    "Vienna", "Prague", "Rome", "Milan", "Dublin", "Oslo", "Athens", "Krakow"};
+constexpr std::array<std::string_view, 10> kStreets{
+    "Station", "Market", "Church", "Castle", "Mill", "Bridge", "King", "Queen", "Harbour", "Garden"};
+constexpr std::array<std::string_view, 20> kFirstNames{
+    "Ana", "Ben", "Carla", "David", "Elena", "Farid", "Grace", "Hugo", "Ines", "Jonas",
+    "Kira", "Luca", "Maya", "Nils", "Olga", "Pedro", "Rosa", "Sami", "Tara", "Yusuf"};
+constexpr std::array<std::string_view, 20> kLastNames{
+    "Silva", "Novak", "Schmidt", "Rossi", "Garcia", "Dubois", "Kowalski", "Jensen", "Murphy", "Costa",
+    "Berg", "Horvat", "Moreau", "Fischer", "Ivanova", "Santos", "Keller", "Lindqvist", "Popescu", "Weber"};
+constexpr std::array<std::string_view, 4> kRoomTypes{"STANDARD", "DELUXE", "LUXURY", "SUITE"};
+
+struct Dish {
+    std::string_view id;
+    std::string_view name;
+    std::string_view category;
+    std::int64_t     priceCents;
+};
+
+constexpr std::array<Dish, 9> kMenu{{
+    {"breakfast-buffet", "Breakfast buffet",   "Breakfast", 1800},
+    {"pancakes",         "Pancakes",           "Breakfast", 1100},
+    {"club-sandwich",    "Club sandwich",      "Lunch",     1450},
+    {"caesar-salad",     "Caesar salad",       "Lunch",     1300},
+    {"steak",            "Sirloin steak",      "Dinner",    3100},
+    {"sea-bass",         "Grilled sea bass",   "Dinner",    2700},
+    {"risotto",          "Mushroom risotto",   "Dinner",    2200},
+    {"house-wine",       "House wine (glass)", "Bar",        750},
+    {"espresso",         "Espresso",           "Bar",        300},
+}};
+
+constexpr std::int64_t kDay = 24 * 60 * 60;
+constexpr std::int64_t kHistoryEnd = 1'760'000'000;           // bookings are created up to here
+constexpr std::int64_t kHistoryStart = kHistoryEnd - 3 * 365 * kDay;
+constexpr int kRoomsPerFloor = 24;
+
+std::string padded(std::string_view prefix, std::int64_t n, int width) {
+    std::string digits = std::to_string(n);
+    if (static_cast<int>(digits.size()) < width) digits.insert(0, static_cast<std::size_t>(width) - digits.size(), '0');
+    return std::string(prefix) + digits;
+}
+
+std::string lower(std::string_view s) {
+    std::string out(s);
+    for (auto& ch : out) {
+        if (ch == ' ') ch = '-';
+        else ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    return out;
+}
+
+// ---- record generators --------------------------------------------------------
+
+class Generator {
+public:
+    explicit Generator(const Options& opt)
+        : opt_(opt),
+          pricing_(opt.out / "pricing.json"), // never loaded: built-in tariff
+          // One hash (and salt) per role for every generated account: a
+          // full key derivation per user would dominate generation time.
+          guestPasswordHash_(hms::HashPassword("guest123")),
+          staffPasswordHash_(hms::HashPassword("admin123")) {
+        staffUsers_ = std::min<std::int64_t>(opt.users, 1 + opt.users / 1'000);
+    }
+
+    std::string hotelId(std::int64_t h) const { return padded("HTL-", h + 1, 4); }
+    std::string userId(std::int64_t u) const  { return padded("USR-", u + 1, 6); }
+
+    hms::Hotel hotel(std::int64_t h) const {
+        Rng rng(opt_.seed, kHotel, h);
+        hms::Hotel out{};
+        out.id = hotelId(h);
+        const auto city = rng.pick(kCities);
+        out.name = std::string(rng.pick(kHotelWords)) + " " + std::string(rng.pick(kHotelKinds)) + " " + std::string(city);
+        out.stars = static_cast<std::uint8_t>(1 + rng.weighted(std::array<int, 5>{5, 15, 40, 30, 10}));
+        out.address = std::to_string(1 + rng.below(250)) + " " + std::string(rng.pick(kStreets)) + " Street, " + std::string(city);
+        return out;
+    }
+
+    // Rooms are split as evenly as possible: the first (rooms % hotels)
+    // hotels get one extra room.
+    std::int64_t roomsIn(std::int64_t h) const {
+        const auto base = opt_.rooms / opt_.hotels;
+        return base + (h < opt_.rooms % opt_.hotels ? 1 : 0);
+    }
+
+    std::int64_t firstRoomOf(std::int64_t h) const {
+        const auto base = opt_.rooms / opt_.hotels;
+        const auto extra = opt_.rooms % opt_.hotels;
+        return h * base + std::min(h, extra);
+    }
+
+    std::int64_t hotelOfRoom(std::int64_t i) const {
+        const auto base = opt_.rooms / opt_.hotels;
+        const auto extra = opt_.rooms % opt_.hotels;
+        const auto bigRooms = extra * (base + 1);
+        if (i < bigRooms) return i / (base + 1);
+        return extra + (i - bigRooms) / base;
+    }
+
+    hms::Room room(std::int64_t i) const {
+        const auto h = hotelOfRoom(i);
+        const auto idx = i - firstRoomOf(h);
+        const int stars = hotel(h).stars;
+
+        Rng rng(opt_.seed, kRoom, i);
+        hms::Room out{};
+        out.hotelId = hotelId(h);
+        out.number = static_cast<int>((idx / kRoomsPerFloor + 1) * 100 + idx % kRoomsPerFloor + 1);
+        out.id = out.hotelId + "-" + std::to_string(out.number);
+
+        // Better hotels carry more of the expensive room types.
+        const std::array<int, 4> typeWeights{80 - stars * 10, 15 + stars * 3, stars * 3, stars * 2};
+        const auto type = rng.weighted(typeWeights);
+        out.typeId = std::string(kRoomTypes[type]);
+
+        static constexpr std::array<int, 4> kBaseSize{16, 24, 30, 45};
+        out.sizeSqm = kBaseSize[type] + static_cast<int>(rng.below(10));
+        out.beds = 1 + static_cast<int>(rng.weighted(std::array<int, 3>{55, 40, 5}));
+
+        out.amenities = {"Wi-Fi"};
+        if (rng.chance(0.7)) out.amenities.emplace_back("Desk");
+        if (rng.chance(0.15 + stars * 0.05)) out.amenities.emplace_back("Sea View");
+        if (rng.chance(0.25)) out.amenities.emplace_back("Balcony");
+        if (rng.chance(stars * 0.12)) out.amenities.emplace_back("Mini Bar");
+        if (type == 3 && rng.chance(0.6)) out.amenities.emplace_back("Jacuzzi");
+
+        out.active = rng.chance(0.97);
+        if (!out.active) out.notes = "Under renovation";
+        return out;
+    }
+
+    hms::User user(std::int64_t u) const {
+        Rng rng(opt_.seed, kUser, u);
+        hms::User out{};
+        out.userId = userId(u);
+        out.firstName = std::string(rng.pick(kFirstNames));
+        out.lastName = std::string(rng.pick(kLastNames));
+        out.address = std::to_string(1 + rng.below(400)) + " " + std::string(rng.pick(kStreets)) + " Road, "
+                    + std::string(rng.pick(kCities));
+        out.phone = "+351 9" + padded("", rng.below(100'000'000), 8);
+        out.login = lower(out.firstName) + "." + lower(out.lastName) + "." + std::to_string(u + 1);
+        if (u == 0)                  out.role = hms::Role::ADMIN;
+        else if (u < staffUsers_)    out.role = hms::Role::MANAGER;
+        else                         out.role = hms::Role::GUEST;
+        out.passwordHash = out.role == hms::Role::GUEST ? guestPasswordHash_ : staffPasswordHash_;
+        out.active = rng.chance(0.99);
+        return out;
+    }
+
+    hms::Booking booking(std::int64_t i) const {
+        Rng rng(opt_.seed, kBooking, i);
+        hms::Booking out{};
+        out.bookingId = padded("BKG-", i + 1, 6);
+
+        // Bookings arrive in id order over three years, with some jitter.
+        const auto span = kHistoryEnd - kHistoryStart;
+        out.createdAt = kHistoryStart + (opt_.bookings > 1 ? span * i / (opt_.bookings - 1) : span)
+                      - rng.below(kDay / 2);
+
+        // Popular hotels and returning guests dominate.
+        std::int64_t h = opt_.hotels > 0 ? rng.skewed(opt_.hotels, 1.8) : 0;
+        if (roomsIn(h) == 0) h = hotelOfRoom(rng.below(opt_.rooms));
+        out.hotelId = hotelId(h);
+
+        const auto guests = std::max<std::int64_t>(1, opt_.users - staffUsers_);
+        const auto guestIndex = std::min(opt_.users - 1, staffUsers_ + rng.skewed(guests, 1.6));
+        const auto guest = user(guestIndex);
+        out.primaryGuestId = guest.userId;
+
+        const std::int64_t stays = 1 + static_cast<std::int64_t>(rng.weighted(std::array<int, 3>{80, 15, 5}));
+        const int nights = 1 + static_cast<int>(rng.weighted(std::array<int, 10>{22, 25, 18, 12, 8, 5, 4, 3, 2, 1}));
+        const auto checkIn = out.createdAt + rng.below(60) * kDay;
+        const auto checkOut = checkIn + nights * kDay;
+
+        if (checkOut < kHistoryEnd - 2 * kDay) {
+            out.status = rng.chance(0.93) ? hms::BookingStatus::CHECKED_OUT : hms::BookingStatus::CANCELLED;
+        }
+        else {
+            out.status = rng.chance(0.9) ? hms::BookingStatus::ACTIVE : hms::BookingStatus::CANCELLED;
+        }
+        out.updatedAt = out.status == hms::BookingStatus::CHECKED_OUT ? checkOut
+                      : out.createdAt + rng.below(kDay);
+
+        const auto firstRoom = firstRoomOf(h);
+        const auto roomCount = roomsIn(h);
+        int billedRoom = 0;
+        for (std::int64_t s = 0; s < stays; ++s) {
+            const auto r = room(firstRoom + rng.below(roomCount));
+            hms::RoomStayItem stay{};
+            stay.hotelId = r.hotelId;
+            stay.roomNumber = r.number;
+            stay.nights = nights;
+            stay.nightlyRateLocked = pricing_.rateFor(r);
+
+            hms::User occupant = guest; // occupants never carry credentials
+            occupant.login.clear();
+            occupant.passwordHash.clear();
+            occupant.role = hms::Role::GUEST;
+            occupant.active = true;
+            if (s > 0) {
+                occupant.userId = out.bookingId + "-G" + std::to_string(s + 1);
+                occupant.firstName = std::string(rng.pick(kFirstNames));
+            }
+            stay.occupants.push_back(std::move(occupant));
+            const auto companions = std::min<std::int64_t>(r.beds, rng.weighted(std::array<int, 3>{45, 45, 10}));
+            for (std::int64_t c = 0; c < companions; ++c) {
+                hms::User extra{};
+                extra.userId = out.bookingId + "-R" + std::to_string(s + 1) + "-" + std::to_string(c + 1);
+                extra.firstName = std::string(rng.pick(kFirstNames));
+                extra.lastName = guest.lastName;
+                extra.address = guest.address;
+                stay.occupants.push_back(std::move(extra));
+            }
+            if (billedRoom == 0) billedRoom = r.number;
+            out.items.emplace_back(std::move(stay));
+        }
+
+        if (out.status != hms::BookingStatus::CANCELLED) {
+            static constexpr std::array<int, 6> kOrderWeights{40, 20, 15, 10, 8, 7};
+            static constexpr std::array<int, 6> kOrderCounts{0, 1, 2, 3, 4, 6};
+            const int orders = kOrderCounts[rng.weighted(kOrderWeights)];
+            for (int o = 0; o < orders; ++o) {
+                const auto& dish = rng.pick(kMenu);
+                hms::RestaurantOrderLine line{};
+                line.lineId = padded("ROL-", o + 1, 4);
+                line.restaurantId = out.hotelId + "-R1";
+                line.category = std::string(dish.category);
+                line.menuItemId = std::string(dish.id);
+                line.nameSnapshot = std::string(dish.name);
+                line.unitPriceSnapshot = dish.priceCents;
+                line.qty = 1 + static_cast<int>(rng.weighted(std::array<int, 3>{60, 30, 10}));
+                line.billedRoomNumber = billedRoom;
+                line.takenByUsername = "staff";
+                line.orderedByGuestId = guest.userId;
+                line.createdAt = checkIn + rng.below(nights * kDay);
+                out.items.emplace_back(std::move(line));
+            }
+        }
+        return out;
+    }
+
+private:
+    const Options&     opt_;
+    hms::PricingEngine pricing_;
+    std::string        guestPasswordHash_;
+    std::string        staffPasswordHash_;
+    std::int64_t       staffUsers_{0};
+};
+
+// ---- streaming writer --------------------------------------------------------
+
+// Writes a JSON array of `count` records, one per line. Rounds of
+// `threads` batches are encoded in parallel and appended in index order, so
+// memory stays bounded by threads * batch encoded records. Like saveAll, the
+// file is written to a temp path and renamed into place. With a non-empty
+// `header` (e.g. `{"formatVersion":2,"bookings":`) the array is wrapped in
+// that object.
+template <typename Encode>
+bool writeArray(const Options& opt, const std::string& name, std::int64_t count, Encode encode,
+                const std::string& header = {}) {
+    const auto path = opt.out / name;
+    const fs::path tmp = path.string() + ".tmp";
+    const auto started = std::chrono::steady_clock::now();
+
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out.good()) {
+        std::cerr << "Cannot write " << tmp.string() << "\n";
+        return false;
+    }
+
+    out << header << "[";
+    for (std::int64_t base = 0; base < count; base += opt.batch * opt.threads) {
+        std::vector<std::future<std::string>> jobs;
+        for (unsigned t = 0; t < opt.threads; ++t) {
+            const auto begin = base + static_cast<std::int64_t>(t) * opt.batch;
+            if (begin >= count) break;
+            const auto end = std::min(count, begin + opt.batch);
+            jobs.push_back(std::async(std::launch::async, [begin, end, &encode] {
+                std::string chunk;
+                for (auto i = begin; i < end; ++i) {
+                    chunk += i == 0 ? "\n" : ",\n";
+                    chunk += encode(i).dump();
+                }
+                return chunk;
+            }));
+        }
+        for (auto& job : jobs) out << job.get();
+        if (!out.good()) break;
+    }
+    out << (count > 0 ? "\n]" : "]") << (header.empty() ? "" : "}") << "\n";
+    out.close();
+
+    if (!out.good()) {
+        std::error_code ec;
+        fs::remove(tmp, ec);
+        std::cerr << "Failed while writing " << tmp.string() << "\n";
+        return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        std::cerr << "Cannot move " << tmp.string() << " into place\n";
+        return false;
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    std::cout << "  " << name << ": " << count << " records, "
+              << (fs::file_size(path) / (1024 * 1024)) << " MiB in "
+              << elapsed.count() << " s\n";
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        printUsage();
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::create_directories(opt.out, ec);
+    if (ec) {
+        std::cerr << "Cannot create " << opt.out.string() << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    const Generator gen(opt);
+    std::atomic<std::int64_t> bookingItems{0};
+
+    std::cout << "Writing to " << opt.out.string() << " with " << opt.threads << " threads\n";
+    const bool ok =
+        writeArray(opt, "hotels.json", opt.hotels,
+                   [&](std::int64_t i) { return hms::HotelRepository::toJson(gen.hotel(i)); }) &&
+        writeArray(opt, "rooms.json", opt.rooms,
+                   [&](std::int64_t i) { return json(gen.room(i)); }) &&
+        writeArray(opt, "users.json", opt.users,
+                   [&](std::int64_t i) { return hms::UserRepository::toJson(gen.user(i)); }) &&
+        writeArray(opt, "bookings.json", opt.bookings,
+                   [&](std::int64_t i) {
+                       auto b = gen.booking(i);
+                       bookingItems.fetch_add(static_cast<std::int64_t>(b.items.size()), std::memory_order_relaxed);
+                       return json(b);
+                   },
+                   "{\"formatVersion\":" + std::to_string(hms::BookingRepository::kFormatVersion) + ",\"bookings\":");
+    if (!ok) return 1;
+
+    std::cout << "  booking items: " << bookingItems.load() << "\n";
+    std::cout << "Point HMS at the output by copying the files into the data directory.\n";
+    return 0;
+}
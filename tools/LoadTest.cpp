@@ -0,0 +1,353 @@
+// hms_loadtest: simulates many terminals against `Hotel_Management_System
+// --serve`. Every simulated terminal is a socket connection; a few of them
+// ("active") repeatedly log in as a guest, open their bookings and log out,
+// while the rest sit at the welcome screen like idle front-desk terminals.
+// Reports how long each step took (line sent -> next prompt received) and,
+// given the server's pid, what the idle sessions cost the server.
+//
+// All connections are driven from one thread with epoll, the same way the
+// server drives its sessions.
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    fs::path      socket{fs::temp_directory_path() / "hms.sock"};
+    std::int64_t  sessions{200};
+    std::int64_t  active{20};
+    std::int64_t  rounds{10};
+    std::string   login{"john"};
+    std::string   password{"secret"};
+    std::int64_t  timeoutSeconds{30};
+    std::int64_t  serverPid{0};
+};
+
+void printUsage() {
+    std::cout <<
+        "Usage: hms_loadtest [options]\n"
+        "  --socket PATH    server socket (default: <temp dir>/hms.sock)\n"
+        "  --sessions N     terminals to connect (default: 200)\n"
+        "  --active N       of those, terminals that run the guest script (default: 20)\n"
+        "  --rounds N       script repetitions per active terminal (default: 10)\n"
+        "  --login NAME     guest login for the script (default: john)\n"
+        "  --password PW    its password (default: secret)\n"
+        "  --timeout S      give up on a step after S seconds (default: 30)\n"
+        "  --server-pid N   report the server's threads and memory from /proc\n"
+        "Start the server first, e.g. `Hotel_Management_System --serve`.\n";
+}
+
+bool parseCount(std::string_view text, std::int64_t& out) {
+    try {
+        std::size_t idx = 0;
+        const long long value = std::stoll(std::string(text), &idx, 10);
+        if (idx != text.size() || value < 0) return false;
+        out = value;
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h") return false;
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        const std::string_view value = argv[++i];
+        if (arg == "--socket")   { opt.socket = fs::path(std::string(value)); continue; }
+        if (arg == "--login")    { opt.login = value; continue; }
+        if (arg == "--password") { opt.password = value; continue; }
+        std::int64_t n = 0;
+        if (!parseCount(value, n)) {
+            std::cerr << "Invalid number for " << arg << ": " << value << "\n";
+            return false;
+        }
+        if      (arg == "--sessions")   opt.sessions = n;
+        else if (arg == "--active")     opt.active = n;
+        else if (arg == "--rounds")     opt.rounds = n;
+        else if (arg == "--timeout")    opt.timeoutSeconds = std::max<std::int64_t>(1, n);
+        else if (arg == "--server-pid") opt.serverPid = n;
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    opt.active = std::min(opt.active, opt.sessions);
+    return true;
+}
+
+// One line typed at the terminal and the text that marks the server's
+// answer as complete (the next prompt).
+struct Step {
+    std::string send;
+    std::string expect;
+};
+
+// Log in, open "Profile & bookings" -> "View my bookings", go back, log out.
+std::vector<Step> guestRound(const Options& opt) {
+    return {
+        {"1\n",                  "Login: "},
+        {opt.login + "\n",       "Password: "},
+        {opt.password + "\n",    "Select: "},  // guest dashboard
+        {"3\n",                  "Select: "},  // profile menu
+        {"1\n",                  "Press Enter"},
+        {"\n",                   "Select: "},
+        {"0\n",                  "Select: "},
+        {"4\n",                  "Select: "},  // logout (the server saves) -> welcome
+    };
+}
+
+struct Terminal {
+    int               fd{-1};
+    bool              active{false};
+    bool              failed{false};
+    std::string       received;
+    std::string       expect{"Select: "}; // the welcome screen
+    std::size_t       step{0};
+    std::int64_t      round{0};
+    Clock::time_point sentAt{};
+    bool              done{false};
+};
+
+int dial(const fs::path& path) {
+    const std::string text = path.string();
+    sockaddr_un addr{};
+    if (text.size() >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, text.c_str(), text.size() + 1);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0) {
+        const int saved = errno;
+        ::close(fd);
+        errno = saved;
+        return -1;
+    }
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+struct ServerStats {
+    std::int64_t threads{0};
+    std::int64_t rssKiB{0};
+};
+
+std::optional<ServerStats> readServerStats(std::int64_t pid) {
+    if (pid <= 0) return std::nullopt;
+    std::ifstream in("/proc/" + std::to_string(pid) + "/status");
+    if (!in) return std::nullopt;
+    ServerStats stats;
+    std::string key;
+    while (in >> key) {
+        if (key == "VmRSS:")        in >> stats.rssKiB;
+        else if (key == "Threads:") in >> stats.threads;
+        std::string rest;
+        std::getline(in, rest);
+    }
+    return stats;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    const auto index = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+double millisSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void printLatencies(const char* label, std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    std::cout << label << std::fixed << std::setprecision(2)
+              << "p50 " << percentile(ms, 0.50) << " ms  p90 " << percentile(ms, 0.90)
+              << " ms  p99 " << percentile(ms, 0.99) << " ms  max " << (ms.empty() ? 0.0 : ms.back()) << " ms\n";
+}
+
+bool sendLine(Terminal& t, const std::string& line) {
+    const ssize_t n = ::send(t.fd, line.data(), line.size(), MSG_NOSIGNAL);
+    return n == static_cast<ssize_t>(line.size()); // one short line fits the socket buffer
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        printUsage();
+        return 1;
+    }
+
+    const int epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll < 0) {
+        std::cerr << "epoll_create1: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    const auto before = readServerStats(opt.serverPid);
+    const std::vector<Step> script = guestRound(opt);
+    std::vector<Terminal> terminals(static_cast<std::size_t>(opt.sessions));
+    std::vector<double> welcomeMs;
+    std::vector<double> stepMs;
+
+    // Phase 1: connect everyone and wait for every welcome screen.
+    const auto connectStart = Clock::now();
+    for (std::size_t i = 0; i < terminals.size(); ++i) {
+        auto& t = terminals[i];
+        t.fd = dial(opt.socket);
+        if (t.fd < 0) {
+            std::cerr << "Could not connect terminal " << i << " to " << opt.socket.string() << ": "
+                      << std::strerror(errno) << "\n";
+            return 1;
+        }
+        t.active = static_cast<std::int64_t>(i) < opt.active;
+        t.sentAt = Clock::now();
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = i;
+        ::epoll_ctl(epoll, EPOLL_CTL_ADD, t.fd, &ev);
+    }
+
+    std::size_t waitingForWelcome = terminals.size();
+    std::size_t activeLeft = static_cast<std::size_t>(opt.active);
+    bool scriptStarted = false;
+    Clock::time_point scriptStart{};
+    std::optional<ServerStats> idle;
+    std::int64_t failures = 0;
+    std::array<epoll_event, 256> events;
+    std::array<char, 16 * 1024> buffer;
+    const auto timeout = std::chrono::seconds(opt.timeoutSeconds);
+    auto lastProgress = Clock::now();
+
+    while (waitingForWelcome > 0 || activeLeft > 0) {
+        if (waitingForWelcome == 0 && !scriptStarted) {
+            // Phase 2: everyone is idle at the welcome screen; start the script.
+            std::cout << "Connected " << terminals.size() << " terminals in " << std::fixed
+                      << std::setprecision(1) << millisSince(connectStart) << " ms\n";
+            idle = readServerStats(opt.serverPid);
+            scriptStarted = true;
+            scriptStart = Clock::now();
+            for (auto& t : terminals) {
+                if (!t.active) continue;
+                if (opt.rounds == 0) { t.done = true; --activeLeft; continue; }
+                t.expect = script[0].expect;
+                t.sentAt = Clock::now();
+                if (!sendLine(t, script[0].send)) { t.failed = t.done = true; ++failures; --activeLeft; }
+            }
+            continue;
+        }
+
+        const int n = ::epoll_wait(epoll, events.data(), static_cast<int>(events.size()), 1000);
+        if (n < 0 && errno != EINTR) break;
+        if (n <= 0) {
+            if (Clock::now() - lastProgress > timeout) {
+                std::cerr << "Timed out waiting for the server.\n";
+                failures += static_cast<std::int64_t>(waitingForWelcome + activeLeft);
+                break;
+            }
+            continue;
+        }
+        lastProgress = Clock::now();
+
+        for (int e = 0; e < n; ++e) {
+            auto& t = terminals[events[e].data.u64];
+            const ssize_t got = ::recv(t.fd, buffer.data(), buffer.size(), 0);
+            if (got <= 0) {
+                if (got < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                if (!t.done) {
+                    t.failed = t.done = true;
+                    ++failures;
+                    if (!scriptStarted) --waitingForWelcome;
+                    else if (t.active) --activeLeft;
+                }
+                ::epoll_ctl(epoll, EPOLL_CTL_DEL, t.fd, nullptr);
+                continue;
+            }
+            t.received.append(buffer.data(), static_cast<std::size_t>(got));
+            if (t.done || t.received.find(t.expect) == std::string::npos) continue;
+
+            const double ms = millisSince(t.sentAt);
+            t.received.clear();
+            if (!scriptStarted) {
+                welcomeMs.push_back(ms);
+                t.done = !t.active; // idle terminals stay at the welcome screen
+                --waitingForWelcome;
+                continue;
+            }
+            stepMs.push_back(ms);
+            if (++t.step == script.size()) {
+                t.step = 0;
+                if (++t.round == opt.rounds) {
+                    t.done = true;
+                    --activeLeft;
+                    continue;
+                }
+            }
+            t.expect = script[t.step].expect;
+            t.sentAt = Clock::now();
+            if (!sendLine(t, script[t.step].send)) {
+                t.failed = t.done = true;
+                ++failures;
+                --activeLeft;
+            }
+        }
+    }
+
+    const double scriptSeconds = scriptStarted ? millisSince(scriptStart) / 1000.0 : 0.0;
+    const auto after = readServerStats(opt.serverPid);
+    for (auto& t : terminals) {
+        if (t.fd >= 0) ::close(t.fd);
+    }
+    ::close(epoll);
+
+    printLatencies("Welcome screen:  ", welcomeMs);
+    if (opt.active > 0) {
+        std::cout << "Ran " << opt.active << " active terminals x " << opt.rounds << " rounds: "
+                  << stepMs.size() << " steps in " << std::setprecision(2) << scriptSeconds << " s ("
+                  << std::setprecision(0) << (scriptSeconds > 0 ? static_cast<double>(stepMs.size()) / scriptSeconds : 0.0)
+                  << " steps/s)\n";
+        printLatencies("Step latency:    ", stepMs);
+    }
+    if (before && idle) {
+        const auto added = static_cast<double>(idle->rssKiB - before->rssKiB);
+        std::cout << "Server: " << before->threads << " -> " << idle->threads << " threads, RSS "
+                  << before->rssKiB << " -> " << idle->rssKiB << " KiB with every terminal connected ("
+                  << std::setprecision(1) << added / static_cast<double>(std::max<std::int64_t>(1, opt.sessions))
+                  << " KiB per session)";
+        if (after) std::cout << ", " << after->rssKiB << " KiB at the end";
+        std::cout << "\n";
+    }
+    std::cout << "Failures: " << failures << "\n";
+    return failures == 0 ? 0 : 1;
+}